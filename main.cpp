@@ -6,6 +6,25 @@
  * @par history
  * - 2016-11-08 16:54:23
  *  - first.
+ * - 2026-10-17 21:05:40
+ *  - シーンループを割り込み/Tickerからのイベント駆動へ変更. イベント待ちの間はスリープする.
+ *  - アイドル率の表示(I)を追加.
+ * - 2026-10-17 21:40:15
+ *  - HEXダンプを hex_dump による行単位の出力へ変更. マークに破棄数を付加.
+ * - 2026-10-17 22:10:31
+ *  - 受信時刻付きキャプチャ(Dt: 1byte毎, Dg: 無通信時間で区切った塊毎)を追加.
+ * - 2026-10-17 22:45:52
+ *  - MODBUS RTU 通信の受動解析(Da)を追加.
+ * - 2026-10-17 23:20:14
+ *  - pc への出力を console(送信割り込み駆動)経由へ変更. ダンプ, キャプチャは出力が追い付かなければ破棄する.
+ *  - アイドル率の表示にメインループの最大停止時間を追加.
+ * - 2026-10-17 23:59:30
+ *  - SEEKERS_UART_DMA 有効時は uart をDMA転送で動作させる.
+ * - 2026-10-17 23:59:50
+ *  - 解析結果の長い行の出力長を明記.
+ * - 2026-10-18 00:01:00
+ *  - HEXダンプを改行無し(従来と同じ出力量)とし、行の途中までの出力は受信の途切れ(10ms周期で判定),
+ *    console の送信待ち無し, マークの時のみとする.
  */
 
 #include <vector>
@@ -13,6 +32,10 @@
 #include "mbed.h"
 #include "seekers/mbed/rs485serial.hpp"
 #include "seekers/mbed/sn74xx595.hpp"
+#include "seekers/hex_dump.hpp"
+#include "seekers/capture_stream.hpp"
+#include "seekers/modbus_rtu_frame.hpp"
+#include "seekers/modbus_rtu_analyzer.hpp"
 
 #include "vars.h"
 
@@ -66,14 +89,20 @@ void baud_entry(void);
 void format_entry(void);
 void bin_dump_entry(void);
 void hex_dump_entry(void);
+void capture_byte_entry(void);
+void capture_burst_entry(void);
+void analyzer_entry(void);
+void idle_entry(void);
 
 // シーンループ関数
-void top_level_menu_loop(void);
-void run_loop(void);
-void baud_setup_loop(void);
-void format_setup_loop(void);
-void bin_dump_loop(void);
-void hex_dump_loop(void);
+void top_level_menu_loop(uint32_t events);
+void run_loop(uint32_t events);
+void baud_setup_loop(uint32_t events);
+void format_setup_loop(uint32_t events);
+void bin_dump_loop(uint32_t events);
+void hex_dump_loop(uint32_t events);
+void capture_loop(uint32_t events);
+void analyzer_loop(uint32_t events);
 
 // シーンスタック
 stack_t<scene_entry_t> scene_stack_(run_entry);
@@ -87,18 +116,98 @@ menu_t top_menu_[] = {
   { "2", &format_entry },
   { "Db", &bin_dump_entry },
   { "Dh", &hex_dump_entry },
+  { "Dt", &capture_byte_entry },
+  { "Dg", &capture_burst_entry },
+  { "Da", &analyzer_entry },
+  { "I", &idle_entry },
   { NULL, NULL }
 };
 
 // マーク出力用Ticker
 Ticker mark_printer;
 
-// マーク出力関数
+// 動作周期用Ticker
+Ticker run_ticker;
+
+// キャプチャ, 解析, HEXダンプの無通信時間判定用Ticker
+Ticker capture_ticker;
+
+// マーク出力周期(割り込みコンテキスト)
 void mark_print(void)
 {
-  pc.printf("\r\n === MARK === \r\n");
+  runtime_events.post(EVENT_MARK);
+}
+
+// 動作周期(割り込みコンテキスト)
+void run_tick(void)
+{
+  runtime_events.post(EVENT_TICK);
+}
+
+/**
+ * @brief pc 受信割り込み
+ * 受信した文字を pc_rx へ移してから通知する(RxIrq は読み出すまで解除されない).
+ */
+void pc_rx_handler(void)
+{
+  while(pc.readable())
+    pc_rx.push((uint8_t)pc.getc());
+  runtime_events.post(EVENT_PC_RX);
+}
+
+// uart 受信通知(割り込みコンテキスト)
+void uart_rx_handler(void)
+{
+  runtime_events.post(EVENT_UART_RX);
 }
 
+/**
+ * @brief マーク出力
+ * 前回のマークからのアイドル率と、ダンプ開始からの破棄数を付加する.
+ */
+void mark_output(uint32_t dropped)
+{
+  const uint32_t idle = runtime_events.idle_permille();
+  const uint32_t busy_max = runtime_events.busy_max_us();
+  runtime_events.reset_idle();
+  // マークは破棄しない
+  const seekers::console_sink::policy_t policy = console.policy();
+  console.policy(seekers::console_sink::POLICY_BLOCK);
+  console.printf("\r\n === MARK === [idle %u.%u%%, stall max %uus, dropped %u]\r\n",
+                 idle / 10, idle % 10, busy_max, dropped);
+  console.policy(policy);
+}
+
+// HEXダンプの出力先
+bool pc_write(void*, const char* src, size_t size)
+{
+  return console.write(src, size);
+}
+
+// HEXダンプ整形
+seekers::hex_dump hex_dumper(pc_write, NULL);
+
+// ダンプ開始時の uart 受信バッファ溢れ数, console の破棄数
+uint32_t dump_overrun_base_ = 0;
+uint32_t dump_console_base_ = 0;
+
+// HEXダンプの前回の無通信時間判定時の受信byte数
+uint32_t hex_dump_idle_bytes_ = 0;
+
+// キャプチャの出力先
+bool pc_write_bytes(void*, const uint8_t* src, size_t size)
+{
+  return console.write(src, size);
+}
+
+// 受信時刻付きの受信バッファ, 記録
+seekers::spsc_ring<seekers::RS485Serial::rx_stamp_t, 256> uart_capture_;
+seekers::capture_stream capturer(pc_write_bytes, NULL);
+uint32_t capture_overrun_base_ = 0;
+
+// MODBUS RTU 通信の解析
+seekers::modbus_rtu_analyzer analyzer_;
+
 /**
  * @brief コマンド分離
  */
@@ -111,6 +220,29 @@ std::string parse_cmd(const std::string& src)
     return src.substr(0, npos);
 }
 
+/**
+ * @brief コマンド入力
+ * 受信済みの文字をエコーして cmd_buf_ へ追加する.
+ * 改行以降の文字は次のシーンで処理するため、残っていれば再度 EVENT_PC_RX を通知する.
+ * @return 改行を受信したらtrue
+ */
+bool read_line(uint32_t events)
+{
+  if(0 == (events & EVENT_PC_RX)) return false;
+  uint8_t ch;
+  while(pc_rx.pop(ch)){
+    if(ch == '\r'){
+      console.putc('\r'); console.putc('\n');
+      if(!pc_rx.empty())
+        runtime_events.post(EVENT_PC_RX);
+      return true;
+    }
+    console.putc(ch);
+    cmd_buf_.push_back(ch);
+  }
+  return false;
+}
+
 /**
  * @brief コマンド文字列から実行関数の選択
  * @param cmd : 対象のコマンド文字列
@@ -126,7 +258,7 @@ void menu_select(const std::string& cmd, const menu_t* menu, const scene_entry_t
       return;
     }
   }
-  pc.printf("[ERROR] invalid selection.\r\n");
+  console.printf("[ERROR] invalid selection.\r\n");
   current();
 }
 
@@ -135,15 +267,19 @@ void menu_select(const std::string& cmd, const menu_t* menu, const scene_entry_t
  */
 void show_top_level(void)
 {
-  pc.printf("1) Uart Baudrate Setting [%6dbps]\r\n", uart_baud_);
-  pc.printf("2) Uart Format Setting   [%d%s%d]\r\n",
-            uart_bits_,
-            (uart_parity_ == Serial::None ) ? "N" :
-            (uart_parity_ == Serial::Even ) ? "E" : "O",
-            uart_stop_bits_);
-  pc.printf("R) Run Main Program.\r\n");
-  pc.printf("Db) Run Uart Dump[BIN].\r\n");
-  pc.printf("Dh) Run Uart Dump[HEX]. \r\n");
+  console.printf("1) Uart Baudrate Setting [%6dbps]\r\n", uart_baud_);
+  console.printf("2) Uart Format Setting   [%d%s%d]\r\n",
+               uart_bits_,
+               (uart_parity_ == Serial::None ) ? "N" :
+               (uart_parity_ == Serial::Even ) ? "E" : "O",
+               uart_stop_bits_);
+  console.printf("R) Run Main Program.\r\n");
+  console.printf("Db) Run Uart Dump[BIN].\r\n");
+  console.printf("Dh) Run Uart Dump[HEX]. \r\n");
+  console.printf("Dt) Run Uart Capture[per byte].\r\n");
+  console.printf("Dg) Run Uart Capture[per burst].\r\n");
+  console.printf("Da) Run Modbus RTU Analyzer.\r\n");
+  console.printf("I) Show Idle Time.\r\n");
 }
 
 /**
@@ -151,6 +287,7 @@ void show_top_level(void)
  */
 void top_level_menu_entry(void)
 {
+  console.policy(seekers::console_sink::POLICY_BLOCK);
   show_top_level();
   runtime_loop = top_level_menu_loop;
 }
@@ -158,20 +295,12 @@ void top_level_menu_entry(void)
 /**
  * @brief トップレベルのメニュー処理
  */
-void top_level_menu_loop(void)
+void top_level_menu_loop(uint32_t events)
 {
-  int ch = pc.getc();
-  if(ch >= 0)
-  {
-    if(ch == '\r'){
-      pc.putc('\r'); pc.putc('\n');
-      std::string cmd = parse_cmd(cmd_buf_);
-      menu_select(cmd, top_menu_, top_level_menu_entry);
-      cmd_buf_.clear();
-    }else{
-      pc.putc(ch);
-      cmd_buf_.push_back(ch);
-    }
+  if(read_line(events)){
+    std::string cmd = parse_cmd(cmd_buf_);
+    menu_select(cmd, top_menu_, top_level_menu_entry);
+    cmd_buf_.clear();
   }
 }
 
@@ -183,25 +312,27 @@ void run_entry()
   uart.baud(uart_baud_);
   uart.format(uart_bits_, uart_parity_, uart_stop_bits_);
 
-  pc.printf("Run Main process.\r\n");
-  pc.printf("Uart: %6dbps %d%s%d.\r\n",
-            uart_baud_,
-            uart_bits_,
-            (uart_parity_ == Serial::None ) ? "N" :
-            (uart_parity_ == Serial::Even ) ? "E" : "O",
-            uart_stop_bits_
+  console.printf("Run Main process.\r\n");
+  console.printf("Uart: %6dbps %d%s%d.\r\n",
+               uart_baud_,
+               uart_bits_,
+               (uart_parity_ == Serial::None ) ? "N" :
+               (uart_parity_ == Serial::Even ) ? "E" : "O",
+               uart_stop_bits_
   );
+  run_ticker.attach(callback(run_tick), 1);
   runtime_loop = run_loop;
 }
 
 /**
  * 実際の動作
  */
-void run_loop(void)
+void run_loop(uint32_t events)
 {
-  Thread::wait(1000);
-  pc.printf("Hello.\r\n");
-  uart.printf("Hello.\r\n");
+  if(events & EVENT_TICK){
+    console.printf("Hello.\r\n");
+    uart.printf("Hello.\r\n");
+  }
 }
 
 /**
@@ -209,7 +340,7 @@ void run_loop(void)
  */
 void baud_entry(void)
 {
-  pc.printf("Uart Baudrate setup. now [%6dbps]\r\n>", uart_baud_);
+  console.printf("Uart Baudrate setup. now [%6dbps]\r\n>", uart_baud_);
   runtime_loop = &baud_setup_loop;
 }
 
@@ -226,10 +357,10 @@ void baud_setting(const std::string& cmd)
   case 38400:
   case 115200:
     uart_baud_ = baud;
-    pc.printf("change baudrate.\r\n");
+    console.printf("change baudrate.\r\n");
     break;
   default:
-    pc.printf("[ERROR] invalidate baudrate.\r\n");
+    console.printf("[ERROR] invalidate baudrate.\r\n");
   }
   (scene_stack_.pop())();
 }
@@ -237,20 +368,12 @@ void baud_setting(const std::string& cmd)
 /**
  * @brief ボーレートコマンドの受付
  */
-void baud_setup_loop(void)
+void baud_setup_loop(uint32_t events)
 {
-  int ch = pc.getc();
-  if(ch >= 0)
-  {
-    if(ch == '\r'){
-      pc.putc('\r'); pc.putc('\n');
-      std::string cmd = parse_cmd(cmd_buf_);
-      baud_setting(cmd);
-      cmd_buf_.clear();
-    }else{
-      pc.putc(ch);
-      cmd_buf_.push_back(ch);
-    }
+  if(read_line(events)){
+    std::string cmd = parse_cmd(cmd_buf_);
+    baud_setting(cmd);
+    cmd_buf_.clear();
   }
 }
 
@@ -259,11 +382,11 @@ void baud_setup_loop(void)
  */
 void format_entry(void)
 {
-  pc.printf("Uart format setup. now [%d%s%d]\r\n>",
-            uart_bits_,
-            (uart_parity_ == Serial::None ) ? "N" :
-            (uart_parity_ == Serial::Even ) ? "E" : "O",
-            uart_stop_bits_ );
+  console.printf("Uart format setup. now [%d%s%d]\r\n>",
+               uart_bits_,
+               (uart_parity_ == Serial::None ) ? "N" :
+               (uart_parity_ == Serial::Even ) ? "E" : "O",
+               uart_stop_bits_ );
   runtime_loop = &format_setup_loop;
 }
 
@@ -273,7 +396,7 @@ void format_entry(void)
 void format_setting(const std::string& cmd)
 {
   if( cmd.size() != 3 )
-    pc.printf("[ERROR] invalid format.\r\n");
+    console.printf("[ERROR] invalid format.\r\n");
   const bool test_bits = (cmd[0] == '7' || cmd[0] == '8');
   const bool test_parity = (cmd[1] == 'N' || cmd[1] == 'n'
                             || cmd[1] == 'O' || cmd[1] == 'o'
@@ -285,9 +408,9 @@ void format_setting(const std::string& cmd)
     uart_parity_ = (cmd[1] == 'N' || cmd[1] == 'n' ) ? Serial::None :
       (cmd[1] == 'O' || cmd[1] == 'o' ) ? Serial::Odd : Serial::Even;
     uart_stop_bits_ = (cmd[2] == '1') ? 1 : 2;
-    pc.printf("change format.\r\n");
+    console.printf("change format.\r\n");
   }else{
-    pc.printf("[ERROR] invalid format.\r\n");
+    console.printf("[ERROR] invalid format.\r\n");
   }
   (scene_stack_.pop())();
 }
@@ -295,20 +418,12 @@ void format_setting(const std::string& cmd)
 /**
  * @brief フォーマットコマンドの受付
  */
-void format_setup_loop(void)
+void format_setup_loop(uint32_t events)
 {
-  int ch = pc.getc();
-  if(ch >= 0)
-  {
-    if(ch == '\r'){
-      pc.putc('\r'); pc.putc('\n');
-      std::string cmd = parse_cmd(cmd_buf_);
-      format_setting(cmd);
-      cmd_buf_.clear();
-    }else{
-      pc.putc(ch);
-      cmd_buf_.push_back(ch);
-    }
+  if(read_line(events)){
+    std::string cmd = parse_cmd(cmd_buf_);
+    format_setting(cmd);
+    cmd_buf_.clear();
   }
 }
 
@@ -320,24 +435,30 @@ void bin_dump_entry(void)
   uart.baud(uart_baud_);
   uart.format(uart_bits_, uart_parity_, uart_stop_bits_);
 
-  pc.printf("=== Uart BIN Dump Mode ===\r\n");
-  pc.printf("Uart: %6dbps %d%s%d.\r\n",
-            uart_baud_,
-            uart_bits_,
-            (uart_parity_ == Serial::None ) ? "N" :
-            (uart_parity_ == Serial::Even ) ? "E" : "O",
-            uart_stop_bits_
+  console.printf("=== Uart BIN Dump Mode ===\r\n");
+  console.printf("Uart: %6dbps %d%s%d.\r\n",
+               uart_baud_,
+               uart_bits_,
+               (uart_parity_ == Serial::None ) ? "N" :
+               (uart_parity_ == Serial::Even ) ? "E" : "O",
+               uart_stop_bits_
   );
+  console.policy(seekers::console_sink::POLICY_DROP);
+  dump_overrun_base_ = uart.rx_overrun();
+  dump_console_base_ = console.dropped();
   mark_printer.attach(callback(mark_print), 10);
   runtime_loop = &bin_dump_loop;
 }
 
-void bin_dump_loop(void)
+void bin_dump_loop(uint32_t events)
 {
-  if(uart.readable()){
-    int ch = uart.getc();
-    if(ch >= 0)
-      pc.putc(ch);
+  if(events & EVENT_MARK)
+    mark_output(uart.rx_overrun() - dump_overrun_base_ + console.dropped() - dump_console_base_);
+  if(events & EVENT_UART_RX){
+    uint8_t buff[64];
+    size_t n;
+    while(0 != (n = uart.read(buff, sizeof(buff))))
+      console.write(buff, n);
   }
 }
 
@@ -349,26 +470,234 @@ void hex_dump_entry(void)
   uart.baud(uart_baud_);
   uart.format(uart_bits_, uart_parity_, uart_stop_bits_);
 
-  pc.printf("=== Uart Hex Dump Mode ===\r\n");
-  pc.printf("Uart: %6dbps %d%s%d.\r\n",
-            uart_baud_,
-            uart_bits_,
-            (uart_parity_ == Serial::None ) ? "N" :
-            (uart_parity_ == Serial::Even ) ? "E" : "O",
-            uart_stop_bits_
+  console.printf("=== Uart Hex Dump Mode ===\r\n");
+  console.printf("Uart: %6dbps %d%s%d.\r\n",
+               uart_baud_,
+               uart_bits_,
+               (uart_parity_ == Serial::None ) ? "N" :
+               (uart_parity_ == Serial::Even ) ? "E" : "O",
+               uart_stop_bits_
   );
+  console.policy(seekers::console_sink::POLICY_DROP);
+  hex_dumper.reset();
+  hex_dumper.line_break(false);
+  hex_dump_idle_bytes_ = 0;
+  dump_overrun_base_ = uart.rx_overrun();
   mark_printer.attach(callback(mark_print), 10);
+  capture_ticker.attach_us(callback(run_tick), 10000);
   runtime_loop = &hex_dump_loop;
 }
 
-void hex_dump_loop(void)
+/**
+ * @brief HEXダンプ
+ * 受信バッファをまとめて取り出して16byte単位で出力する. 行の途中までの出力は、
+ * 受信が途切れた時(前回の周期から受信無し), console の送信待ちが無い時(出力が途切れないように),
+ * マークの前のみとする(出力が追い付かない間は受信毎には出力しない).
+ */
+void hex_dump_loop(uint32_t events)
+{
+  if(events & EVENT_MARK){
+    hex_dumper.end_line();
+    mark_output(uart.rx_overrun() - dump_overrun_base_ + hex_dumper.dropped());
+  }
+  if(events & EVENT_UART_RX){
+    uint8_t buff[64];
+    size_t n;
+    while(0 != (n = uart.read(buff, sizeof(buff))))
+      hex_dumper.put(buff, n);
+    if(0 == console.pending())
+      hex_dumper.flush();
+  }
+  if(events & EVENT_TICK){
+    if(hex_dumper.bytes() == hex_dump_idle_bytes_)
+      hex_dumper.flush();
+    hex_dump_idle_bytes_ = hex_dumper.bytes();
+  }
+}
+
+/**
+ * @brief 受信時刻付きキャプチャ エントリ
+ * 表示の後、pc へ capture_stream の記録形式で出力する(ホスト側 capture2pcapng で変換).
+ * 塊の区切りは t1.5 とし、塊の間隔から t3.5 違反を判別できるようにする.
+ */
+void capture_entry(seekers::capture_stream::mode_t mode)
+{
+  uart.capture_attach(NULL);
+  uart.baud(uart_baud_);
+  uart.format(uart_bits_, uart_parity_, uart_stop_bits_);
+
+  console.printf("=== Uart Capture Mode [%s] ===\r\n",
+               (seekers::capture_stream::MODE_BYTE == mode) ? "per byte" : "per burst");
+  console.printf("Uart: %6dbps %d%s%d.\r\n",
+               uart_baud_,
+               uart_bits_,
+               (uart_parity_ == Serial::None ) ? "N" :
+               (uart_parity_ == Serial::Even ) ? "E" : "O",
+               uart_stop_bits_
+  );
+
+  seekers::RS485Serial::rx_stamp_t stamp;
+  while(uart_capture_.pop(stamp))
+    ;
+  capture_overrun_base_ = uart_capture_.overrun();
+  capturer.start(mode, uart_baud_, uart.bit_length(),
+                 seekers::modbus_rtu_timing::t15_us(uart_baud_, uart.bit_length()));
+  console.policy(seekers::console_sink::POLICY_DROP);  // ヘッダまでは破棄しない
+  uart.capture_attach(&uart_capture_);
+  capture_ticker.attach_us(callback(run_tick), 10000);
+  runtime_loop = &capture_loop;
+}
+
+void capture_byte_entry(void)
+{
+  capture_entry(seekers::capture_stream::MODE_BYTE);
+}
+
+void capture_burst_entry(void)
+{
+  capture_entry(seekers::capture_stream::MODE_BURST);
+}
+
+void capture_loop(uint32_t events)
+{
+  if(events & EVENT_UART_RX){
+    seekers::RS485Serial::rx_stamp_t stamp;
+    while(uart_capture_.pop(stamp))
+      capturer.put(stamp.us, stamp.c);
+  }
+  const uint32_t overrun = uart_capture_.overrun();
+  capturer.lost(overrun - capture_overrun_base_);
+  capture_overrun_base_ = overrun;
+  if(events & EVENT_TICK)
+    capturer.idle(us_ticker_read());
+}
+
+/**
+ * @brief MODBUS RTU 解析 エントリ
+ * uart の受信データを受信時刻付きで受け取り、要求/応答を集計する(送信はしない).
+ * p: 集計の表示, r: 集計の初期化, q: 終了
+ */
+void analyzer_entry(void)
 {
-  if(uart.readable()){
-    int ch = uart.getc();
-    if(ch >= 0){
-      pc.printf("%02xh ", ch);
+  uart.capture_attach(NULL);
+  uart.baud(uart_baud_);
+  uart.format(uart_bits_, uart_parity_, uart_stop_bits_);
+
+  console.printf("=== Modbus RTU Analyzer ===\r\n");
+  console.printf("Uart: %6dbps %d%s%d.\r\n",
+               uart_baud_,
+               uart_bits_,
+               (uart_parity_ == Serial::None ) ? "N" :
+               (uart_parity_ == Serial::Even ) ? "E" : "O",
+               uart_stop_bits_
+  );
+  console.printf("p) print, r) reset, q) quit.\r\n");
+
+  seekers::RS485Serial::rx_stamp_t stamp;
+  while(uart_capture_.pop(stamp))
+    ;
+  capture_overrun_base_ = uart_capture_.overrun();
+  analyzer_.reset();
+  analyzer_.timing(uart_baud_, uart.bit_length());
+  uart.capture_attach(&uart_capture_);
+  capture_ticker.attach_us(callback(run_tick), 10000);
+  runtime_loop = &analyzer_loop;
+}
+
+/**
+ * @brief 解析結果の表示
+ */
+void analyzer_print(void)
+{
+  const seekers::modbus_rtu_analyzer::totals_t& totals = analyzer_.totals();
+  const uint32_t elapsed_ms = analyzer_.elapsed_us() / 1000;
+  // 最長約200文字. console.printf() は LONGBUFSIZE(512)未満なら切り捨てない
+  console.printf("elapsed %ums, frames %u, bytes %u, crc errors %u, garbage %u, broadcasts %u, orphans %u, overflow %u, lost %u\r\n",
+               elapsed_ms, totals.frames, totals.bytes, totals.crc_errors, totals.garbage,
+               totals.broadcasts, totals.orphans, totals.overflow,
+               uart_capture_.overrun() - capture_overrun_base_);
+
+  for(int ii = 0; ii < analyzer_.entry_num(); ++ii){
+    const seekers::modbus_rtu_analyzer::entry_t& e = analyzer_.entry(ii);
+    // 要求数/秒(小数1桁)
+    const uint32_t rate_x10 = (0 == elapsed_ms) ? 0 : (uint32_t)((uint64_t)e.requests * 10000 / elapsed_ms);
+    const uint32_t answered = e.responses + e.exceptions;
+    console.printf("[%3u:%02X] req %u (%u.%u/s), resp %u, exc %u, timeout %u",
+                 e.slave, e.function, e.requests, rate_x10 / 10, rate_x10 % 10,
+                 e.responses, e.exceptions, e.timeouts);
+    if(0 != answered){
+      console.printf(", avg %ums, min %ums, max %ums",
+                   (uint32_t)(e.response_sum_us / answered / 1000),
+                   e.response_min_us / 1000, e.response_max_us / 1000);
+    }
+    console.printf("\r\n");
+    for(int jj = 0; jj < seekers::modbus_rtu_analyzer::HISTOGRAM_NUM; ++jj){
+      if(0 == e.histogram[jj]) continue;
+      const uint32_t limit = seekers::modbus_rtu_analyzer::histogram_limit_ms(jj);
+      if(0 != limit)
+        console.printf("    <%4ums : %u\r\n", limit, e.histogram[jj]);
+      else
+        console.printf("    >=%3ums : %u\r\n", seekers::modbus_rtu_analyzer::histogram_limit_ms(jj - 1), e.histogram[jj]);
     }
   }
+
+  console.printf("crc errors by slave:");
+  for(int ii = 0; ii < 256; ++ii){
+    const uint32_t n = analyzer_.crc_errors((uint8_t)ii);
+    if(0 != n) console.printf(" [%u] %u", ii, n);
+  }
+  console.printf("\r\n");
+}
+
+void analyzer_loop(uint32_t events)
+{
+  if(events & EVENT_UART_RX){
+    seekers::RS485Serial::rx_stamp_t stamp;
+    while(uart_capture_.pop(stamp))
+      analyzer_.put(stamp.us, stamp.c);
+  }
+  if(events & EVENT_TICK)
+    analyzer_.idle(us_ticker_read());
+  if(events & EVENT_PC_RX){
+    uint8_t ch;
+    while(pc_rx.pop(ch)){
+      switch(ch){
+      case 'p':
+        analyzer_print();
+        break;
+      case 'r':
+        capture_overrun_base_ = uart_capture_.overrun();
+        analyzer_.reset();
+        console.printf("reset.\r\n");
+        break;
+      case 'q':
+        capture_ticker.detach();
+        uart.capture_attach(NULL);
+        if(!pc_rx.empty())
+          runtime_events.post(EVENT_PC_RX);
+        (scene_stack_.pop())();
+        return;
+      default:
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * @brief アイドル率の表示
+ * 前回の表示(起動)からの経過時間に占めるスリープ時間の割合を表示して計測をやり直す.
+ */
+void idle_entry(void)
+{
+  const uint32_t idle = runtime_events.idle_permille();
+  console.printf("Idle: %u.%u%% (%ums, wakeup %u, stall max %uus)\r\n",
+               idle / 10, idle % 10,
+               runtime_events.window_us() / 1000,
+               runtime_events.wakeups(),
+               runtime_events.busy_max_us());
+  runtime_events.reset_idle();
+  (scene_stack_.pop())();
 }
 
 /**
@@ -378,21 +707,28 @@ void setup(void)
 {
   pc.baud(115200);
   pc.format(8, Serial::None, 1);
-  pc.printf("\r\n=== mbed5-shell ===\r\n");
-  pc.printf("Version: " SELF_VERSION " BUILD at " __DATE__ " " __TIME__ "\r\n");
+  console.printf("\r\n=== mbed5-shell ===\r\n");
+  console.printf("Version: " SELF_VERSION " BUILD at " __DATE__ " " __TIME__ "\r\n");
 
   uart.baud(uart_baud_);
   uart.format(uart_bits_, uart_parity_, uart_stop_bits_);
 
-  pc.printf("USB Serial: 115200bps 8N1.\r\n");
-  pc.printf("Uart      : %6dbps %d%s%d.\r\n",
-            uart_baud_,
-            uart_bits_,
-            (uart_parity_ == Serial::None ) ? "N" :
-            (uart_parity_ == Serial::Even ) ? "E" : "O",
-            uart_stop_bits_
+  console.printf("USB Serial: 115200bps 8N1.\r\n");
+  console.printf("Uart      : %6dbps %d%s%d.\r\n",
+               uart_baud_,
+               uart_bits_,
+               (uart_parity_ == Serial::None ) ? "N" :
+               (uart_parity_ == Serial::Even ) ? "E" : "O",
+               uart_stop_bits_
   );
 
+  pc.attach(callback(pc_rx_handler), RawSerial::RxIrq);
+  uart.rx_attach(callback(uart_rx_handler));
+#if SEEKERS_UART_DMA
+  uart.dma_attach(&uart_dma);
+#endif
+  runtime_events.reset_idle();
+
   top_level_menu_entry();
   runtime_loop = top_level_menu_loop;
 }
@@ -404,5 +740,5 @@ int main()
 {
   setup();
   for(;;)
-    runtime_loop();
+    runtime_loop(runtime_events.wait());
 }
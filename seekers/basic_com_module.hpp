@@ -6,6 +6,10 @@
  * @par history
  * - 2016-11-07 20:05:56
  *  - First.
+ * - 2026-10-17 14:52:30
+ *  - フレーム単位の受信 recieve_frame() を追加.
+ * - 2026-10-17 17:20:06
+ *  - 固定容量バッファ(frame_buff_t)版のインタフェースを追加.
  */
 
 #ifndef SEEKERS_BASIC_COMM_MODULE_HPP
@@ -15,21 +19,107 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <stdint.h>
+#include <vector>
+
+#include "static_vector.hpp"
+
 namespace seekers{
 
 
 typedef std::vector<uint8_t>::iterator buff_iter_t;
 
+/**
+ * @brief 送信バッファ(RTU最大フレーム長)
+ */
+typedef static_vector<uint8_t, 256> frame_buff_t;
+
 
 /**
  * @brief com_module interface.
+ * frame_buff_t 版の既定は std::vector 版への変換(一時領域にヒープを使用する).
  */
 class basic_com_module{
 public:
   virtual void recieve(std::vector<uint8_t>& tx_buf, const uint8_t* src, size_t size) = 0;
   virtual void idle(std::vector<uint8_t>& tx_buf) = 0;
 
+  /**
+   * @brief フレーム単位の受信
+   * 下位層でフレーム終端(t3.5)を検出済みの1フレームを渡す. 既定は recieve() と同じ.
+   */
+  virtual void recieve_frame(std::vector<uint8_t>& tx_buf, const uint8_t* src, size_t size)
+  {
+    recieve(tx_buf, src, size);
+  }
+
+  virtual void recieve(frame_buff_t& tx_buf, const uint8_t* src, size_t size)
+  {
+    std::vector<uint8_t> buf;
+    recieve(buf, src, size);
+    append_(tx_buf, buf);
+  }
+
+  virtual void idle(frame_buff_t& tx_buf)
+  {
+    std::vector<uint8_t> buf;
+    idle(buf);
+    append_(tx_buf, buf);
+  }
+
+  virtual void recieve_frame(frame_buff_t& tx_buf, const uint8_t* src, size_t size)
+  {
+    std::vector<uint8_t> buf;
+    recieve_frame(buf, src, size);
+    append_(tx_buf, buf);
+  }
+
   virtual ~basic_com_module(){}
+
+private:
+  static void append_(frame_buff_t& dst, const std::vector<uint8_t>& src)
+  {
+    if(!src.empty())
+      dst.insert(dst.end(), &src[0], &src[0] + src.size());
+  }
+};
+
+
+/**
+ * @brief com_module interface(ヒープ不使用).
+ * frame_buff_t 版を実装する. std::vector 版は frame_buff_t 版への変換.
+ * 派生クラスで一方のみ再定義する場合は using で他方を公開すること.
+ */
+class basic_static_com_module : public basic_com_module{
+public:
+  virtual void recieve(frame_buff_t& tx_buf, const uint8_t* src, size_t size) = 0;
+  virtual void idle(frame_buff_t& tx_buf) = 0;
+
+  virtual void recieve_frame(frame_buff_t& tx_buf, const uint8_t* src, size_t size)
+  {
+    recieve(tx_buf, src, size);
+  }
+
+  void recieve(std::vector<uint8_t>& tx_buf, const uint8_t* src, size_t size)
+  {
+    frame_buff_t buf;
+    recieve(buf, src, size);
+    tx_buf.insert(tx_buf.end(), buf.begin(), buf.end());
+  }
+
+  void idle(std::vector<uint8_t>& tx_buf)
+  {
+    frame_buff_t buf;
+    idle(buf);
+    tx_buf.insert(tx_buf.end(), buf.begin(), buf.end());
+  }
+
+  void recieve_frame(std::vector<uint8_t>& tx_buf, const uint8_t* src, size_t size)
+  {
+    frame_buff_t buf;
+    recieve_frame(buf, src, size);
+    tx_buf.insert(tx_buf.end(), buf.begin(), buf.end());
+  }
 };
 
 
@@ -0,0 +1,171 @@
+/**
+ * @file capture_stream.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 22:10:31
+ *  - first.
+ */
+
+#include <string.h>
+#include "capture_stream.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンストラクタ
+ */
+capture_stream::capture_stream(writer_t writer, void* context) :
+  writer_(writer),
+  context_(context),
+  mode_(MODE_BYTE),
+  gap_us_(0),
+  burst_len_(0),
+  burst_first_us_(0),
+  burst_last_us_(0),
+  last_us_(0),
+  sync_(true),
+  lost_pending_(0),
+  records_(0),
+  lost_(0)
+{}
+
+size_t capture_stream::varint_(uint8_t* dst, uint32_t value)
+{
+  size_t len = 0;
+  while(value >= 0x80){
+    dst[len++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  dst[len++] = (uint8_t)value;
+  return len;
+}
+
+/**
+ * @brief 記録の開始. ヘッダを出力する
+ * @param gap_us MODE_BURST で塊を区切る文字間隔[us]. t3.5 違反を見るには t1.5 程度とする
+ */
+void capture_stream::start(mode_t mode, uint32_t baud, uint8_t bit_length, uint32_t gap_us)
+{
+  mode_ = mode;
+  gap_us_ = gap_us;
+  burst_len_ = 0;
+  sync_ = true;
+  lost_pending_ = 0;
+  records_ = 0;
+  lost_ = 0;
+
+  size_t len = 0;
+  record_[len++] = 'R';
+  record_[len++] = 'S';
+  record_[len++] = 'C';
+  record_[len++] = '1';
+  record_[len++] = (uint8_t)mode;
+  len += varint_(record_ + len, baud);
+  record_[len++] = bit_length;
+  len += varint_(record_ + len, gap_us);
+  writer_(context_, record_, len);
+}
+
+/**
+ * @brief SYNC, LOST の付加
+ * @return 付加した長さ
+ */
+size_t capture_stream::prefix_(uint32_t us)
+{
+  size_t len = 0;
+  if(sync_){
+    record_[len++] = TAG_SYNC;
+    record_[len++] = (uint8_t)(us);
+    record_[len++] = (uint8_t)(us >> 8);
+    record_[len++] = (uint8_t)(us >> 16);
+    record_[len++] = (uint8_t)(us >> 24);
+  }
+  if(0 != lost_pending_){
+    record_[len++] = TAG_LOST;
+    len += varint_(record_ + len, lost_pending_);
+  }
+  return len;
+}
+
+/**
+ * @brief 記録の出力
+ * @param us 記録の時刻
+ * @param bytes 記録した受信データのbyte数
+ */
+void capture_stream::emit_(size_t size, uint32_t us, uint32_t bytes)
+{
+  if(writer_(context_, record_, size)){
+    ++records_;
+    sync_ = false;
+    lost_pending_ = 0;
+    last_us_ = us;
+  }else{
+    // 差分の基準が失われるため次の記録は SYNC から
+    sync_ = true;
+    lost_pending_ += bytes;
+    lost_ += bytes;
+  }
+}
+
+void capture_stream::close_burst_(void)
+{
+  if(0 == burst_len_) return;
+  size_t len = prefix_(burst_first_us_);
+  const uint32_t delta = sync_ ? 0 : burst_first_us_ - last_us_;
+  record_[len++] = TAG_BURST;
+  len += varint_(record_ + len, delta);
+  len += varint_(record_ + len, burst_len_);
+  len += varint_(record_ + len, burst_last_us_ - burst_first_us_);
+  memcpy(record_ + len, burst_, burst_len_);
+  len += burst_len_;
+  emit_(len, burst_first_us_, burst_len_);
+  burst_len_ = 0;
+}
+
+/**
+ * @brief 受信データの記録
+ * @param us 受信時刻(RS485Serial::rx_stamp_t)
+ */
+void capture_stream::put(uint32_t us, uint8_t c)
+{
+  if(MODE_BYTE == mode_){
+    size_t len = prefix_(us);
+    const uint32_t delta = sync_ ? 0 : us - last_us_;
+    record_[len++] = TAG_BYTE;
+    len += varint_(record_ + len, delta);
+    record_[len++] = c;
+    emit_(len, us, 1);
+    return;
+  }
+
+  if(0 != burst_len_ && (us - burst_last_us_ > gap_us_ || BURST_SIZE == burst_len_))
+    close_burst_();
+  if(0 == burst_len_)
+    burst_first_us_ = us;
+  burst_[burst_len_++] = c;
+  burst_last_us_ = us;
+}
+
+/**
+ * @brief 無通信時間の判定. 最終受信から gap_us を超えていれば塊を出力する
+ */
+void capture_stream::idle(uint32_t now_us)
+{
+  if(0 != burst_len_ && now_us - burst_last_us_ > gap_us_)
+    close_burst_();
+}
+
+/**
+ * @brief 入力側で失われたbyte数(受信バッファ溢れ等). 次の記録に付加する
+ */
+void capture_stream::lost(uint32_t size)
+{
+  if(0 == size) return;
+  close_burst_();
+  lost_pending_ += size;
+  lost_ += size;
+}
+
+} /* namespace */
@@ -0,0 +1,103 @@
+/**
+ * @file capture_stream.hpp
+ * @brief 受信時刻付きキャプチャの記録形式
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 22:10:31
+ *  - First.
+ */
+
+#ifndef SEEKERS_CAPTURE_STREAM_HPP
+#define SEEKERS_CAPTURE_STREAM_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+namespace seekers{
+
+/**
+ * @brief 受信時刻付きキャプチャの記録形式(符号化)
+ * 受信データを1byte毎、または無通信時間(gap_us を超える文字間隔)で区切った塊毎に、
+ * 前回の記録からの経過時間[us](varint)と共に記録する. 時刻は32bit(us_ticker)の差分で扱うため周回しない.
+ *
+ * 記録形式(多byte整数はリトルエンディアン, varint は7bit毎の可変長):
+ *  - ヘッダ : 'R' 'S' 'C' '1', mode(1), baud(varint), bit_length(1), gap_us(varint)
+ *  - TAG_SYNC  : 0x04, 時刻(4). 以降の差分の基準. 開始時と記録を破棄した後に付加する
+ *  - TAG_LOST  : 0x03, 破棄したbyte数(varint). 受信バッファ溢れ, 出力が追い付かない場合
+ *  - TAG_BYTE  : 0x01, 差分(varint), データ(1)
+ *  - TAG_BURST : 0x02, 先頭の差分(varint), byte数(varint), 先頭から末尾までの時間(varint), データ
+ * 記録は1回の writer 呼び出しで渡す. writer が受け付けなかった記録は LOST として扱う.
+ */
+class capture_stream{
+public:
+  enum mode_t{
+    MODE_BYTE = 0,  ///< 1byte毎
+    MODE_BURST = 1  ///< 無通信時間で区切った塊毎
+  };
+
+  enum tag_t{
+    TAG_BYTE = 0x01,
+    TAG_BURST = 0x02,
+    TAG_LOST = 0x03,
+    TAG_SYNC = 0x04
+  };
+
+  static const size_t BURST_SIZE = 256;
+
+  /**
+   * @brief 出力先
+   * @return 全て受け付けたらtrue. falseなら全て破棄されたものとする
+   */
+  typedef bool (*writer_t)(void* context, const uint8_t* src, size_t size);
+
+private:
+  writer_t writer_;
+  void* context_;
+
+  mode_t mode_;
+  uint32_t gap_us_;
+
+  uint8_t burst_[BURST_SIZE];
+  size_t burst_len_;
+  uint32_t burst_first_us_;
+  uint32_t burst_last_us_;
+
+  uint32_t last_us_;       // 前回の記録の時刻(差分の基準)
+  bool sync_;              // 次の記録に TAG_SYNC を付加
+  uint32_t lost_pending_;  // 次の記録に付加する破棄数
+
+  uint32_t records_;
+  uint32_t lost_;
+
+  // 記録の組み立て(SYNC + LOST + BURST最大長)
+  uint8_t record_[5 + 6 + 1 + 5 + 5 + 5 + BURST_SIZE];
+
+  static size_t varint_(uint8_t* dst, uint32_t value);
+  size_t prefix_(uint32_t us);
+  void emit_(size_t size, uint32_t us, uint32_t bytes);
+  void close_burst_(void);
+
+public:
+  capture_stream(writer_t writer, void* context);
+
+  void start(mode_t mode, uint32_t baud, uint8_t bit_length, uint32_t gap_us);
+  void put(uint32_t us, uint8_t c);
+  void idle(uint32_t now_us);
+  void lost(uint32_t size);
+
+  uint32_t records(void) const { return records_; }
+  uint32_t lost_total(void) const { return lost_; }
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_CAPTURE_STREAM_HPP */
@@ -0,0 +1,216 @@
+/**
+ * @file crc16.hpp
+ * @brief crc16計算エンジン(テーブル/ニブル/スライス方式)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 09:12:40
+ *  - First.
+ */
+
+#ifndef SEEKERS_CRC16_HPP
+#define SEEKERS_CRC16_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace seekers{
+
+namespace crc16_detail{
+
+/**
+ * @brief 1bit毎のシフトをBIT回コンパイル時に展開
+ */
+template <int POLY, unsigned V, int BIT>
+struct shift{
+  enum { value = shift<POLY, ((V & 1) ? ((V >> 1) ^ POLY) : (V >> 1)), BIT - 1>::value };
+};
+
+template <int POLY, unsigned V>
+struct shift<POLY, V, 0>{
+  enum { value = V };
+};
+
+/**
+ * @brief スライス用テーブル要素
+ * K = 0 : 通常の256要素テーブル
+ * K > 0 : 後続にK byteの0が続く場合の値
+ */
+template <int POLY, unsigned N, int K>
+struct slice{
+  enum {
+    prev = slice<POLY, N, K - 1>::value,
+    value = (prev >> 8) ^ slice<POLY, (prev & 0xff), 0>::value
+  };
+};
+
+template <int POLY, unsigned N>
+struct slice<POLY, N, 0>{
+  enum { value = shift<POLY, N, 8>::value };
+};
+
+} /* namespace crc16_detail */
+
+#define SEEKERS_CRC16_R4(M, n)  M((n)) M((n) + 1) M((n) + 2) M((n) + 3)
+#define SEEKERS_CRC16_R16(M, n) SEEKERS_CRC16_R4(M, (n)) SEEKERS_CRC16_R4(M, (n) + 4) SEEKERS_CRC16_R4(M, (n) + 8) SEEKERS_CRC16_R4(M, (n) + 12)
+#define SEEKERS_CRC16_R64(M, n) SEEKERS_CRC16_R16(M, (n)) SEEKERS_CRC16_R16(M, (n) + 16) SEEKERS_CRC16_R16(M, (n) + 32) SEEKERS_CRC16_R16(M, (n) + 48)
+#define SEEKERS_CRC16_R256(M)   SEEKERS_CRC16_R64(M, 0) SEEKERS_CRC16_R64(M, 64) SEEKERS_CRC16_R64(M, 128) SEEKERS_CRC16_R64(M, 192)
+
+/**
+ * @brief 256要素テーブル(K > 0 はスライス用)
+ * 値はコンパイル時に確定するためROMに配置される
+ */
+template <int POLY, int K>
+struct crc16_table{
+  static const uint16_t table[256];
+};
+
+#define SEEKERS_CRC16_SLICE_ENTRY(n) (uint16_t)crc16_detail::slice<POLY, (n), K>::value,
+template <int POLY, int K>
+const uint16_t crc16_table<POLY, K>::table[256] = {
+  SEEKERS_CRC16_R256(SEEKERS_CRC16_SLICE_ENTRY)
+};
+#undef SEEKERS_CRC16_SLICE_ENTRY
+
+/**
+ * @brief 16要素テーブル(ニブル単位)
+ */
+template <int POLY>
+struct crc16_nibble_table{
+  static const uint16_t table[16];
+};
+
+#define SEEKERS_CRC16_NIBBLE_ENTRY(n) (uint16_t)crc16_detail::shift<POLY, (n), 4>::value,
+template <int POLY>
+const uint16_t crc16_nibble_table<POLY>::table[16] = {
+  SEEKERS_CRC16_R16(SEEKERS_CRC16_NIBBLE_ENTRY, 0)
+};
+#undef SEEKERS_CRC16_NIBBLE_ENTRY
+
+/**
+ * @brief 1bit毎に計算(テーブル無し)
+ */
+struct crc16_policy_bitwise{
+  template <int POLY>
+  static uint16_t update(uint16_t crc, const uint8_t* data, size_t size)
+  {
+    for(size_t ii = 0; ii < size; ++ii){
+      crc ^= *(data + ii);
+      for(int jj = 0; jj < 8; ++jj){
+        if(crc & 1)
+          crc = (crc >> 1) ^ POLY;
+        else
+          crc >>= 1;
+      }
+    }
+    return crc;
+  }
+};
+
+/**
+ * @brief 4bit毎に計算(32byteテーブル)
+ */
+struct crc16_policy_nibble{
+  template <int POLY>
+  static uint16_t update(uint16_t crc, const uint8_t* data, size_t size)
+  {
+    const uint16_t* t = crc16_nibble_table<POLY>::table;
+    for(size_t ii = 0; ii < size; ++ii){
+      crc ^= *(data + ii);
+      crc = (crc >> 4) ^ t[crc & 0x0f];
+      crc = (crc >> 4) ^ t[crc & 0x0f];
+    }
+    return crc;
+  }
+};
+
+/**
+ * @brief 1byte毎に計算(512byteテーブル)
+ */
+struct crc16_policy_table{
+  template <int POLY>
+  static uint16_t update(uint16_t crc, const uint8_t* data, size_t size)
+  {
+    const uint16_t* t = crc16_table<POLY, 0>::table;
+    for(size_t ii = 0; ii < size; ++ii)
+      crc = (crc >> 8) ^ t[(crc ^ *(data + ii)) & 0xff];
+    return crc;
+  }
+};
+
+/**
+ * @brief 4byte毎に計算(2KBテーブル)
+ */
+struct crc16_policy_slice4{
+  template <int POLY>
+  static uint16_t update(uint16_t crc, const uint8_t* data, size_t size)
+  {
+    const uint16_t* t0 = crc16_table<POLY, 0>::table;
+    const uint16_t* t1 = crc16_table<POLY, 1>::table;
+    const uint16_t* t2 = crc16_table<POLY, 2>::table;
+    const uint16_t* t3 = crc16_table<POLY, 3>::table;
+    for(; size >= 4; size -= 4, data += 4){
+      crc = t3[(crc ^ data[0]) & 0xff]
+        ^ t2[((crc >> 8) ^ data[1]) & 0xff]
+        ^ t1[data[2]]
+        ^ t0[data[3]];
+    }
+    return crc16_policy_table::update<POLY>(crc, data, size);
+  }
+};
+
+/**
+ * @brief 8byte毎に計算(4KBテーブル)
+ */
+struct crc16_policy_slice8{
+  template <int POLY>
+  static uint16_t update(uint16_t crc, const uint8_t* data, size_t size)
+  {
+    const uint16_t* t0 = crc16_table<POLY, 0>::table;
+    const uint16_t* t1 = crc16_table<POLY, 1>::table;
+    const uint16_t* t2 = crc16_table<POLY, 2>::table;
+    const uint16_t* t3 = crc16_table<POLY, 3>::table;
+    const uint16_t* t4 = crc16_table<POLY, 4>::table;
+    const uint16_t* t5 = crc16_table<POLY, 5>::table;
+    const uint16_t* t6 = crc16_table<POLY, 6>::table;
+    const uint16_t* t7 = crc16_table<POLY, 7>::table;
+    for(; size >= 8; size -= 8, data += 8){
+      crc = t7[(crc ^ data[0]) & 0xff]
+        ^ t6[((crc >> 8) ^ data[1]) & 0xff]
+        ^ t5[data[2]]
+        ^ t4[data[3]]
+        ^ t3[data[4]]
+        ^ t2[data[5]]
+        ^ t1[data[6]]
+        ^ t0[data[7]];
+    }
+    return crc16_policy_table::update<POLY>(crc, data, size);
+  }
+};
+
+/**
+ * @brief 既定の計算方式
+ * ROM容量に合わせて SEEKERS_CRC16_POLICY を定義して切り替える
+ * (crc16_policy_bitwise / nibble / table / slice4 / slice8)
+ */
+#ifndef SEEKERS_CRC16_POLICY
+#define SEEKERS_CRC16_POLICY crc16_policy_table
+#endif
+typedef SEEKERS_CRC16_POLICY crc16_policy_default;
+
+/**
+ * @brief crc16計算(方式指定)
+ */
+template <int POLY, typename POLICY>
+uint16_t crc16_calc(const uint8_t* data, size_t size)
+{
+  return POLICY::template update<POLY>(0xffff, data, size);
+}
+
+} /* namespace */
+
+#endif /* SEEKERS_CRC16_HPP */
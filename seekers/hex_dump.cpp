@@ -0,0 +1,113 @@
+/**
+ * @file hex_dump.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 21:40:15
+ *  - first.
+ * - 2026-10-18 00:01:00
+ *  - 改行しない場合は行の区切りで改行を書き込まない.
+ *  - 書き込みが受け付けられなかった場合、出力先の空きに収まる分は1byte単位で書き込む.
+ */
+
+#include "hex_dump.hpp"
+
+namespace seekers{
+
+namespace{
+const char nibble_[16] = {
+  '0', '1', '2', '3', '4', '5', '6', '7',
+  '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
+}
+
+/**
+ * @brief コンストラクタ
+ */
+hex_dump::hex_dump(writer_t writer, void* context) :
+  writer_(writer),
+  context_(context),
+  col_(0),
+  sent_(0),
+  line_break_(true),
+  bytes_(0),
+  lines_(0),
+  dropped_(0)
+{
+  line_[LINE_SIZE - 2] = '\r';
+  line_[LINE_SIZE - 1] = '\n';
+}
+
+/**
+ * @brief 行バッファの未出力部分(sent_ から end まで)の書き込み
+ * 受け付けられなかった場合は、出力先の空きに収まる分を1byte単位で書き込み、残りを破棄する.
+ */
+void hex_dump::emit_(size_t end)
+{
+  if(end <= sent_) return;
+  if(!writer_(context_, line_ + sent_, end - sent_)){
+    const size_t data_end = (end < BYTES_PER_LINE * CHARS_PER_BYTE) ? end : BYTES_PER_LINE * CHARS_PER_BYTE;
+    size_t pos = sent_;
+    while(pos + CHARS_PER_BYTE <= data_end && writer_(context_, line_ + pos, CHARS_PER_BYTE))
+      pos += CHARS_PER_BYTE;
+    if(data_end > pos)
+      dropped_ += (data_end - pos) / CHARS_PER_BYTE;
+  }
+  sent_ = end;
+}
+
+/**
+ * @brief 整形. 1行揃う毎に書き込む
+ */
+void hex_dump::put(const uint8_t* src, size_t size)
+{
+  bytes_ += size;
+  for(size_t ii = 0; ii < size; ++ii){
+    char* p = line_ + col_ * CHARS_PER_BYTE;
+    p[0] = nibble_[src[ii] >> 4];
+    p[1] = nibble_[src[ii] & 0x0f];
+    p[2] = 'h';
+    p[3] = ' ';
+    if(++col_ == BYTES_PER_LINE){
+      emit_(line_break_ ? LINE_SIZE : BYTES_PER_LINE * CHARS_PER_BYTE);
+      ++lines_;
+      col_ = 0;
+      sent_ = 0;
+    }
+  }
+}
+
+/**
+ * @brief 行の途中までの書き込み
+ * 受信が途切れた時点で呼び出し、次の put() は同じ行の続きへ整形する.
+ */
+void hex_dump::flush(void)
+{
+  emit_(col_ * CHARS_PER_BYTE);
+}
+
+/**
+ * @brief 行の途中で改行する(マーク出力の前等). 改行しない場合は行の途中まで書き込み、次の put() から新しい行とする
+ */
+void hex_dump::end_line(void)
+{
+  if(0 == col_) return;
+  flush();
+  if(line_break_)
+    writer_(context_, line_ + LINE_SIZE - 2, 2);
+  ++lines_;
+  col_ = 0;
+  sent_ = 0;
+}
+
+void hex_dump::reset(void)
+{
+  col_ = 0;
+  sent_ = 0;
+  bytes_ = 0;
+  lines_ = 0;
+  dropped_ = 0;
+}
+
+} /* namespace */
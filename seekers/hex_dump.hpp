@@ -0,0 +1,96 @@
+/**
+ * @file hex_dump.hpp
+ * @brief HEXダンプ整形
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 21:40:15
+ *  - First.
+ * - 2026-10-18 00:01:00
+ *  - 行末の改行の有無(line_break())を追加. 受け付けられなかった行は空きに収まる分を1byte単位で書き込む.
+ */
+
+#ifndef SEEKERS_HEX_DUMP_HPP
+#define SEEKERS_HEX_DUMP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+namespace seekers{
+
+/**
+ * @brief HEXダンプ整形
+ * 受信データを1byte "xxh " の書式で、16byte毎に改行した行へ整形して writer へ渡す.
+ * 整形は行バッファ上で4bit毎の変換表を引くのみで、書き込みは行(または flush() までの行の途中)単位でまとめて行う.
+ * writer が受け付けなかった場合(出力が追い付かない)は、出力先の空きに収まる分を1byte("xxh ")単位で
+ * 書き込み、残りの byte 数を dropped() に加算する(1byte毎に書き込む場合と破棄数を揃える).
+ * line_break(false) では改行せず、1byte毎の "%02xh " の出力と同じ出力量とする. 出力先の通信速度で
+ * 律速される場合、改行の分(16byte毎に2文字)だけ出力できる byte 数が減る.
+ */
+class hex_dump{
+public:
+  static const size_t BYTES_PER_LINE = 16;
+  static const size_t CHARS_PER_BYTE = 4;   // "xxh "
+  static const size_t LINE_SIZE = BYTES_PER_LINE * CHARS_PER_BYTE + 2;  // + "\r\n"
+
+  /**
+   * @brief 出力先
+   * @return 全て受け付けたらtrue. falseなら全て破棄されたものとする
+   */
+  typedef bool (*writer_t)(void* context, const char* src, size_t size);
+
+private:
+  writer_t writer_;
+  void* context_;
+
+  char line_[LINE_SIZE];
+  size_t col_;    // 行内の byte 数
+  size_t sent_;   // 行内の出力済み文字数
+  bool line_break_;
+
+  uint32_t bytes_;
+  uint32_t lines_;
+  uint32_t dropped_;
+
+  void emit_(size_t end);
+
+public:
+  hex_dump(writer_t writer, void* context);
+
+  void put(const uint8_t* src, size_t size);
+  void flush(void);
+  void end_line(void);
+
+  /**
+   * @brief 行末の改行の有無(既定 true)
+   */
+  void line_break(bool enable)
+  {
+    line_break_ = enable;
+  }
+
+  /**
+   * @brief 入力側で失われた byte 数の加算(受信バッファ溢れ等)
+   */
+  void drop(uint32_t size)
+  {
+    dropped_ += size;
+  }
+
+  uint32_t bytes(void) const { return bytes_; }
+  uint32_t lines(void) const { return lines_; }
+  uint32_t dropped(void) const { return dropped_; }
+  void reset(void);
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_HEX_DUMP_HPP */
@@ -0,0 +1,214 @@
+/**
+ * @file host/capture2pcapng.cpp
+ * @brief 受信時刻付きキャプチャ(capture_stream)の pcapng 変換(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 22:10:31
+ *  - first.
+ * - 2026-10-18 00:00:50
+ *  - 記録の復号を capture_reader へ分離.
+ *
+ * シェルの Dt/Dg で pc から出力した記録を pcapng へ変換する. 先頭のヘッダ('R' 'S' 'C' '1')より前
+ * (モード表示の文字列等)は読み飛ばす. 1byte/1塊を1パケットとし、時刻は記録の時刻[us]
+ * (開始時を0とする)とする. 破棄(TAG_LOST)は次のパケットのコメントへ記録する.
+ * 塊毎の記録では、塊の間の無通信時間が t3.5 未満の数を標準エラーへ出力する.
+ *
+ * usage: capture2pcapng [-l linktype(既定147: USER0)] [入力(既定標準入力) [出力(既定標準出力)]]
+ *  Wireshark では USER0 に対するプロトコルを設定して参照する(例: mbrtu).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "../capture_stream.hpp"
+#include "capture_reader.hpp"
+
+using namespace seekers;
+using namespace seekers::host;
+
+namespace{
+
+/**
+ * @brief pcapng 出力
+ */
+class pcapng_writer{
+private:
+  FILE* fp_;
+  std::vector<uint8_t> block_;
+
+  void u16_(uint16_t v)
+  {
+    block_.push_back((uint8_t)v);
+    block_.push_back((uint8_t)(v >> 8));
+  }
+
+  void u32_(uint32_t v)
+  {
+    u16_((uint16_t)v);
+    u16_((uint16_t)(v >> 16));
+  }
+
+  void pad_(void)
+  {
+    while(0 != (block_.size() & 3)) block_.push_back(0);
+  }
+
+  void option_(uint16_t code, const void* src, size_t size)
+  {
+    u16_(code);
+    u16_((uint16_t)size);
+    block_.insert(block_.end(), (const uint8_t*)src, (const uint8_t*)src + size);
+    pad_();
+  }
+
+  void begin_(uint32_t type)
+  {
+    block_.clear();
+    u32_(type);
+    u32_(0);  // 長さ(end_で設定)
+  }
+
+  void end_(void)
+  {
+    const uint32_t total = (uint32_t)block_.size() + 4;
+    block_[4] = (uint8_t)total;
+    block_[5] = (uint8_t)(total >> 8);
+    block_[6] = (uint8_t)(total >> 16);
+    block_[7] = (uint8_t)(total >> 24);
+    u32_(total);
+    fwrite(&block_[0], 1, block_.size(), fp_);
+  }
+
+public:
+  explicit pcapng_writer(FILE* fp) : fp_(fp) {}
+
+  void section(const std::string& comment)
+  {
+    begin_(0x0a0d0d0a);
+    u32_(0x1a2b3c4d);
+    u16_(1);
+    u16_(0);
+    u32_(0xffffffff);  // section length 不明
+    u32_(0xffffffff);
+    option_(1, comment.data(), comment.size());  // opt_comment
+    option_(0, NULL, 0);
+    end_();
+  }
+
+  void interface(uint16_t linktype)
+  {
+    begin_(1);
+    u16_(linktype);
+    u16_(0);
+    u32_(0);  // snaplen 無制限
+    const uint8_t tsresol = 6;  // us
+    option_(9, &tsresol, 1);
+    option_(0, NULL, 0);
+    end_();
+  }
+
+  void packet(uint64_t us, const std::vector<uint8_t>& data, const std::string& comment)
+  {
+    begin_(6);
+    u32_(0);
+    u32_((uint32_t)(us >> 32));
+    u32_((uint32_t)us);
+    u32_((uint32_t)data.size());
+    u32_((uint32_t)data.size());
+    block_.insert(block_.end(), data.begin(), data.end());
+    pad_();
+    if(!comment.empty()){
+      option_(1, comment.data(), comment.size());
+      option_(0, NULL, 0);
+    }
+    end_();
+  }
+};
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+  uint16_t linktype = 147;
+  int opt;
+  while(-1 != (opt = getopt(argc, argv, "l:"))){
+    switch(opt){
+    case 'l': linktype = (uint16_t)atoi(optarg); break;
+    default:
+      fprintf(stderr, "usage: %s [-l linktype] [input [output]]\n", argv[0]);
+      return 1;
+    }
+  }
+  FILE* in = (optind < argc) ? fopen(argv[optind], "rb") : stdin;
+  FILE* out = (optind + 1 < argc) ? fopen(argv[optind + 1], "wb") : stdout;
+  if(NULL == in || NULL == out){
+    perror("open");
+    return 1;
+  }
+
+  capture_reader r(in);
+  capture_reader::header_t header;
+  if(!r.header(header)){
+    fprintf(stderr, "%s.\n", r.error());
+    return 1;
+  }
+
+  char text[128];
+  snprintf(text, sizeof(text), "%s, %u bps, %u bits/char, gap %u us",
+           (capture_stream::MODE_BYTE == header.mode) ? "per byte" : "per burst",
+           header.baud, header.bit_length, header.gap_us);
+  pcapng_writer w(out);
+  w.section(text);
+  w.interface(linktype);
+
+  const double char_us = header.bit_length * 1e6 / header.baud;
+  uint64_t prev_last = 0;   // 直前の塊の末尾の時刻
+  bool has_prev = false;
+
+  uint32_t packets = 0;
+  uint32_t bytes = 0;
+  uint32_t t35_violations = 0;
+  uint32_t min_idle_x10 = 0xffffffff;  // 塊の間の最小無通信時間[0.1文字]
+  std::string comment;
+  capture_reader::packet_t packet;
+
+  while(r.next(packet)){
+    comment.clear();
+    if(0 != packet.lost){
+      snprintf(text, sizeof(text), "lost %u bytes before this packet", packet.lost);
+      comment = text;
+      has_prev = false;
+    }
+    w.packet(packet.us, packet.data, comment);
+    ++packets;
+    bytes += packet.data.size();
+
+    if(packet.burst){
+      if(has_prev){
+        // 受信時刻は文字の受信完了時. 無通信時間 = 間隔 - 1文字
+        const double idle = (packet.us - prev_last) / char_us - 1.0;
+        const uint32_t idle_x10 = (idle > 0.0) ? (uint32_t)(idle * 10) : 0;
+        if(idle_x10 < min_idle_x10) min_idle_x10 = idle_x10;
+        if(idle < 3.5) ++t35_violations;
+      }
+      prev_last = packet.us + packet.span_us;
+      has_prev = true;
+    }
+  }
+  const bool ok = NULL == r.error();
+  if(!ok)
+    fprintf(stderr, "%s.\n", r.error());
+
+  fprintf(stderr, "packets %u, bytes %u, lost %u, duration %.6f s\n", packets, bytes, r.lost(), r.now_us() / 1e6);
+  if(capture_stream::MODE_BURST == header.mode && 0xffffffff != min_idle_x10)
+    fprintf(stderr, "bursts with idle < t3.5: %u, min idle %u.%u chars\n",
+            t35_violations, min_idle_x10 / 10, min_idle_x10 % 10);
+  if(out != stdout) fclose(out);
+  return ok ? 0 : 1;
+}
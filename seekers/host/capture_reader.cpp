@@ -0,0 +1,138 @@
+/**
+ * @file host/capture_reader.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-18
+ * @par history
+ * - 2026-10-18 00:00:50
+ *  - first.
+ */
+
+#include "capture_reader.hpp"
+#include "../capture_stream.hpp"
+
+namespace seekers{
+namespace host{
+
+/**
+ * @brief コンストラクタ
+ */
+capture_reader::capture_reader(FILE* fp) :
+  fp_(fp),
+  now_(0),
+  now32_(0),
+  started_(false),
+  lost_(0)
+{
+  error_[0] = '\0';
+}
+
+bool capture_reader::u8_(uint8_t& dst)
+{
+  const int c = fgetc(fp_);
+  if(EOF == c) return false;
+  dst = (uint8_t)c;
+  return true;
+}
+
+bool capture_reader::u32_(uint32_t& dst)
+{
+  uint8_t b[4];
+  if(4 != fread(b, 1, 4, fp_)) return false;
+  dst = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+  return true;
+}
+
+bool capture_reader::varint_(uint32_t& dst)
+{
+  dst = 0;
+  for(int shift = 0; shift < 35; shift += 7){
+    uint8_t b;
+    if(!u8_(b)) return false;
+    dst |= (uint32_t)(b & 0x7f) << shift;
+    if(0 == (b & 0x80)) return true;
+  }
+  return false;
+}
+
+bool capture_reader::bytes_(std::vector<uint8_t>& dst, size_t size)
+{
+  dst.resize(size);
+  return 0 == size || size == fread(&dst[0], 1, size, fp_);
+}
+
+bool capture_reader::fail_(const char* format, int value)
+{
+  snprintf(error_, sizeof(error_), format, value);
+  return false;
+}
+
+/**
+ * @brief ヘッダまで読み飛ばし、ヘッダを読む
+ */
+bool capture_reader::header(header_t& dst)
+{
+  static const char magic[4] = { 'R', 'S', 'C', '1' };
+  size_t matched = 0;
+  uint8_t b;
+  while(4 != matched){
+    if(!u8_(b)) return fail_("header not found");
+    if(b == (uint8_t)magic[matched]){
+      ++matched;
+    }else{
+      matched = (b == (uint8_t)magic[0]) ? 1 : 0;
+    }
+  }
+  if(!u8_(dst.mode) || !varint_(dst.baud) || !u8_(dst.bit_length) || !varint_(dst.gap_us) || 0 == dst.baud)
+    return fail_("broken header");
+  return true;
+}
+
+/**
+ * @brief 次のパケット
+ * @return 記録の終端, 読み出しの中断(error())ならfalse
+ */
+bool capture_reader::next(packet_t& dst)
+{
+  dst.lost = 0;
+  uint8_t tag;
+  while(u8_(tag)){
+    uint32_t v = 0;
+    switch(tag){
+    case capture_stream::TAG_SYNC:
+      if(!u32_(v)) return fail_("broken record");
+      if(!started_){
+        started_ = true;
+      }else{
+        now_ += (uint32_t)(v - now32_);
+      }
+      now32_ = v;
+      break;
+    case capture_stream::TAG_LOST:
+      if(!varint_(v)) return fail_("broken record");
+      dst.lost += v;
+      lost_ += v;
+      break;
+    case capture_stream::TAG_BYTE:
+    case capture_stream::TAG_BURST:{
+      if(!varint_(v)) return fail_("broken record");
+      now_ += v;
+      now32_ += v;
+      uint32_t size = 1;
+      dst.span_us = 0;
+      dst.burst = capture_stream::TAG_BURST == tag;
+      if(dst.burst && !(varint_(size) && varint_(dst.span_us)))
+        return fail_("broken record");
+      if(!bytes_(dst.data, size)) return fail_("broken record");
+      dst.us = now_;
+      return true;
+    }
+    default:
+      return fail_("unknown tag 0x%02x", tag);
+    }
+  }
+  return false;
+}
+
+} /* namespace host */
+} /* namespace seekers */
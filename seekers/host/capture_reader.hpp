@@ -0,0 +1,93 @@
+/**
+ * @file host/capture_reader.hpp
+ * @brief 受信時刻付きキャプチャ(capture_stream)の記録の復号(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-18
+ * @par history
+ * - 2026-10-18 00:00:50
+ *  - First. capture2pcapng から分離.
+ */
+
+#ifndef SEEKERS_HOST_CAPTURE_READER_HPP
+#define SEEKERS_HOST_CAPTURE_READER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+namespace seekers{
+namespace host{
+
+/**
+ * @brief capture_stream の記録の復号
+ * 先頭のヘッダ('R' 'S' 'C' '1')より前(モード表示の文字列等)は読み飛ばす.
+ * TAG_BYTE/TAG_BURST の記録を1パケットとし、時刻は開始時(最初の TAG_SYNC)を0とした時刻[us]とする.
+ * TAG_SYNC で時刻の基準を更新し(32bitの差分で扱うため周回しない)、TAG_LOST の破棄数は次のパケットに付加する.
+ */
+class capture_reader{
+public:
+  /**
+   * @brief ヘッダ
+   */
+  struct header_t{
+    uint8_t mode;        ///< capture_stream::mode_t
+    uint32_t baud;
+    uint8_t bit_length;
+    uint32_t gap_us;
+  };
+
+  /**
+   * @brief 1byte/1塊の記録
+   */
+  struct packet_t{
+    uint64_t us;         ///< 先頭の受信時刻(開始時を0とする)
+    uint32_t span_us;    ///< 先頭から末尾までの時間(TAG_BYTE は0)
+    uint32_t lost;       ///< 直前に破棄されたbyte数
+    bool burst;          ///< TAG_BURST
+    std::vector<uint8_t> data;
+  };
+
+private:
+  FILE* fp_;
+  uint64_t now_;       // 開始時を0とした時刻[us]
+  uint32_t now32_;     // 時刻の下位32bit(us_ticker)
+  bool started_;
+  uint32_t lost_;
+  char error_[32];
+
+  bool u8_(uint8_t& dst);
+  bool u32_(uint32_t& dst);
+  bool varint_(uint32_t& dst);
+  bool bytes_(std::vector<uint8_t>& dst, size_t size);
+  bool fail_(const char* format, int value = 0);
+
+public:
+  explicit capture_reader(FILE* fp);
+
+  bool header(header_t& dst);
+  bool next(packet_t& dst);
+
+  /**
+   * @brief 最後に読んだ時刻[us]
+   */
+  uint64_t now_us(void) const { return now_; }
+
+  /**
+   * @brief TAG_LOST の破棄数の合計
+   */
+  uint32_t lost(void) const { return lost_; }
+
+  /**
+   * @brief 読み出しを中断した理由(記録の終端で終了した場合は NULL)
+   */
+  const char* error(void) const { return ('\0' == error_[0]) ? NULL : error_; }
+};
+
+} /* namespace host */
+} /* namespace seekers */
+
+#endif /* SEEKERS_HOST_CAPTURE_READER_HPP */
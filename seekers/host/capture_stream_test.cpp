@@ -0,0 +1,261 @@
+/**
+ * @file host/capture_stream_test.cpp
+ * @brief 受信時刻付きキャプチャの記録形式(capture_stream)の符号化/復号の確認(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-18
+ * @par history
+ * - 2026-10-18 00:00:50
+ *  - first.
+ *
+ * capture_stream で符号化した記録を capture2pcapng と同じ capture_reader で復号し、
+ * 以下が元の受信データと一致することを確認する. 不一致があれば 1 を返す.
+ *  - TAG_BYTE, TAG_BURST の時刻(32bit の周回, 5byte の varint となる間隔を含む), 塊の時間, データ
+ *  - writer が受け付けなかった記録の後の TAG_SYNC による時刻の復元と TAG_LOST の破棄数
+ *  - 入力側の破棄(capture_stream::lost())の破棄数
+ *  - 塊の最大長(BURST_SIZE)での分割と idle() による塊の出力
+ */
+
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+
+#include "mbed.h"
+#include "capture_reader.hpp"
+#include "../capture_stream.hpp"
+
+using namespace seekers;
+using namespace seekers::host;
+
+namespace{
+
+int errors_ = 0;
+
+void check_(bool ok, const char* name)
+{
+  printf("%s %s\n", ok ? "OK" : "NG", name);
+  if(!ok) ++errors_;
+}
+
+/**
+ * @brief 記録の出力先. rejects の番号(0: ヘッダ)の呼び出しを受け付けない
+ */
+struct sink_t{
+  std::vector<uint8_t> out;
+  std::vector<int> rejects;
+  int calls;
+};
+
+bool sink_writer_(void* context, const uint8_t* src, size_t size)
+{
+  sink_t* sink = (sink_t*)context;
+  const int call = sink->calls++;
+  if(sink->rejects.end() != std::find(sink->rejects.begin(), sink->rejects.end(), call))
+    return false;
+  sink->out.insert(sink->out.end(), src, src + size);
+  return true;
+}
+
+/**
+ * @brief 復号されるパケットの期待値
+ * 記録(writer 呼び出し)の順に与え、受け付けられなかった記録と入力側の破棄を次のパケットの破棄数とする.
+ */
+class expect_t{
+private:
+  const sink_t& sink_;
+  int call_;
+  uint32_t lost_;
+
+public:
+  std::vector<capture_reader::packet_t> packets;
+
+  explicit expect_t(const sink_t& sink) :
+    sink_(sink),
+    call_(1),
+    lost_(0)
+  {}
+
+  void record(uint64_t us, uint32_t span_us, bool burst, const std::vector<uint8_t>& data)
+  {
+    const int call = call_++;
+    if(sink_.rejects.end() != std::find(sink_.rejects.begin(), sink_.rejects.end(), call)){
+      lost_ += (uint32_t)data.size();
+      return;
+    }
+    capture_reader::packet_t p;
+    p.us = us;
+    p.span_us = span_us;
+    p.lost = lost_;
+    p.burst = burst;
+    p.data = data;
+    packets.push_back(p);
+    lost_ = 0;
+  }
+
+  void lost(uint32_t size)
+  {
+    lost_ += size;
+  }
+
+  /**
+   * @brief 時刻を最初のパケットからの時間とする
+   */
+  void rebase(void)
+  {
+    if(packets.empty()) return;
+    const uint64_t base = packets[0].us;
+    for(size_t ii = 0; ii < packets.size(); ++ii)
+      packets[ii].us -= base;
+  }
+};
+
+/**
+ * @brief 記録の復号と期待値の照合
+ */
+void decode_(const char* name, const sink_t& sink, const expect_t& expect,
+             const capture_stream& capturer, capture_stream::mode_t mode)
+{
+  // シェルのモード表示の後に記録が続く
+  static const char banner[] = "=== Capture ===\r\nq) quit.\r\n";
+  FILE* fp = tmpfile();
+  if(NULL == fp){
+    check_(false, "tmpfile");
+    return;
+  }
+  fwrite(banner, 1, sizeof(banner) - 1, fp);
+  fwrite(&sink.out[0], 1, sink.out.size(), fp);
+  rewind(fp);
+
+  char text[128];
+  capture_reader r(fp);
+  capture_reader::header_t header;
+  const bool header_ok = r.header(header);
+  snprintf(text, sizeof(text), "%s: header", name);
+  check_(header_ok && mode == header.mode && 38400 == header.baud && 10 == header.bit_length
+         && 430 == header.gap_us, text);
+
+  std::vector<capture_reader::packet_t> packets;
+  capture_reader::packet_t p;
+  while(r.next(p))
+    packets.push_back(p);
+  fclose(fp);
+
+  snprintf(text, sizeof(text), "%s: decoded to the end (%s)", name, (NULL == r.error()) ? "no error" : r.error());
+  check_(NULL == r.error(), text);
+  snprintf(text, sizeof(text), "%s: packets %u, expected %u, records %u",
+           name, (unsigned)packets.size(), (unsigned)expect.packets.size(), capturer.records());
+  check_(packets.size() == expect.packets.size() && capturer.records() == packets.size(), text);
+
+  size_t mismatch = 0;
+  for(size_t ii = 0; ii < packets.size() && ii < expect.packets.size(); ++ii){
+    const capture_reader::packet_t& a = packets[ii];
+    const capture_reader::packet_t& e = expect.packets[ii];
+    if(a.us != e.us || a.span_us != e.span_us || a.lost != e.lost || a.burst != e.burst || a.data != e.data){
+      if(0 == mismatch++)
+        printf("  packet %u: us %llu/%llu, span %u/%u, lost %u/%u, size %u/%u\n", (unsigned)ii,
+               (unsigned long long)a.us, (unsigned long long)e.us, a.span_us, e.span_us,
+               a.lost, e.lost, (unsigned)a.data.size(), (unsigned)e.data.size());
+    }
+  }
+  snprintf(text, sizeof(text), "%s: timestamps, lost counts, payloads", name);
+  check_(0 == mismatch, text);
+  snprintf(text, sizeof(text), "%s: lost total %u, encoder %u", name, r.lost(), capturer.lost_total());
+  check_(r.lost() == capturer.lost_total() && 0 != r.lost(), text);
+}
+
+/**
+ * @brief 1byte毎の記録
+ */
+void test_byte_(void)
+{
+  // 5byte の varint となる間隔を含む. 開始から約65msで us_ticker が周回する
+  static const uint32_t deltas[] = { 87, 1, 0, 300, 70000, 5000000, 300000000 };
+  const int delta_num = sizeof(deltas) / sizeof(deltas[0]);
+
+  sink_t sink;
+  sink.calls = 0;
+  // 最初の記録, 連続した記録, 入力側の破棄の直後の記録を拒否する(呼び出し番号 = byte番号 + 1)
+  static const int rejects[] = { 1, 5, 6, 50, 152 };
+  sink.rejects.assign(rejects, rejects + sizeof(rejects) / sizeof(rejects[0]));
+
+  capture_stream capturer(sink_writer_, &sink);
+  expect_t expect(sink);
+  capturer.start(capture_stream::MODE_BYTE, 38400, 10, 430);
+
+  uint64_t t = 0xffff0000ull;
+  std::vector<uint8_t> data(1);
+  for(int ii = 0; ii < 200; ++ii){
+    t += deltas[ii % delta_num];
+    data[0] = (uint8_t)(ii * 7 + 1);
+    capturer.put((uint32_t)t, data[0]);
+    expect.record(t, 0, false, data);
+    if(100 == ii){
+      capturer.lost(7);
+      expect.lost(7);
+    }
+    if(150 == ii){
+      capturer.lost(3);
+      expect.lost(3);
+    }
+  }
+  expect.rebase();
+  decode_("byte", sink, expect, capturer, capture_stream::MODE_BYTE);
+}
+
+/**
+ * @brief 無通信時間で区切った塊毎の記録
+ */
+void test_burst_(void)
+{
+  sink_t sink;
+  sink.calls = 0;
+  // 300byte の塊(256 + 44 に分割)の後半と次の塊, 入力側の破棄の前の塊を拒否する
+  static const int rejects[] = { 3, 9, 10, 12 };
+  sink.rejects.assign(rejects, rejects + sizeof(rejects) / sizeof(rejects[0]));
+
+  capture_stream capturer(sink_writer_, &sink);
+  expect_t expect(sink);
+  capturer.start(capture_stream::MODE_BURST, 38400, 10, 430);
+
+  uint64_t t = 0xfff00000ull;
+  std::vector<uint64_t> stamps;
+  std::vector<uint8_t> bytes;
+  for(int jj = 0; jj < 20; ++jj){
+    t += (15 == jj) ? 400000000u : 2000u + jj * 1000u;
+    const int len = (7 == jj) ? 300 : (12 == jj) ? 256 : 5 + jj * 3;
+    stamps.clear();
+    bytes.clear();
+    for(int ii = 0; ii < len; ++ii){
+      if(0 != ii) t += 86 + (ii & 3) * 100;  // 文字間隔は gap_us 以下
+      stamps.push_back(t);
+      bytes.push_back((uint8_t)(jj * 31 + ii));
+      capturer.put((uint32_t)t, bytes.back());
+    }
+    // gap_us 以下の経過では塊を出力しない
+    capturer.idle((uint32_t)(t + 430));
+
+    for(int ii = 0; ii < len; ii += (int)capture_stream::BURST_SIZE){
+      const int end = std::min(len, ii + (int)capture_stream::BURST_SIZE);
+      expect.record(stamps[ii], (uint32_t)(stamps[end - 1] - stamps[ii]), true,
+                    std::vector<uint8_t>(bytes.begin() + ii, bytes.begin() + end));
+    }
+    if(10 == jj){
+      // 入力側の破棄は受信中の塊を出力してから付加する
+      capturer.lost(11);
+      expect.lost(11);
+    }
+  }
+  capturer.idle((uint32_t)(t + 431));
+  expect.rebase();
+  decode_("burst", sink, expect, capturer, capture_stream::MODE_BURST);
+}
+
+} /* namespace */
+
+int main(void)
+{
+  test_byte_();
+  test_burst_();
+
+  printf("capture_stream_test: %s (%d)\n", 0 == errors_ ? "OK" : "NG", errors_);
+  return 0 == errors_ ? 0 : 1;
+}
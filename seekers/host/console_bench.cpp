@@ -0,0 +1,251 @@
+/**
+ * @file host/console_bench.cpp
+ * @brief コンソール出力によるメインループ停止時間のベンチマーク(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:20:14
+ *  - first.
+ * - 2026-10-17 23:59:50
+ *  - console_sink::printf() の出力長(STDBUFSIZE を超える行)の確認を追加.
+ *
+ * main.cpp と同じ構成(event_loop, uart の受信通知, Ticker)のメインループで、周期毎に
+ * pc(RawSerial)へ出力しながら uart(RS485Serial, 受信バッファ256byte)へ途切れなく受信させる.
+ * 出力方法毎に、イベント処理1回の最大時間(event_loop::busy_max_us())と uart の破棄数を求める.
+ *  - pc.printf     : RawSerial へ直接出力(送出完了まで待つ)
+ *  - console block : console_sink(送信バッファ1024byte), POLICY_BLOCK
+ *  - console drop  : console_sink(送信バッファ1024byte), POLICY_DROP
+ * 出力はメニュー表示相当(約260byte), 送信バッファ相当(1024byte), 送信バッファと周期毎の送信可能量を
+ * 超える量(2048byte)の3通り.
+ * 整形等の処理時間は0とみなす.
+ * 計測の前に console_sink::printf() が STDBUFSIZE を超える行を切り捨てないことを確認する(不一致は 1 を返す).
+ *
+ * usage: console_bench [-c pcの通信速度(既定115200)] [-b uartの通信速度(既定38400)] [-t 計測時間[s](既定2)]
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "mbed.h"
+#include "sim_clock.hpp"
+#include "../mbed/rs485serial.hpp"
+#include "../mbed/event_loop.hpp"
+#include "../mbed/console_sink.hpp"
+
+using namespace seekers;
+using namespace seekers::host;
+
+namespace{
+
+enum output_t{
+  OUTPUT_DIRECT,
+  OUTPUT_BLOCK,
+  OUTPUT_DROP,
+  OUTPUT_NUM
+};
+
+const char* output_names_[OUTPUT_NUM] = { "pc.printf", "console block", "console drop" };
+
+enum{
+  EVENT_UART_RX = 0x01,
+  EVENT_TICK    = 0x02
+};
+
+/**
+ * @brief pc の伝送路(送信のみ. 破棄)
+ */
+class null_line : public sim_line{
+public:
+  void tx_begin(mbed::SerialBase*, uint8_t) {}
+  void tx_end(mbed::SerialBase*, uint8_t) {}
+};
+
+/**
+ * @brief pc の伝送路(送信byte数の計数)
+ */
+class count_line : public sim_line{
+public:
+  size_t count;
+  count_line() : count(0) {}
+  void tx_begin(mbed::SerialBase*, uint8_t) { ++count; }
+  void tx_end(mbed::SerialBase*, uint8_t) {}
+};
+
+/**
+ * @brief uart への途切れない受信
+ */
+class byte_source : public sim_event{
+private:
+  mbed::SerialBase& uart_;
+  uint64_t char_ns_;
+  uint8_t value_;
+protected:
+  void fire(void)
+  {
+    uart_.sim_rx(value_++);
+    arm_after(char_ns_);
+  }
+public:
+  byte_source(mbed::SerialBase& uart, uint64_t char_ns) :
+    uart_(uart),
+    char_ns_(char_ns),
+    value_(0)
+  {
+    arm_after(char_ns_);
+  }
+};
+
+struct result_t{
+  uint32_t busy_max_us;
+  uint32_t uart_dropped;
+  uint32_t console_dropped;
+  uint32_t idle_permille;
+};
+
+event_loop* events_ = NULL;
+
+void post_uart_rx_(void)
+{
+  events_->post(EVENT_UART_RX);
+}
+
+void post_tick_(void)
+{
+  events_->post(EVENT_TICK);
+}
+
+/**
+ * @brief 1周期分の出力
+ */
+template <typename T>
+void print_(T& out, size_t size)
+{
+  static const char line[] = "1) Uart Baudrate Setting [ 38400bps]....\r\n";  // 42byte
+  size_t done = 0;
+  while(done < size){
+    out.printf("%s", line);
+    done += sizeof(line) - 1;
+  }
+}
+
+/**
+ * @brief 1回の計測
+ */
+result_t run_(output_t output, size_t size, int console_baud, int baud, double seconds)
+{
+  sim_clock::reset();
+
+  event_loop events;
+  events_ = &events;
+
+  RawSerial pc(USBTX, USBRX);
+  pc.baud(console_baud);
+  null_line line;
+  pc.sim_connect(&line);
+  console_sinkT<1024> console(pc);
+  console.policy((OUTPUT_DROP == output) ? console_sink::POLICY_DROP : console_sink::POLICY_BLOCK);
+
+  RS485SerialT<256, 256> uart(p9, p10, p8);
+  uart.baud(baud);
+  uart.rx_attach(callback(post_uart_rx_));
+  byte_source source(uart, (uint64_t)10 * 1000000000ull / baud);
+
+  Ticker ticker;
+  ticker.attach(callback(post_tick_), 0.1f);
+
+  events.reset_idle();
+  const uint32_t end_us = (uint32_t)(seconds * 1e6);
+  while(us_ticker_read() < end_us){
+    const uint32_t ev = events.wait();
+    if(ev & EVENT_UART_RX){
+      uint8_t buff[64];
+      while(0 != uart.read(buff, sizeof(buff)))
+        ;
+    }
+    if(ev & EVENT_TICK){
+      if(OUTPUT_DIRECT == output)
+        print_(pc, size);
+      else
+        print_(console, size);
+    }
+  }
+
+  result_t result;
+  result.busy_max_us = events.busy_max_us();
+  result.uart_dropped = uart.rx_overrun();
+  result.console_dropped = console.dropped();
+  result.idle_permille = events.idle_permille();
+  ticker.detach();
+  return result;
+}
+
+} /* namespace */
+
+/**
+ * @brief console_sink::printf() の出力長の確認
+ * @return 不一致数
+ */
+int check_printf_(void)
+{
+  static const size_t lengths[] = { 10, 159, 160, 230, 511, 600 };
+  static char text[600 + 1];
+  int errors = 0;
+
+  for(size_t ii = 0; ii < sizeof(lengths) / sizeof(lengths[0]); ++ii){
+    sim_clock::reset();
+    RawSerial pc(USBTX, USBRX);
+    pc.baud(115200);
+    count_line line;
+    pc.sim_connect(&line);
+    console_sinkT<1024> console(pc);
+
+    memset(text, 'x', lengths[ii]);
+    text[lengths[ii]] = '\0';
+    const int n = console.printf("%s", text);
+    console.flush();
+    while(line.count < (size_t)n)
+      sim_clock::step();
+
+    const size_t expect = (lengths[ii] < 511) ? lengths[ii] : 511;
+    if((size_t)n != expect || line.count != expect){
+      printf("NG printf %u chars: returned %d, sent %u (expect %u)\n",
+             (unsigned)lengths[ii], n, (unsigned)line.count, (unsigned)expect);
+      ++errors;
+    }
+  }
+  printf("printf length check: %s (%d)\n", 0 == errors ? "OK" : "NG", errors);
+  return errors;
+}
+
+int main(int argc, char* argv[])
+{
+  int console_baud = 115200;
+  int baud = 38400;
+  double seconds = 2.0;
+  int opt;
+  while(-1 != (opt = getopt(argc, argv, "c:b:t:"))){
+    switch(opt){
+    case 'c': console_baud = atoi(optarg); break;
+    case 'b': baud = atoi(optarg); break;
+    case 't': seconds = atof(optarg); break;
+    default:
+      fprintf(stderr, "usage: %s [-c console baud] [-b uart baud] [-t seconds]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  const int errors = check_printf_();
+
+  static const size_t sizes[] = { 260, 1024, 2048 };
+  printf("console %d bps, uart %d bps, %.1f s, output every 100 ms\n", console_baud, baud, seconds);
+  printf("%-14s %6s %13s %12s %15s %7s\n", "output", "bytes", "stall max[us]", "uart dropped", "console dropped", "idle[%]");
+  for(size_t ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ++ii){
+    for(int output = 0; output < OUTPUT_NUM; ++output){
+      const result_t r = run_((output_t)output, sizes[ii], console_baud, baud, seconds);
+      printf("%-14s %6u %13u %12u %15u %5u.%u\n",
+             output_names_[output], (unsigned)sizes[ii], r.busy_max_us,
+             r.uart_dropped, r.console_dropped, r.idle_permille / 10, r.idle_permille % 10);
+    }
+  }
+  return 0 == errors ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file host/crc_bench.cpp
+ * @brief crc16計算方式(policy)毎の速度と既知解の確認(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:58:10
+ *  - first.
+ *
+ * "123456789" の既知解(0xa001: 0x4b37 [CRC-16/MODBUS], 0x8408: 0x6f91 [CRC-16/MCRF4XX])と、
+ * 乱数列に対して全policyが bitwise と一致することを確認し、policy毎の処理速度(byte/sec)を出力する.
+ * 不一致があれば 1 を返す.
+ *
+ * usage: crc_bench [-n 1回のbyte数(既定256)] [-r 繰り返し回数(既定20000)]
+ *  -n 8 程度(modbus の短い要求)と 256 程度(最大フレーム長)で傾向が変わる.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../utils.hpp"
+
+using namespace seekers;
+
+namespace{
+
+uint64_t host_ns_(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+typedef uint16_t (*calc_t)(const uint8_t*, size_t);
+
+template <int POLY, typename POLICY>
+uint16_t calc_(const uint8_t* data, size_t size)
+{
+  return crc16_calc<POLY, POLICY>(data, size);
+}
+
+struct policy_entry{
+  const char* name;
+  calc_t ibm;
+  calc_t ccitt;
+};
+
+const policy_entry policies_[] = {
+  { "bitwise", calc_<0xa001, crc16_policy_bitwise>, calc_<0x8408, crc16_policy_bitwise> },
+  { "nibble",  calc_<0xa001, crc16_policy_nibble>,  calc_<0x8408, crc16_policy_nibble>  },
+  { "table",   calc_<0xa001, crc16_policy_table>,   calc_<0x8408, crc16_policy_table>   },
+  { "slice4",  calc_<0xa001, crc16_policy_slice4>,  calc_<0x8408, crc16_policy_slice4>  },
+  { "slice8",  calc_<0xa001, crc16_policy_slice8>,  calc_<0x8408, crc16_policy_slice8>  },
+};
+const size_t POLICY_NUM = sizeof(policies_) / sizeof(policies_[0]);
+
+/**
+ * @brief 既知解と bitwise との一致確認
+ * @return 不一致数
+ */
+int verify_(void)
+{
+  static const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  int errors = 0;
+
+  for(size_t ii = 0; ii < POLICY_NUM; ++ii){
+    uint16_t ibm = policies_[ii].ibm(check, sizeof(check));
+    uint16_t ccitt = policies_[ii].ccitt(check, sizeof(check));
+    if(0x4b37 != ibm){
+      printf("NG %-8s 0xa001 \"123456789\" = %04x (expect 4b37)\n", policies_[ii].name, ibm);
+      ++errors;
+    }
+    if(0x6f91 != ccitt){
+      printf("NG %-8s 0x8408 \"123456789\" = %04x (expect 6f91)\n", policies_[ii].name, ccitt);
+      ++errors;
+    }
+  }
+
+  // 長さ 0..67 と先頭のずれ 0..7 の組合せ(slice の端数処理)
+  uint8_t data[80];
+  srand(1);
+  for(size_t ii = 0; ii < sizeof(data); ++ii)
+    data[ii] = (uint8_t)rand();
+  for(size_t ofs = 0; ofs < 8; ++ofs){
+    for(size_t len = 0; len < 68; ++len){
+      uint16_t ibm = crc16_base<0xa001>(data + ofs, len);
+      uint16_t ccitt = crc16_base<0x8408>(data + ofs, len);
+      for(size_t ii = 1; ii < POLICY_NUM; ++ii){
+        if(ibm != policies_[ii].ibm(data + ofs, len) || ccitt != policies_[ii].ccitt(data + ofs, len)){
+          printf("NG %-8s offset %u length %u\n", policies_[ii].name, (unsigned)ofs, (unsigned)len);
+          ++errors;
+        }
+      }
+    }
+  }
+
+  // 正しいフレームの crc 込みの残差は 0
+  uint16_t crc = crc16_ibm(data, 16);
+  data[16] = (uint8_t)(crc & 0xff);
+  data[17] = (uint8_t)(crc >> 8);
+  if(0 != crc16_ibm(data, 18)){
+    printf("NG residue %04x\n", crc16_ibm(data, 18));
+    ++errors;
+  }
+
+  return errors;
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+  size_t size = 256;
+  unsigned repeat = 20000;
+
+  int opt;
+  while(-1 != (opt = getopt(argc, argv, "n:r:"))){
+    switch(opt){
+    case 'n': size = strtoul(optarg, NULL, 0); break;
+    case 'r': repeat = strtoul(optarg, NULL, 0); break;
+    default:
+      fprintf(stderr, "usage: %s [-n size] [-r repeat]\n", argv[0]);
+      return 2;
+    }
+  }
+  if(0 == size || 0 == repeat){
+    fprintf(stderr, "size and repeat must be > 0\n");
+    return 2;
+  }
+
+  int errors = verify_();
+  printf("known answer / cross check : %s (%d)\n", 0 == errors ? "OK" : "NG", errors);
+
+  std::vector<uint8_t> data(size);
+  for(size_t ii = 0; ii < size; ++ii)
+    data[ii] = (uint8_t)rand();
+
+  printf("size %u byte x %u\n", (unsigned)size, repeat);
+  printf("%-8s %14s %10s %14s %10s\n", "policy", "0xa001 B/s", "ratio", "0x8408 B/s", "ratio");
+
+  double base_ibm = 0.0;
+  double base_ccitt = 0.0;
+  volatile uint16_t sink = 0;
+  for(size_t ii = 0; ii < POLICY_NUM; ++ii){
+    double bps[2];
+    for(int poly = 0; poly < 2; ++poly){
+      calc_t calc = (0 == poly) ? policies_[ii].ibm : policies_[ii].ccitt;
+      uint64_t start = host_ns_();
+      for(unsigned jj = 0; jj < repeat; ++jj){
+        data[0] = (uint8_t)jj;
+        sink = sink ^ calc(&data[0], size);
+      }
+      uint64_t elapsed = host_ns_() - start;
+      bps[poly] = (0 == elapsed) ? 0.0 : (double)size * repeat * 1e9 / elapsed;
+    }
+    if(0 == ii){
+      base_ibm = bps[0];
+      base_ccitt = bps[1];
+    }
+    printf("%-8s %14.0f %9.1fx %14.0f %9.1fx\n", policies_[ii].name,
+           bps[0], (0.0 == base_ibm) ? 0.0 : bps[0] / base_ibm,
+           bps[1], (0.0 == base_ccitt) ? 0.0 : bps[1] / base_ccitt);
+  }
+
+  return 0 == errors ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file host/dump_bench.cpp
+ * @brief ダンプモードの最大通信速度のベンチマーク(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 21:40:15
+ *  - first.
+ * - 2026-10-18 00:01:00
+ *  - 出力先を main.cpp と同じ console_sink(送信バッファ1024byte, POLICY_DROP)とし、
+ *    イベント駆動(受信通知, 10ms周期の無通信時間判定)で動作させる. 改行有無の hex lut を比較.
+ *
+ * main.cpp と同じ構成(event_loop, uart の受信通知, 10ms周期の Ticker)で uart(RS485Serial, 受信バッファ256byte)へ
+ * 途切れなく受信させ、ダンプモード毎の処理で console(console_sink, POLICY_DROP)経由で pc(RawSerial)へ出力する.
+ * uart の受信バッファ溢れと console の破棄(受信データのbyte数に換算)の合計を破棄数とし、
+ * 破棄0の最大の通信速度(8N1)を二分探索で求める.
+ *  - bin          : 受信データをそのまま出力
+ *  - hex printf   : 1byte毎に "%02xh " を整形して出力(従来の pc.printf 相当: vsnprintf + 4byte の書き込み)
+ *  - hex lut      : hex_dump(4bit変換表, 改行無し, 16byte毎の書き込み). main.cpp の HEXダンプ
+ *  - hex lut crlf : hex_dump(16byte毎に改行)
+ * hex lut の行の途中までの書き込みは、周期の間に受信が無かった時と、console の送信待ちが無い時のみ行う(main.cpp と同じ).
+ * 整形と書き込みのホスト実時間に -x の倍率を掛けた時間を、処理時間として仮想時間へ加算する.
+ * 出力先(pc)の送信は仮想時間上の通信速度(-c)で律速する.
+ *
+ * usage: dump_bench [-c pcの通信速度(既定115200)] [-n 受信byte数(既定8192)] [-x 処理時間の倍率(既定40)]
+ *  -x は LPC1768(96MHz) と実行ホストの処理速度比の目安. 0 なら処理時間を無視する.
+ */
+
+#include <time.h>
+#include <unistd.h>
+
+#include "mbed.h"
+#include "sim_clock.hpp"
+#include "../mbed/rs485serial.hpp"
+#include "../mbed/event_loop.hpp"
+#include "../mbed/console_sink.hpp"
+#include "../hex_dump.hpp"
+
+using namespace seekers;
+using namespace seekers::host;
+
+namespace{
+
+enum dump_mode_t{
+  MODE_BIN,
+  MODE_HEX_PRINTF,
+  MODE_HEX_LUT,
+  MODE_HEX_LUT_CRLF,
+  MODE_NUM
+};
+
+const char* mode_names_[MODE_NUM] = { "bin", "hex printf", "hex lut", "hex lut crlf" };
+
+enum{
+  EVENT_UART_RX = 0x01,
+  EVENT_TICK    = 0x02
+};
+
+uint64_t host_ns_(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief pc の伝送路(送信のみ. 破棄)
+ */
+class null_line : public sim_line{
+public:
+  void tx_begin(mbed::SerialBase*, uint8_t) {}
+  void tx_end(mbed::SerialBase*, uint8_t) {}
+};
+
+/**
+ * @brief uart への途切れない受信
+ */
+class byte_source : public sim_event{
+private:
+  mbed::SerialBase& uart_;
+  uint64_t char_ns_;
+  uint32_t remain_;
+  uint8_t value_;
+protected:
+  void fire(void)
+  {
+    uart_.sim_rx(value_++);
+    if(0 != --remain_)
+      arm_after(char_ns_);
+  }
+public:
+  byte_source(mbed::SerialBase& uart, uint64_t char_ns, uint32_t size) :
+    uart_(uart),
+    char_ns_(char_ns),
+    remain_(size),
+    value_(0)
+  {
+    arm_after(char_ns_);
+  }
+
+  bool done(void) const { return 0 == remain_; }
+};
+
+event_loop* events_ = NULL;
+
+void post_uart_rx_(void)
+{
+  events_->post(EVENT_UART_RX);
+}
+
+void post_tick_(void)
+{
+  events_->post(EVENT_TICK);
+}
+
+/**
+ * @brief hex_dump の出力先
+ */
+bool console_write_(void* context, const char* src, size_t size)
+{
+  return ((console_sink*)context)->write(src, size);
+}
+
+struct result_t{
+  uint32_t dropped;    // uart の受信バッファ溢れ + console の破棄(受信データのbyte数)
+  uint64_t format_ns;  // 整形, 書き込みのホスト実時間の合計
+  uint32_t bytes;
+};
+
+/**
+ * @brief 1回の計測
+ */
+result_t run_(dump_mode_t mode, int baud, int console_baud, uint32_t size, double scale)
+{
+  sim_clock::reset();
+
+  event_loop events;
+  events_ = &events;
+
+  RawSerial pc(USBTX, USBRX);
+  pc.baud(console_baud);
+  null_line line;
+  pc.sim_connect(&line);
+  console_sinkT<1024> console(pc);
+  console.policy(console_sink::POLICY_DROP);
+
+  RS485SerialT<256, 256> uart(p9, p10, p8);
+  uart.baud(baud);
+  uart.rx_attach(callback(post_uart_rx_));
+  byte_source source(uart, (uint64_t)10 * 1000000000ull / baud, size);
+
+  Ticker ticker;
+  ticker.attach_us(callback(post_tick_), 10000);
+
+  hex_dump dumper(console_write_, &console);
+  dumper.line_break(MODE_HEX_LUT_CRLF == mode);
+  uint32_t idle_bytes = 0;
+
+  result_t result = { 0, 0, 0 };
+  uint8_t buff[64];
+  while(!source.done() || uart.readable()){
+    const uint32_t ev = events.wait();
+    const uint64_t t0 = host_ns_();
+    if(ev & EVENT_UART_RX){
+      size_t n;
+      while(0 != (n = uart.read(buff, sizeof(buff)))){
+        result.bytes += n;
+        switch(mode){
+        case MODE_BIN:
+          console.write(buff, n);
+          break;
+        case MODE_HEX_PRINTF:
+          for(size_t ii = 0; ii < n; ++ii){
+            char text[8];
+            const int len = snprintf(text, sizeof(text), "%02xh ", buff[ii]);
+            console.write(text, len);
+          }
+          break;
+        default:
+          dumper.put(buff, n);
+          break;
+        }
+      }
+      // 出力が途切れる(送信待ち無し)なら行の途中まで書き込む(main.cpp と同じ)
+      if(0 == console.pending())
+        dumper.flush();
+    }
+    if((ev & EVENT_TICK) && (MODE_HEX_LUT == mode || MODE_HEX_LUT_CRLF == mode)){
+      if(dumper.bytes() == idle_bytes)
+        dumper.flush();
+      idle_bytes = dumper.bytes();
+    }
+    const uint64_t ns = host_ns_() - t0;
+    result.format_ns += ns;
+    if(0.0 < scale)
+      sim_clock::advance((uint64_t)(ns * scale));
+  }
+  dumper.end_line();
+  ticker.detach();
+
+  result.dropped = uart.rx_overrun();
+  switch(mode){
+  case MODE_BIN:        result.dropped += console.dropped(); break;
+  case MODE_HEX_PRINTF: result.dropped += console.dropped() / 4; break;
+  default:              result.dropped += dumper.dropped(); break;
+  }
+  return result;
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+  int console_baud = 115200;
+  uint32_t size = 8192;
+  double scale = 40.0;
+  int opt;
+  while(-1 != (opt = getopt(argc, argv, "c:n:x:"))){
+    switch(opt){
+    case 'c': console_baud = atoi(optarg); break;
+    case 'n': size = (uint32_t)atoi(optarg); break;
+    case 'x': scale = atof(optarg); break;
+    default:
+      fprintf(stderr, "usage: %s [-c console baud] [-n bytes] [-x cpu scale]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  printf("console %d bps, %u bytes, cpu scale %.1f\n", console_baud, size, scale);
+  printf("%-12s %9s %10s %12s\n", "mode", "max[bps]", "host[ns/B]", "at 38400[B]");
+  for(int mode = 0; mode < MODE_NUM; ++mode){
+    // 破棄0の最大通信速度(1%刻み)
+    int lo = 300;
+    int hi = 4000000;
+    while(hi - lo > lo / 100){
+      const int mid = lo + (hi - lo) / 2;
+      if(0 == run_((dump_mode_t)mode, mid, console_baud, size, scale).dropped)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    const result_t r = run_((dump_mode_t)mode, lo, console_baud, size, 0.0);
+    const result_t r38400 = run_((dump_mode_t)mode, 38400, console_baud, size, scale);
+    printf("%-12s %9d %10.1f %12u\n",
+           mode_names_[mode],
+           lo,
+           (0 != r.bytes) ? (double)r.format_ns / r.bytes : 0.0,
+           r38400.dropped);
+  }
+  return 0;
+}
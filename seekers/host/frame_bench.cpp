@@ -0,0 +1,210 @@
+/**
+ * @file host/frame_bench.cpp
+ * @brief 受信フレーム組み立て(頭出し・crc判定)のベンチマーク(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:58:40
+ *  - first.
+ *
+ * 雑音(乱数)を前置した FC03 要求フレームの列を -c byte 毎に受信させ、受信1byte当たりの
+ * 処理サイクル数(x86 は rdtsc, それ以外は ns)を出力する.
+ *  - vector : 従来の std::vector + erase(先頭) による頭出し, フレーム毎のcrc全計算
+ *  - frame  : modbus_rtu_frame (先頭位置の移動, 逐次crc)
+ * 雑音中の局番一致(誤頭出し)は未対応の機能コード又はcrc不一致として1byteずつ読み捨てる.
+ * 検出したフレーム数が送信数と一致しなければ 1 を返す.
+ *
+ * usage: frame_bench [-n フレーム数(既定2000)] [-g 前置する雑音byte数(既定64)] [-c 受信単位byte(既定1)]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../modbus_rtu_frame.hpp"
+
+using namespace seekers;
+
+namespace{
+
+const uint8_t ADR = 0x01;
+const size_t FRAME_SIZE = 8;
+
+uint64_t host_ns_(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+uint64_t cycles_(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return host_ns_();
+#endif
+}
+
+/**
+ * @brief フレーム長(crc含む). FC01-06 は 8byte 固定, それ以外は未対応(-1)
+ */
+int frame_length_(const uint8_t* data, size_t size)
+{
+  if(size < 2)
+    return 0;
+  return (1 <= data[1] && data[1] <= 6) ? (int)FRAME_SIZE : -1;
+}
+
+/**
+ * @brief 従来の組み立て
+ */
+class vector_assembler{
+private:
+  std::vector<uint8_t> buff_;
+  size_t frames_;
+public:
+  vector_assembler() : frames_(0) {}
+
+  size_t frames(void) const { return frames_; }
+
+  void recieve(const uint8_t* src, size_t size)
+  {
+    buff_.insert(buff_.end(), src, src + size);
+    for(;;){
+      while(!buff_.empty() && buff_[0] != ADR)
+        buff_.erase(buff_.begin());
+
+      const int length = frame_length_(buff_.empty() ? NULL : &buff_[0], buff_.size());
+      if(length < 0){
+        buff_.erase(buff_.begin());
+        continue;
+      }
+      if(0 == length || buff_.size() < (size_t)length)
+        return;
+      if(0 != crc16_ibm(&buff_[0], length)){
+        buff_.erase(buff_.begin());
+        continue;
+      }
+      ++frames_;
+      buff_.erase(buff_.begin(), buff_.begin() + length);
+    }
+  }
+};
+
+/**
+ * @brief modbus_rtu_frame による組み立て(modbus_rtu_slave::recieve_ と同じ手順)
+ */
+class frame_assembler{
+private:
+  modbus_rtu_frame frame_;
+  size_t frames_;
+public:
+  frame_assembler() : frames_(0) {}
+
+  size_t frames(void) const { return frames_; }
+
+  void recieve(const uint8_t* src, size_t size)
+  {
+    frame_.append(src, size);
+    for(;;){
+      frame_.seek(ADR);
+
+      const int length = frame_length_(frame_.data(), frame_.size());
+      if(length < 0){
+        frame_.consume(1);
+        continue;
+      }
+      if(0 == length || frame_.size() < (size_t)length)
+        return;
+      if(!frame_.crc_check(length)){
+        frame_.consume(1);
+        continue;
+      }
+      ++frames_;
+      frame_.consume(length);
+    }
+  }
+};
+
+template <typename ASSEMBLER>
+void run_(const char* name, const std::vector<uint8_t>& stream, size_t chunk, size_t expect, int& errors)
+{
+  ASSEMBLER assembler;
+  const uint64_t ns = host_ns_();
+  const uint64_t start = cycles_();
+  for(size_t ii = 0; ii < stream.size(); ii += chunk){
+    const size_t n = (chunk < stream.size() - ii) ? chunk : stream.size() - ii;
+    assembler.recieve(&stream[ii], n);
+  }
+  const uint64_t cycles = cycles_() - start;
+  const uint64_t elapsed = host_ns_() - ns;
+
+  printf("%-8s %10.1f %10.1f %8u/%u%s\n", name,
+         (double)cycles / stream.size(), (double)elapsed / stream.size(),
+         (unsigned)assembler.frames(), (unsigned)expect,
+         assembler.frames() == expect ? "" : " NG");
+  if(assembler.frames() != expect)
+    ++errors;
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+  size_t frames = 2000;
+  size_t garbage = 64;
+  size_t chunk = 1;
+
+  int opt;
+  while(-1 != (opt = getopt(argc, argv, "n:g:c:"))){
+    switch(opt){
+    case 'n': frames = strtoul(optarg, NULL, 0); break;
+    case 'g': garbage = strtoul(optarg, NULL, 0); break;
+    case 'c': chunk = strtoul(optarg, NULL, 0); break;
+    default:
+      fprintf(stderr, "usage: %s [-n frames] [-g garbage] [-c chunk]\n", argv[0]);
+      return 2;
+    }
+  }
+  if(0 == chunk){
+    fprintf(stderr, "chunk must be > 0\n");
+    return 2;
+  }
+
+  // 雑音 + FC03 要求. 雑音の末尾は局番と異なる値とし、要求の直前に誤った先頭を作らない
+  std::vector<uint8_t> stream;
+  srand(1);
+  for(size_t ii = 0; ii < frames; ++ii){
+    for(size_t jj = 0; jj < garbage; ++jj)
+      stream.push_back((uint8_t)rand());
+    if(0 < garbage && ADR == stream.back())
+      stream.back() = ADR + 1;
+
+    uint8_t req[FRAME_SIZE] = { ADR, 0x03, 0x00, (uint8_t)ii, 0x00, 0x0a, 0x00, 0x00 };
+    const uint16_t crc = crc16_ibm(req, FRAME_SIZE - 2);
+    req[6] = (uint8_t)(crc & 0xff);
+    req[7] = (uint8_t)(crc >> 8);
+    stream.insert(stream.end(), req, req + FRAME_SIZE);
+  }
+
+#if defined(__x86_64__) || defined(__i386__)
+  const char* unit = "cycle/B";
+#else
+  const char* unit = "ns/B";
+#endif
+  printf("frames %u, garbage %u byte/frame, chunk %u byte, stream %u byte\n",
+         (unsigned)frames, (unsigned)garbage, (unsigned)chunk, (unsigned)stream.size());
+  printf("%-8s %10s %10s %10s\n", "", unit, "ns/B", "frames");
+
+  int errors = 0;
+  run_<vector_assembler>("vector", stream, chunk, frames, errors);
+  run_<frame_assembler>("frame", stream, chunk, frames, errors);
+
+  return 0 == errors ? 0 : 1;
+}
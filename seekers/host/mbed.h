@@ -0,0 +1,769 @@
+/**
+ * @file host/mbed.h
+ * @brief mbed API のホスト側模擬
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 19:48:20
+ *  - First.
+ * - 2026-10-17 23:20:14
+ *  - sleep() を追加.
+ *
+ * ホスト(Linux)でのビルド時に "mbed.h" の代わりに使用する(-D__MBED__ -Iseekers/host).
+ * seekers 配下が使用する範囲(Callback, Timer, Timeout, Ticker, DigitalOut,
+ * SerialBase, RawSerial, Serial, Stream)のみを、仮想時間(sim_clock)上で模擬する.
+ * 割り込みハンドラは sim_clock::step() の中から呼び出される. 処理時間は0とみなす.
+ */
+
+#ifndef SEEKERS_HOST_MBED_H
+#define SEEKERS_HOST_MBED_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "sim_clock.hpp"
+
+#define SEEKERS_HOST_SIM 1
+
+#define __DMB() __sync_synchronize()
+
+inline void core_util_critical_section_enter(void){}
+inline void core_util_critical_section_exit(void){}
+
+inline uint32_t us_ticker_read(void)
+{
+  return seekers::host::sim_clock::now_us();
+}
+
+/**
+ * @brief スリープ(次の事象まで仮想時間を進める)
+ */
+inline void sleep(void)
+{
+  seekers::host::sim_clock::step();
+}
+
+/**
+ * @brief ピン名(LPC1768 相当)
+ */
+typedef enum {
+  p5 = 5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15, p16, p17, p18, p19, p20,
+  p21, p22, p23, p24, p25, p26, p27, p28, p29, p30,
+  LED1 = 0x40, LED2, LED3, LED4,
+  USBTX = 0x80, USBRX,
+  PIN_NUM,
+  NC = -1
+} PinName;
+
+namespace seekers{
+namespace host{
+
+/**
+ * @brief ピンの出力状態(DigitalOut)
+ */
+int& pin_state(PinName pin);
+
+} /* namespace host */
+} /* namespace seekers */
+
+namespace mbed{
+
+/**
+ * @brief 呼び出し可能オブジェクト(関数, オブジェクト+メンバ関数, オブジェクト+関数)
+ * ヒープを使用しない.
+ */
+template <typename F>
+class Callback;
+
+class SerialBase;
+
+namespace detail{
+
+class callback_dummy;
+
+/**
+ * @brief 関数ポインタ/メンバ関数ポインタの格納領域
+ */
+class callback_base{
+protected:
+  void* obj_;
+  union{
+    void (*function)();
+    void (callback_dummy::*method)();
+    char raw[sizeof(void (callback_dummy::*)())];
+  } fn_;
+
+  explicit callback_base(void* obj) :
+    obj_(obj)
+  {
+    memset(&fn_, 0, sizeof(fn_));
+  }
+
+  template <typename F>
+  void store_(const F& f)
+  {
+    typedef char size_check[(sizeof(F) <= sizeof(fn_)) ? 1 : -1];
+    memcpy(fn_.raw, &f, sizeof(F));
+  }
+
+  template <typename F>
+  F load_(void) const
+  {
+    F f;
+    memcpy(&f, fn_.raw, sizeof(F));
+    return f;
+  }
+};
+
+} /* namespace detail */
+
+template <typename R>
+class Callback<R()> : private detail::callback_base{
+private:
+  typedef R (*thunk_t)(const Callback*);
+  thunk_t thunk_;
+
+  static R function_thunk_(const Callback* self)
+  {
+    return self->template load_<R (*)()>()();
+  }
+
+  template <typename T>
+  static R method_thunk_(const Callback* self)
+  {
+    return (((T*)self->obj_)->*(self->template load_<R (T::*)()>()))();
+  }
+
+  template <typename T>
+  static R bound_thunk_(const Callback* self)
+  {
+    return self->template load_<R (*)(T*)>()((T*)self->obj_);
+  }
+
+public:
+  Callback() :
+    callback_base(NULL),
+    thunk_(NULL)
+  {}
+
+  Callback(R (*f)()) :
+    callback_base(NULL),
+    thunk_(f ? &function_thunk_ : NULL)
+  {
+    store_(f);
+  }
+
+  template <typename T>
+  Callback(T* obj, R (T::*m)()) :
+    callback_base(obj),
+    thunk_(&method_thunk_<T>)
+  {
+    store_(m);
+  }
+
+  template <typename T>
+  Callback(T* obj, R (*f)(T*)) :
+    callback_base(obj),
+    thunk_(&bound_thunk_<T>)
+  {
+    store_(f);
+  }
+
+  template <typename T>
+  Callback(R (*f)(T*), T* obj) :
+    callback_base(obj),
+    thunk_(&bound_thunk_<T>)
+  {
+    store_(f);
+  }
+
+  R call(void) const { return thunk_(this); }
+  R operator()(void) const { return thunk_(this); }
+  operator bool() const { return NULL != thunk_; }
+};
+
+template <typename R, typename A0>
+class Callback<R(A0)> : private detail::callback_base{
+private:
+  typedef R (*thunk_t)(const Callback*, A0);
+  thunk_t thunk_;
+
+  static R function_thunk_(const Callback* self, A0 a0)
+  {
+    return self->template load_<R (*)(A0)>()(a0);
+  }
+
+  template <typename T>
+  static R method_thunk_(const Callback* self, A0 a0)
+  {
+    return (((T*)self->obj_)->*(self->template load_<R (T::*)(A0)>()))(a0);
+  }
+
+  template <typename T>
+  static R bound_thunk_(const Callback* self, A0 a0)
+  {
+    return self->template load_<R (*)(T*, A0)>()((T*)self->obj_, a0);
+  }
+
+public:
+  Callback() :
+    callback_base(NULL),
+    thunk_(NULL)
+  {}
+
+  Callback(R (*f)(A0)) :
+    callback_base(NULL),
+    thunk_(f ? &function_thunk_ : NULL)
+  {
+    store_(f);
+  }
+
+  template <typename T>
+  Callback(T* obj, R (T::*m)(A0)) :
+    callback_base(obj),
+    thunk_(&method_thunk_<T>)
+  {
+    store_(m);
+  }
+
+  template <typename T>
+  Callback(T* obj, R (*f)(T*, A0)) :
+    callback_base(obj),
+    thunk_(&bound_thunk_<T>)
+  {
+    store_(f);
+  }
+
+  R call(A0 a0) const { return thunk_(this, a0); }
+  R operator()(A0 a0) const { return thunk_(this, a0); }
+  operator bool() const { return NULL != thunk_; }
+};
+
+template <typename R, typename A0, typename A1>
+class Callback<R(A0, A1)> : private detail::callback_base{
+private:
+  typedef R (*thunk_t)(const Callback*, A0, A1);
+  thunk_t thunk_;
+
+  static R function_thunk_(const Callback* self, A0 a0, A1 a1)
+  {
+    return self->template load_<R (*)(A0, A1)>()(a0, a1);
+  }
+
+  template <typename T>
+  static R method_thunk_(const Callback* self, A0 a0, A1 a1)
+  {
+    return (((T*)self->obj_)->*(self->template load_<R (T::*)(A0, A1)>()))(a0, a1);
+  }
+
+  template <typename T>
+  static R bound_thunk_(const Callback* self, A0 a0, A1 a1)
+  {
+    return self->template load_<R (*)(T*, A0, A1)>()((T*)self->obj_, a0, a1);
+  }
+
+public:
+  Callback() :
+    callback_base(NULL),
+    thunk_(NULL)
+  {}
+
+  Callback(R (*f)(A0, A1)) :
+    callback_base(NULL),
+    thunk_(f ? &function_thunk_ : NULL)
+  {
+    store_(f);
+  }
+
+  template <typename T>
+  Callback(T* obj, R (T::*m)(A0, A1)) :
+    callback_base(obj),
+    thunk_(&method_thunk_<T>)
+  {
+    store_(m);
+  }
+
+  template <typename T>
+  Callback(T* obj, R (*f)(T*, A0, A1)) :
+    callback_base(obj),
+    thunk_(&bound_thunk_<T>)
+  {
+    store_(f);
+  }
+
+  R call(A0 a0, A1 a1) const { return thunk_(this, a0, a1); }
+  R operator()(A0 a0, A1 a1) const { return thunk_(this, a0, a1); }
+  operator bool() const { return NULL != thunk_; }
+};
+
+template <typename R>
+Callback<R()> callback(R (*f)())
+{
+  return Callback<R()>(f);
+}
+
+template <typename T, typename R>
+Callback<R()> callback(T* obj, R (T::*m)())
+{
+  return Callback<R()>(obj, m);
+}
+
+template <typename T, typename R>
+Callback<R()> callback(T* obj, R (*f)(T*))
+{
+  return Callback<R()>(obj, f);
+}
+
+template <typename T, typename R>
+Callback<R()> callback(R (*f)(T*), T* obj)
+{
+  return Callback<R()>(f, obj);
+}
+
+template <typename R, typename A0>
+Callback<R(A0)> callback(R (*f)(A0))
+{
+  return Callback<R(A0)>(f);
+}
+
+template <typename T, typename R, typename A0>
+Callback<R(A0)> callback(T* obj, R (T::*m)(A0))
+{
+  return Callback<R(A0)>(obj, m);
+}
+
+template <typename T, typename R, typename A0>
+Callback<R(A0)> callback(T* obj, R (*f)(T*, A0))
+{
+  return Callback<R(A0)>(obj, f);
+}
+
+template <typename R, typename A0, typename A1>
+Callback<R(A0, A1)> callback(R (*f)(A0, A1))
+{
+  return Callback<R(A0, A1)>(f);
+}
+
+template <typename T, typename R, typename A0, typename A1>
+Callback<R(A0, A1)> callback(T* obj, R (T::*m)(A0, A1))
+{
+  return Callback<R(A0, A1)>(obj, m);
+}
+
+template <typename T, typename R, typename A0, typename A1>
+Callback<R(A0, A1)> callback(T* obj, R (*f)(T*, A0, A1))
+{
+  return Callback<R(A0, A1)>(obj, f);
+}
+
+
+/**
+ * @brief 経過時間計測
+ */
+class Timer{
+private:
+  bool running_;
+  uint64_t start_ns_;
+  uint64_t elapsed_ns_;
+
+public:
+  Timer() :
+    running_(false),
+    start_ns_(0),
+    elapsed_ns_(0)
+  {}
+
+  void start(void)
+  {
+    if(running_) return;
+    start_ns_ = seekers::host::sim_clock::now_ns();
+    running_ = true;
+  }
+
+  void stop(void)
+  {
+    elapsed_ns_ = read_ns_();
+    running_ = false;
+  }
+
+  void reset(void)
+  {
+    start_ns_ = seekers::host::sim_clock::now_ns();
+    elapsed_ns_ = 0;
+  }
+
+  int read_us(void) { return (int)(read_ns_() / 1000); }
+  int read_ms(void) { return (int)(read_ns_() / 1000000); }
+  float read(void) { return read_ns_() / 1e9f; }
+  operator float() { return read(); }
+
+private:
+  uint64_t read_ns_(void) const
+  {
+    return elapsed_ns_ + (running_ ? seekers::host::sim_clock::now_ns() - start_ns_ : 0);
+  }
+};
+
+/**
+ * @brief 周期割り込み
+ */
+class Ticker : private seekers::host::sim_event{
+protected:
+  Callback<void()> handler_;
+  uint64_t period_ns_;
+
+  void fire(void)
+  {
+    if(0 != period_ns_)
+      arm(at_ns() + period_ns_);
+    if(handler_)
+      handler_();
+  }
+
+  void attach_ns_(Callback<void()> func, uint64_t ns, bool periodic)
+  {
+    handler_ = func;
+    period_ns_ = periodic ? (ns ? ns : 1) : 0;
+    arm_after(ns);
+  }
+
+public:
+  Ticker() :
+    period_ns_(0)
+  {}
+
+  virtual ~Ticker(){}
+
+  void attach(Callback<void()> func, float t)
+  {
+    attach_ns_(func, (uint64_t)(t * 1e9f), true);
+  }
+
+  void attach_us(Callback<void()> func, uint32_t t)
+  {
+    attach_ns_(func, (uint64_t)t * 1000, true);
+  }
+
+  void detach(void)
+  {
+    disarm();
+    handler_ = Callback<void()>();
+  }
+};
+
+/**
+ * @brief 1回だけの時限割り込み
+ */
+class Timeout : public Ticker{
+public:
+  void attach(Callback<void()> func, float t)
+  {
+    attach_ns_(func, (uint64_t)(t * 1e9f), false);
+  }
+
+  void attach_us(Callback<void()> func, uint32_t t)
+  {
+    attach_ns_(func, (uint64_t)t * 1000, false);
+  }
+};
+
+/**
+ * @brief デジタル出力
+ */
+class DigitalOut{
+private:
+  PinName pin_;
+
+public:
+  explicit DigitalOut(PinName pin) :
+    pin_(pin)
+  {}
+
+  DigitalOut(PinName pin, int value) :
+    pin_(pin)
+  {
+    write(value);
+  }
+
+  void write(int value)
+  {
+    seekers::host::pin_state(pin_) = value ? 1 : 0;
+  }
+
+  int read(void)
+  {
+    return seekers::host::pin_state(pin_);
+  }
+
+  DigitalOut& operator=(int value)
+  {
+    write(value);
+    return *this;
+  }
+
+  operator int()
+  {
+    return read();
+  }
+};
+
+} /* namespace mbed */
+
+namespace seekers{
+namespace host{
+
+/**
+ * @brief UART の接続先(伝送路)
+ * 送信側 UART が1文字の送出開始/完了時に呼び出す.
+ * 受信側 UART へは SerialBase::sim_rx() で渡す.
+ */
+class sim_line{
+public:
+  virtual ~sim_line(){}
+  virtual void tx_begin(mbed::SerialBase* from, uint8_t c) = 0;
+  virtual void tx_end(mbed::SerialBase* from, uint8_t c) = 0;
+
+  /**
+   * @brief 次の文字の送出開始までに挿入する無通信時間[ns]
+   */
+  virtual uint64_t inter_char_gap_ns(mbed::SerialBase* /*from*/)
+  {
+    return 0;
+  }
+};
+
+} /* namespace host */
+} /* namespace seekers */
+
+namespace mbed{
+
+/**
+ * @brief UART(16byte 受信FIFO, 送信保持レジスタ + 送信シフトレジスタ)
+ * 送信割り込み(TxIrq)は送信保持レジスタが空になった時点、および空の状態で
+ * 有効化した時点で発生する. 受信割り込み(RxIrq)は1文字受信毎に発生する.
+ * 伝送路(sim_line)に接続しない場合、送信は即座に完了して破棄される.
+ */
+class SerialBase{
+public:
+  enum Parity{
+    None = 0,
+    Odd,
+    Even,
+    Forced1,
+    Forced0
+  };
+
+  enum IrqType{
+    RxIrq = 0,
+    TxIrq
+  };
+
+  enum Flow{
+    Disabled = 0,
+    RTS,
+    CTS,
+    RTSCTS
+  };
+
+  static const size_t RX_FIFO_SIZE = 16;
+
+private:
+  class event_t : public seekers::host::sim_event{
+  private:
+    SerialBase* self_;
+    void (SerialBase::*handler_)(void);
+  protected:
+    void fire(void)
+    {
+      (self_->*handler_)();
+    }
+  public:
+    event_t(SerialBase* self, void (SerialBase::*handler)(void)) :
+      self_(self),
+      handler_(handler)
+    {}
+  };
+
+  int baud_;
+  int bits_;
+  Parity parity_;
+  int stop_bits_;
+
+  seekers::host::sim_line* line_;
+  FILE* echo_;
+
+  uint8_t rx_fifo_[RX_FIFO_SIZE];
+  size_t rx_head_;
+  size_t rx_count_;
+  uint32_t rx_overrun_;
+
+  bool shift_busy_;
+  uint8_t shift_;
+  bool thr_full_;
+  uint8_t thr_;
+
+  Callback<void()> rx_irq_;
+  Callback<void()> tx_irq_;
+
+  event_t tx_done_event_;   // 送信シフトレジスタの送出完了
+  event_t tx_start_event_;  // 文字間の無通信時間後の送出開始
+  event_t tx_irq_event_;    // 送信保持レジスタ空
+
+  SerialBase(const SerialBase&);
+  SerialBase& operator=(const SerialBase&);
+
+  void start_char_(uint8_t c);
+  void on_tx_done_(void);
+  void on_tx_start_(void);
+  void on_tx_irq_(void);
+
+protected:
+  SerialBase(PinName tx, PinName rx, int baud);
+  virtual ~SerialBase();
+
+  int _base_getc(void);
+  int _base_putc(int c);
+
+public:
+  void baud(int baudrate);
+  void format(int bits = 8, Parity parity = SerialBase::None, int stop_bits = 1);
+  int readable(void);
+  int writeable(void);
+  void attach(Callback<void()> func, IrqType type = RxIrq);
+  void send_break(void){}
+
+  // ホスト側模擬
+  int sim_baud(void) const { return baud_; }
+  int sim_data_bits(void) const { return bits_; }
+  int sim_bit_length(void) const { return 1 + bits_ + (None != parity_ ? 1 : 0) + stop_bits_; }
+
+  /**
+   * @brief 1文字の送出時間[ns]
+   */
+  uint64_t sim_char_ns(void) const
+  {
+    return (uint64_t)sim_bit_length() * 1000000000ull / baud_;
+  }
+
+  void sim_connect(seekers::host::sim_line* line) { line_ = line; }
+
+  /**
+   * @brief 伝送路に接続しない場合の送信データの出力先(NULLで破棄)
+   */
+  void sim_echo(FILE* fp) { echo_ = fp; }
+
+  /**
+   * @brief 1文字受信(ストップビット受信完了時点)
+   */
+  void sim_rx(uint8_t c);
+
+  uint32_t sim_rx_overrun(void) const { return rx_overrun_; }
+  bool sim_tx_idle(void) const { return !shift_busy_ && !thr_full_; }
+};
+
+/**
+ * @brief 文字ストリーム
+ */
+class Stream{
+private:
+  Stream(const Stream&);
+  Stream& operator=(const Stream&);
+
+protected:
+  virtual int _putc(int c) = 0;
+  virtual int _getc(void) = 0;
+
+public:
+  Stream(const char* /*name*/ = NULL){}
+  virtual ~Stream(){}
+
+  int putc(int c)
+  {
+    return _putc(c);
+  }
+
+  int getc(void)
+  {
+    return _getc();
+  }
+
+  int puts(const char* s);
+  int printf(const char* format, ...);
+};
+
+/**
+ * @brief シリアル(割り込みから使用可能)
+ */
+class RawSerial : public SerialBase{
+public:
+  RawSerial(PinName tx, PinName rx, int baud = 9600) :
+    SerialBase(tx, rx, baud)
+  {}
+
+  int getc(void)
+  {
+    return _base_getc();
+  }
+
+  int putc(int c)
+  {
+    return _base_putc(c);
+  }
+
+  int puts(const char* s);
+  int printf(const char* format, ...);
+};
+
+/**
+ * @brief シリアル(Stream)
+ */
+class Serial : public SerialBase, public Stream{
+protected:
+  int _putc(int c)
+  {
+    return _base_putc(c);
+  }
+
+  int _getc(void)
+  {
+    return _base_getc();
+  }
+
+public:
+  Serial(PinName tx, PinName rx, const char* name = NULL, int baud = 9600) :
+    SerialBase(tx, rx, baud),
+    Stream(name)
+  {}
+
+  using Stream::putc;
+  using Stream::getc;
+};
+
+} /* namespace mbed */
+
+inline void wait_us(int us)
+{
+  seekers::host::sim_clock::advance((uint64_t)us * 1000);
+}
+
+inline void wait_ms(int ms)
+{
+  seekers::host::sim_clock::advance((uint64_t)ms * 1000000);
+}
+
+inline void wait(float s)
+{
+  seekers::host::sim_clock::advance((uint64_t)(s * 1e9f));
+}
+
+using namespace mbed;
+
+#endif /* SEEKERS_HOST_MBED_H */
@@ -0,0 +1,346 @@
+/**
+ * @file host/mbed_sim.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 19:48:20
+ *  - first.
+ */
+
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#include "mbed.h"
+
+namespace seekers{
+namespace host{
+
+namespace{
+
+uint64_t now_ns_ = 0;
+uint64_t arm_seq_ = 0;
+
+/**
+ * @brief 生成済みの事象. 件数は少ないため線形探索とする
+ */
+std::vector<sim_event*>& events_(void)
+{
+  static std::vector<sim_event*> events;
+  return events;
+}
+
+int pins_[PIN_NUM];
+
+} /* namespace */
+
+int& pin_state(PinName pin)
+{
+  static int nc = 0;
+  if(pin < 0 || pin >= PIN_NUM) return nc;
+  return pins_[pin];
+}
+
+sim_event::sim_event() :
+  at_ns_(0),
+  seq_(0),
+  armed_(false)
+{
+  events_().push_back(this);
+}
+
+sim_event::~sim_event()
+{
+  std::vector<sim_event*>& events = events_();
+  events.erase(std::remove(events.begin(), events.end(), this), events.end());
+}
+
+void sim_event::arm(uint64_t at_ns)
+{
+  at_ns_ = (at_ns < now_ns_) ? now_ns_ : at_ns;
+  seq_ = ++arm_seq_;
+  armed_ = true;
+}
+
+void sim_event::arm_after(uint64_t ns)
+{
+  arm(now_ns_ + ns);
+}
+
+uint64_t sim_clock::now_ns(void)
+{
+  return now_ns_;
+}
+
+uint64_t sim_clock::next_ns(void)
+{
+  uint64_t next = NEVER;
+  const std::vector<sim_event*>& events = events_();
+  for(size_t ii = 0; ii < events.size(); ++ii){
+    if(events[ii]->armed_ && events[ii]->at_ns_ < next)
+      next = events[ii]->at_ns_;
+  }
+  return next;
+}
+
+int sim_clock::step(uint64_t max_ns)
+{
+  const uint64_t next = next_ns();
+  const uint64_t limit = (NEVER - now_ns_ < max_ns) ? NEVER : now_ns_ + max_ns;
+  if(next > limit){
+    if(NEVER != limit) now_ns_ = limit;
+    return 0;
+  }
+  now_ns_ = next;
+
+  // 同時刻の事象を arm() 順に発生. 発生中に arm() された同時刻の事象も含める
+  int fired = 0;
+  for(;;){
+    sim_event* ev = NULL;
+    const std::vector<sim_event*>& events = events_();
+    for(size_t ii = 0; ii < events.size(); ++ii){
+      sim_event* e = events[ii];
+      if(e->armed_ && e->at_ns_ <= now_ns_ && (NULL == ev || e->seq_ < ev->seq_))
+        ev = e;
+    }
+    if(NULL == ev) break;
+    ev->armed_ = false;
+    ev->fire();
+    ++fired;
+  }
+  return fired;
+}
+
+void sim_clock::advance(uint64_t ns)
+{
+  const uint64_t end = now_ns_ + ns;
+  while(next_ns() <= end)
+    step(end - now_ns_);
+  now_ns_ = end;
+}
+
+void sim_clock::reset(void)
+{
+  std::vector<sim_event*>& events = events_();
+  for(size_t ii = 0; ii < events.size(); ++ii)
+    events[ii]->armed_ = false;
+  now_ns_ = 0;
+}
+
+double sim_random::exponential(double mean)
+{
+  const double u = (next() + 1.0) / 4294967297.0; // (0, 1)
+  return -mean * log(u);
+}
+
+} /* namespace host */
+} /* namespace seekers */
+
+
+namespace mbed{
+
+/**
+ * @brief コンストラクタ
+ */
+SerialBase::SerialBase(PinName /*tx*/, PinName /*rx*/, int baud) :
+  baud_(baud),
+  bits_(8),
+  parity_(None),
+  stop_bits_(1),
+  line_(NULL),
+  echo_(NULL),
+  rx_head_(0),
+  rx_count_(0),
+  rx_overrun_(0),
+  shift_busy_(false),
+  shift_(0),
+  thr_full_(false),
+  thr_(0),
+  tx_done_event_(this, &SerialBase::on_tx_done_),
+  tx_start_event_(this, &SerialBase::on_tx_start_),
+  tx_irq_event_(this, &SerialBase::on_tx_irq_)
+{}
+
+SerialBase::~SerialBase()
+{}
+
+void SerialBase::baud(int baudrate)
+{
+  baud_ = baudrate;
+}
+
+void SerialBase::format(int bits, Parity parity, int stop_bits)
+{
+  bits_ = bits;
+  parity_ = parity;
+  stop_bits_ = stop_bits;
+}
+
+int SerialBase::readable(void)
+{
+  return (0 != rx_count_) ? 1 : 0;
+}
+
+int SerialBase::writeable(void)
+{
+  return thr_full_ ? 0 : 1;
+}
+
+/**
+ * @brief 割り込みハンドラの設定
+ * 送信保持レジスタが空の状態で TxIrq を有効にすると、直ちに送信割り込みが発生する.
+ */
+void SerialBase::attach(Callback<void()> func, IrqType type)
+{
+  if(RxIrq == type){
+    rx_irq_ = func;
+    return;
+  }
+  tx_irq_ = func;
+  if(tx_irq_ && !thr_full_)
+    tx_irq_event_.arm_after(0);
+  else
+    tx_irq_event_.disarm();
+}
+
+/**
+ * @brief 1文字受信
+ */
+void SerialBase::sim_rx(uint8_t c)
+{
+  if(rx_count_ == RX_FIFO_SIZE){
+    ++rx_overrun_;
+    return;
+  }
+  rx_fifo_[(rx_head_ + rx_count_) % RX_FIFO_SIZE] = c;
+  ++rx_count_;
+  if(rx_irq_)
+    rx_irq_();
+}
+
+/**
+ * @brief 1文字取り出し
+ * 受信FIFOが空なら受信まで仮想時間を進める. 以降に事象が無ければ -1
+ */
+int SerialBase::_base_getc(void)
+{
+  while(0 == rx_count_){
+    if(0 == seekers::host::sim_clock::step())
+      return -1;
+  }
+  const uint8_t c = rx_fifo_[rx_head_];
+  rx_head_ = (rx_head_ + 1) % RX_FIFO_SIZE;
+  --rx_count_;
+  return c;
+}
+
+/**
+ * @brief 1文字送信
+ * 送信保持レジスタが空くまで仮想時間を進める.
+ */
+int SerialBase::_base_putc(int c)
+{
+  if(NULL == line_){
+    if(NULL != echo_) fputc(c, echo_);
+    return c;
+  }
+
+  while(thr_full_){
+    if(0 == seekers::host::sim_clock::step())
+      return -1;
+  }
+  if(!shift_busy_ && !tx_start_event_.armed()){
+    start_char_((uint8_t)c);
+    if(tx_irq_) tx_irq_event_.arm_after(0);
+  }else{
+    thr_ = (uint8_t)c;
+    thr_full_ = true;
+  }
+  return c;
+}
+
+/**
+ * @brief 送信シフトレジスタからの送出開始
+ */
+void SerialBase::start_char_(uint8_t c)
+{
+  shift_busy_ = true;
+  shift_ = c;
+  line_->tx_begin(this, c);
+  tx_done_event_.arm_after(sim_char_ns());
+}
+
+/**
+ * @brief 送出完了. 送信保持レジスタに次の文字があれば送出
+ */
+void SerialBase::on_tx_done_(void)
+{
+  shift_busy_ = false;
+  line_->tx_end(this, shift_);
+  if(!thr_full_) return;
+
+  const uint64_t gap = line_->inter_char_gap_ns(this);
+  if(0 != gap){
+    tx_start_event_.arm_after(gap);
+    return;
+  }
+  on_tx_start_();
+}
+
+void SerialBase::on_tx_start_(void)
+{
+  thr_full_ = false;
+  start_char_(thr_);
+  if(tx_irq_) tx_irq_event_.arm_after(0);
+}
+
+void SerialBase::on_tx_irq_(void)
+{
+  if(tx_irq_ && !thr_full_)
+    tx_irq_();
+}
+
+int Stream::puts(const char* s)
+{
+  int n = 0;
+  for(; '\0' != *s; ++s, ++n)
+    _putc(*s);
+  return n;
+}
+
+int Stream::printf(const char* format, ...)
+{
+  char buff[256];
+  va_list arg;
+  va_start(arg, format);
+  int n = vsnprintf(buff, sizeof(buff), format, arg);
+  va_end(arg);
+  if(n > (int)sizeof(buff) - 1) n = sizeof(buff) - 1;
+  for(int ii = 0; ii < n; ++ii)
+    _putc(buff[ii]);
+  return n;
+}
+
+int RawSerial::puts(const char* s)
+{
+  int n = 0;
+  for(; '\0' != *s; ++s, ++n)
+    putc(*s);
+  return n;
+}
+
+int RawSerial::printf(const char* format, ...)
+{
+  char buff[256];
+  va_list arg;
+  va_start(arg, format);
+  int n = vsnprintf(buff, sizeof(buff), format, arg);
+  va_end(arg);
+  if(n > (int)sizeof(buff) - 1) n = sizeof(buff) - 1;
+  for(int ii = 0; ii < n; ++ii)
+    putc(buff[ii]);
+  return n;
+}
+
+} /* namespace mbed */
@@ -0,0 +1,653 @@
+/**
+ * @file host/modbus_bench.cpp
+ * @brief MODBUS RTU マスター/スレーブ間通信のベンチマーク(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 19:48:20
+ *  - first.
+ * - 2026-10-17 23:58:06
+ *  - マスター/スレーブの記録(trace_log)を有効にし、記録数を出力.
+ * - 2026-10-17 23:59:45
+ *  - 同名だった gap1.0c のシナリオ名に frame/byte を付加.
+ * - 2026-10-17 23:59:58
+ *  - modbus_rtu_planner で集約した読み出しと点毎の読み出しの1巡の時間の比較を追加.
+ * - 2026-10-18 00:00:40
+ *  - バス上の通信を modbus_rtu_analyzer で解析し、マスターの結果と照合する確認を追加.
+ *
+ * 模擬 RS485 バス(rs485_bus_sim)上で RS485Serial 2台をマスター/スレーブとして接続し、
+ * 要求 -> 応答 を繰り返す. シナリオ毎に以下を出力する.
+ *  - frames/s : 仮想時間あたりの完了した要求応答数
+ *  - p50, p99 : 要求の送信開始から応答ハンドラ呼び出しまでの仮想時間[us]
+ *  - cpu      : 1要求応答あたりのプロトコル処理(マスター/スレーブ)のホスト実時間[ns]
+ *               (計測自体のオーバーヘッドを含む)
+ *  - timeout  : 応答待ちタイムアウト数, err : 例外応答/不一致等で完了しなかった数
+ *  - trace    : マスター/スレーブの記録数(trace_log. 整形は cpu に含めない)
+ * 続けて、読み出す点(スレーブ1の保持レジスタ40点(1つおき), 入力レジスタ8点, コイル16点)を
+ * modbus_rtu_planner で集約した場合(planned)と点毎に要求した場合(unplanned)について、
+ * 全点を1巡する仮想時間[us]と modbus_rtu_planner::cycle_us(), unplanned_cycle_us() の見積もりを出力する.
+ * 最後に、バスに受信のみの RS485Serial を接続して modbus_rtu_analyzer へ受信時刻付きで入力し、
+ * 正常応答, 例外応答(範囲外のアドレス), 応答無し(存在しないスレーブ)の要求を繰り返した時の
+ * 要求/応答の対応付け, 例外応答数, 応答無し数をマスターの結果と照合する(雑音有りは集計の整合のみ).
+ * 照合に失敗した場合は終了コード1.
+ *
+ * usage: modbus_bench [要求応答数(既定1000)]
+ */
+
+#include <time.h>
+#include <vector>
+#include <algorithm>
+
+#include "mbed.h"
+#include "rs485_bus_sim.hpp"
+#include "../mbed/rs485serial.hpp"
+#include "../modbus_rtu_master.hpp"
+#include "../modbus_rtu_planner.hpp"
+#include "../modbus_rtu_slave.hpp"
+#include "../modbus_rtu_analyzer.hpp"
+#include "../modbus_register_bank.hpp"
+#include "../trace_log.hpp"
+
+using namespace seekers;
+using namespace seekers::host;
+
+namespace{
+
+/**
+ * @brief デバッグ出力の破棄先
+ */
+class null_stream : public mbed::Stream{
+protected:
+  int _putc(int c) { return c; }
+  int _getc(void) { return -1; }
+};
+
+/**
+ * @brief シナリオ
+ */
+struct scenario_t{
+  const char* name;
+  int baud;
+  int bits;
+  SerialBase::Parity parity;
+  int stop_bits;
+  bool frame_mode;     // スレーブをフレーム受信モード(process_frame)で動作
+  uint8_t cmd;         // 0x01, 0x03, 0x10
+  uint16_t cnt;
+  double bit_error_rate;
+  double noise_per_sec;
+  double gap_probability;
+  uint32_t gap_us;
+};
+
+const scenario_t scenarios_[] = {
+  { "fc03x10 byte",       9600, 8, SerialBase::None, 1, false, 0x03, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x10 frame",      9600, 8, SerialBase::None, 1, true,  0x03, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x10 byte",      19200, 8, SerialBase::None, 1, false, 0x03, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x10 frame",     19200, 8, SerialBase::None, 1, true,  0x03, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x10 byte",      38400, 8, SerialBase::Even, 1, false, 0x03, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x10 frame",     38400, 8, SerialBase::Even, 1, true,  0x03, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x10 byte",     115200, 8, SerialBase::None, 1, false, 0x03, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x10 frame",    115200, 8, SerialBase::None, 1, true,  0x03, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x125 frame",   115200, 8, SerialBase::None, 1, true,  0x03, 125, 0.0, 0.0, 0.0,   0 },
+  { "fc01x64 frame",    115200, 8, SerialBase::None, 1, true,  0x01, 64, 0.0,  0.0, 0.0,   0 },
+  { "fc10x10 frame",    115200, 8, SerialBase::None, 1, true,  0x10, 10, 0.0,  0.0, 0.0,   0 },
+  { "fc03x10 ber1e-4",   19200, 8, SerialBase::None, 1, true,  0x03, 10, 1e-4, 0.0, 0.0,   0 },
+  { "fc03x10 noise",     19200, 8, SerialBase::None, 1, true,  0x03, 10, 0.0, 20.0, 0.0,   0 },
+  { "fc03x10 gap1.0c frame", 19200, 8, SerialBase::None, 1, true,  0x03, 10, 0.0,  0.0, 0.01, 520 },
+  { "fc03x10 gap1.0c byte",  19200, 8, SerialBase::None, 1, false, 0x03, 10, 0.0,  0.0, 0.01, 520 },
+};
+
+/**
+ * @brief 1シナリオの計測値
+ */
+struct bench_t{
+  uint64_t request_ns;          // 送信開始時刻(仮想時間)
+  bool pending;
+  std::vector<uint32_t> latency_us;
+  uint32_t timeouts;
+  uint32_t exceptions;
+};
+
+/**
+ * @brief 記録の整形後の出力先(数のみ数える)
+ */
+bool trace_writer_(void* context, const char*, size_t)
+{
+  ++*(uint32_t*)context;
+  return true;
+}
+
+uint64_t host_ns_(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void complete_(modbus_rtu_master* master)
+{
+  bench_t* bench = (bench_t*)master->context();
+  if(!bench->pending) return;
+  bench->pending = false;
+  bench->latency_us.push_back((uint32_t)((sim_clock::now_ns() - bench->request_ns) / 1000));
+}
+
+void bits_handler_(modbus_rtu_master* master, uint8_t, uint16_t, const modbus_bit_view&)
+{
+  complete_(master);
+}
+
+void registers_handler_(modbus_rtu_master* master, uint8_t, uint16_t, const modbus_register_view&)
+{
+  complete_(master);
+}
+
+void write_handler_(modbus_rtu_master* master, uint8_t, uint8_t, uint16_t, uint16_t)
+{
+  complete_(master);
+}
+
+void exception_handler_(modbus_rtu_master* master, const uint8_t*, size_t)
+{
+  bench_t* bench = (bench_t*)master->context();
+  bench->pending = false;
+  ++bench->exceptions;
+}
+
+void timeout_handler_(modbus_rtu_master* master, uint8_t, uint8_t)
+{
+  bench_t* bench = (bench_t*)master->context();
+  bench->pending = false;
+  ++bench->timeouts;
+}
+
+uint32_t percentile_(std::vector<uint32_t>& v, int p)
+{
+  if(v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  size_t idx = (v.size() * p + 99) / 100;
+  if(idx > 0) --idx;
+  return v[idx];
+}
+
+/**
+ * @brief 1シナリオの実行
+ */
+void run_(const scenario_t& sc, int frames)
+{
+  sim_clock::reset();
+
+  rs485_bus_sim bus;
+  RS485SerialT<256, 256> mu(p9, p10, p8);
+  RS485SerialT<256, 256> su(p13, p14, p12);
+  mu.baud(sc.baud);
+  mu.format(sc.bits, sc.parity, sc.stop_bits);
+  su.baud(sc.baud);
+  su.format(sc.bits, sc.parity, sc.stop_bits);
+  bus.attach(mu, p8);
+  bus.attach(su, p12);
+
+  rs485_bus_sim::config_t config;
+  config.bit_error_rate = sc.bit_error_rate;
+  config.noise_per_sec = sc.noise_per_sec;
+  config.gap_probability = sc.gap_probability;
+  config.gap_us = sc.gap_us;
+  config.seed = 12345;
+  bus.configure(config);
+
+  null_stream debug;
+  modbus_rtu_master master(debug);
+  master.timing(sc.baud, mu.bit_length());
+
+#ifndef NDEBUG
+  RawSerial slave_debug(USBTX, USBRX);
+  modbus_rtu_slave slave(slave_debug, 1);
+#else
+  modbus_rtu_slave slave(1);
+#endif
+  modbus_register_map<256, 256, 2048, 2048> regs;
+  for(size_t ii = 0; ii < regs.holding_size(); ++ii) regs.holding()[ii] = (uint16_t)(ii * 3);
+  slave.bind(&regs);
+  slave.timing(sc.baud, su.bit_length());
+  if(sc.frame_mode)
+    su.frame_attach(&slave);
+
+  trace_logT<256> trace;
+  uint32_t trace_lines = 0;
+  master.settrace(&trace);
+  slave.settrace(&trace);
+
+  bench_t bench;
+  bench.request_ns = 0;
+  bench.pending = false;
+  bench.timeouts = 0;
+  bench.exceptions = 0;
+  bench.latency_us.reserve(frames);
+
+  master.setcontext(&bench);
+  master.sethandler(bits_handler_, modbus_rtu_master::READCOILSTATUS);
+  master.sethandler(registers_handler_, modbus_rtu_master::READHOLDINGREGISTER);
+  master.sethandler(write_handler_, modbus_rtu_master::PRESETMULTIPLEREGISTERS);
+  master.sethandler(exception_handler_, modbus_rtu_master::EXCEPTIONRESPONSE);
+  master.settimeout_handler(timeout_handler_);
+
+  uint16_t values[125];
+  for(int ii = 0; ii < 125; ++ii) values[ii] = (uint16_t)(0x1000 + ii);
+
+  std::vector<uint8_t> req;
+  std::vector<uint8_t> master_tx;
+  frame_buff_t slave_tx;
+  uint8_t buff[256];
+
+  int sent = 0;
+  uint64_t cpu_ns = 0;
+  const uint64_t limit_ns = (uint64_t)frames * 1000000000ull; // 1要求応答あたり1sで打ち切り
+
+  while(sim_clock::now_ns() < limit_ns){
+    const uint64_t t0 = host_ns_();
+
+    // マスター
+    if(!bench.pending && master.ready()){
+      if(sent >= frames) break;
+      req.clear();
+      switch(sc.cmd){
+      case 0x01: master.request_readcoilstatus(req, 1, 0, sc.cnt); break;
+      case 0x10: master.request_presetmultipleregisters(req, 1, 0, sc.cnt, values); break;
+      default:   master.request_readholdingregister(req, 1, 0, sc.cnt); break;
+      }
+      bench.request_ns = sim_clock::now_ns();
+      bench.pending = true;
+      ++sent;
+      mu.write(&req[0], req.size());
+    }
+    size_t n = mu.read(buff, sizeof(buff));
+    if(0 != n)
+      master.recieve(master_tx, buff, n);
+    master.idle(master_tx);
+    if(!master.busy())
+      bench.pending = false;
+
+    // スレーブ
+    if(sc.frame_mode){
+      su.process_frame();
+    }else{
+      slave_tx.clear();
+      n = su.read(buff, sizeof(buff));
+      if(0 != n)
+        slave.recieve(slave_tx, buff, n);
+      slave.idle(slave_tx);
+      if(!slave_tx.empty())
+        su.write(slave_tx.data(), slave_tx.size());
+    }
+
+    cpu_ns += host_ns_() - t0;
+
+    // 記録の整形(低優先の処理に相当)
+    trace.drain(trace_writer_, &trace_lines);
+
+    // 次の事象まで. 応答待ちタイムアウト判定のため最大1ms
+    sim_clock::step(1000000);
+  }
+
+  const uint64_t elapsed_ns = sim_clock::now_ns();
+  const size_t done = bench.latency_us.size();
+  const double fps = (0 != elapsed_ns) ? done * 1e9 / elapsed_ns : 0.0;
+  const uint32_t p50 = percentile_(bench.latency_us, 50);
+  const uint32_t p99 = percentile_(bench.latency_us, 99);
+  const rs485_bus_sim::stats_t& stats = bus.stats();
+
+  printf("%-21s %6d %d%c%d %6d %9.1f %8u %8u %8llu %7u %5u %6u %6u %5u %6u\n",
+         sc.name,
+         sc.baud,
+         sc.bits,
+         (SerialBase::None == sc.parity) ? 'N' : (SerialBase::Even == sc.parity) ? 'E' : 'O',
+         sc.stop_bits,
+         (int)done,
+         fps,
+         p50,
+         p99,
+         (unsigned long long)(done ? cpu_ns / done : 0),
+         bench.timeouts,
+         (unsigned)(sent - done - bench.timeouts),
+         stats.bit_errors + stats.noise_chars,
+         stats.de_errors,
+         su.turnaround_max_us(),
+         trace_lines);
+}
+
+/**
+ * @brief 集約した読み出し(planned)と点毎の読み出し(unplanned)の1巡の時間
+ */
+void run_planner_(int baud, bool planned, int cycles)
+{
+  sim_clock::reset();
+
+  rs485_bus_sim bus;
+  RS485SerialT<256, 256> mu(p9, p10, p8);
+  RS485SerialT<256, 256> su(p13, p14, p12);
+  mu.baud(baud);
+  su.baud(baud);
+  bus.attach(mu, p8);
+  bus.attach(su, p12);
+
+  null_stream debug;
+  modbus_rtu_master master(debug);
+  master.timing(baud, mu.bit_length());
+
+#ifndef NDEBUG
+  RawSerial slave_debug(USBTX, USBRX);
+  modbus_rtu_slave slave(slave_debug, 1);
+#else
+  modbus_rtu_slave slave(1);
+#endif
+  modbus_register_map<256, 256, 2048, 2048> regs;
+  slave.bind(&regs);
+  slave.timing(baud, su.bit_length());
+  su.frame_attach(&slave);
+
+  // 読み出す点
+  struct point_t{ uint8_t cmd; uint16_t reg_adr; };
+  std::vector<point_t> points;
+  for(int ii = 0; ii < 40; ++ii){ point_t pt = { 0x03, (uint16_t)(ii * 2) }; points.push_back(pt); }
+  for(int ii = 0; ii < 8; ++ii){ point_t pt = { 0x04, (uint16_t)(100 + ii) }; points.push_back(pt); }
+  for(int ii = 0; ii < 16; ++ii){ point_t pt = { 0x01, (uint16_t)ii }; points.push_back(pt); }
+
+  modbus_rtu_planner planner(master);
+  planner.gap(1, 0);
+  for(size_t ii = 0; ii < points.size(); ++ii)
+    planner.add(1, points[ii].cmd, points[ii].reg_adr);
+  planner.plan();
+
+  // unplanned: 点毎の要求(マスター自身のハンドラで完了を待つ)
+  bench_t bench;
+  bench.request_ns = 0;
+  bench.pending = false;
+  bench.timeouts = 0;
+  bench.exceptions = 0;
+  master.setcontext(&bench);
+  master.sethandler(bits_handler_, modbus_rtu_master::READCOILSTATUS);
+  master.sethandler(registers_handler_, modbus_rtu_master::READHOLDINGREGISTER);
+  master.sethandler(registers_handler_, modbus_rtu_master::READINPUTREGISTER);
+  master.sethandler(exception_handler_, modbus_rtu_master::EXCEPTIONRESPONSE);
+  master.settimeout_handler(timeout_handler_);
+  size_t next = 0;
+  uint32_t unplanned_cycles = 0;
+
+  std::vector<uint8_t> req;
+  std::vector<uint8_t> master_tx;
+  uint8_t buff[256];
+  uint64_t start_ns = 0;
+  uint64_t end_ns = 0;
+  const uint64_t limit_ns = (uint64_t)(cycles + 1) * 10000000000ull;
+
+  while(sim_clock::now_ns() < limit_ns){
+    size_t n = mu.read(buff, sizeof(buff));
+    if(0 != n)
+      master.recieve(master_tx, buff, n);
+    master.idle(master_tx);
+    if(!master.busy())
+      bench.pending = false;
+
+    req.clear();
+    if(planned){
+      planner.poll(req);
+    }
+    else if(!bench.pending && master.ready()){
+      master.request_read(req, 1, points[next].cmd, points[next].reg_adr, 1);
+      bench.request_ns = sim_clock::now_ns();
+      bench.pending = true;
+      if(++next >= points.size()){
+        next = 0;
+        ++unplanned_cycles;
+      }
+    }
+    if(!req.empty())
+      mu.write(&req[0], req.size());
+
+    // 1巡目の送信完了から cycles 巡
+    const uint32_t done = planned ? planner.cycles() : unplanned_cycles;
+    if(1 == done && 0 == start_ns)
+      start_ns = sim_clock::now_ns();
+    if((uint32_t)cycles + 1 <= done){
+      end_ns = sim_clock::now_ns();
+      break;
+    }
+
+    su.process_frame();
+    sim_clock::step(1000000);
+  }
+
+  const int bit_length = mu.bit_length();
+  printf("%-10s %6d %8d %10llu %12d %7u\n",
+         planned ? "planned" : "unplanned",
+         baud,
+         planned ? planner.requests() : (int)points.size(),
+         (unsigned long long)((end_ns > start_ns) ? (end_ns - start_ns) / 1000 / cycles : 0),
+         planned ? planner.cycle_us(baud, bit_length) : planner.unplanned_cycle_us(baud, bit_length),
+         bench.timeouts);
+}
+
+/**
+ * @brief 解析の確認用の要求
+ */
+struct analyzer_request_t{
+  uint8_t slave;
+  uint8_t cmd;
+  uint16_t reg_adr;
+  uint16_t reg_cnt;
+};
+
+const analyzer_request_t analyzer_requests_[] = {
+  { 1, 0x03,    0, 10 },  // 正常応答
+  { 1, 0x01,    0, 16 },  // 正常応答
+  { 1, 0x03, 4000, 10 },  // 例外応答(範囲外のアドレス)
+  { 9, 0x03,    0, 10 },  // 応答無し(存在しないスレーブ)
+};
+
+/**
+ * @brief 集計表の合計
+ */
+modbus_rtu_analyzer::entry_t analyzer_sum_(const modbus_rtu_analyzer& analyzer)
+{
+  modbus_rtu_analyzer::entry_t sum;
+  memset(&sum, 0, sizeof(sum));
+  for(int ii = 0; ii < analyzer.entry_num(); ++ii){
+    const modbus_rtu_analyzer::entry_t& e = analyzer.entry(ii);
+    sum.requests += e.requests;
+    sum.responses += e.responses;
+    sum.exceptions += e.exceptions;
+    sum.timeouts += e.timeouts;
+  }
+  return sum;
+}
+
+/**
+ * @brief バス上の通信の解析とマスターの結果の照合
+ * @param noisy 雑音を注入する(要求/応答が破損するためマスターとは照合せず、集計の整合のみ確認する)
+ * @return 照合結果
+ */
+bool run_analyzer_(const char* name, int baud, bool noisy, int requests)
+{
+  sim_clock::reset();
+
+  rs485_bus_sim bus;
+  RS485SerialT<256, 256> mu(p9, p10, p8);
+  RS485SerialT<256, 256> su(p13, p14, p12);
+  RS485SerialT<256, 256> au(p28, p27, p26);  // 受信のみ
+  mu.baud(baud);
+  su.baud(baud);
+  au.baud(baud);
+  bus.attach(mu, p8);
+  bus.attach(su, p12);
+  bus.attach(au, p26);
+
+  rs485_bus_sim::config_t config;
+  config.bit_error_rate = noisy ? 1e-4 : 0.0;
+  config.noise_per_sec = noisy ? 20.0 : 0.0;
+  config.gap_probability = 0.0;
+  config.gap_us = 0;
+  config.seed = 12345;
+  bus.configure(config);
+
+  spsc_ring<RS485Serial::rx_stamp_t, 1024> capture;
+  au.capture_attach(&capture);
+  modbus_rtu_analyzer analyzer;
+  analyzer.timing(baud, au.bit_length());
+
+  null_stream debug;
+  modbus_rtu_master master(debug);
+  master.timing(baud, mu.bit_length());
+
+#ifndef NDEBUG
+  RawSerial slave_debug(USBTX, USBRX);
+  modbus_rtu_slave slave(slave_debug, 1);
+#else
+  modbus_rtu_slave slave(1);
+#endif
+  modbus_register_map<256, 256, 2048, 2048> regs;
+  slave.bind(&regs);
+  slave.timing(baud, su.bit_length());
+  su.frame_attach(&slave);
+
+  bench_t bench;
+  bench.request_ns = 0;
+  bench.pending = false;
+  bench.timeouts = 0;
+  bench.exceptions = 0;
+  master.setcontext(&bench);
+  master.sethandler(bits_handler_, modbus_rtu_master::READCOILSTATUS);
+  master.sethandler(registers_handler_, modbus_rtu_master::READHOLDINGREGISTER);
+  master.sethandler(exception_handler_, modbus_rtu_master::EXCEPTIONRESPONSE);
+  master.settimeout_handler(timeout_handler_);
+
+  std::vector<uint8_t> req;
+  std::vector<uint8_t> master_tx;
+  uint8_t buff[256];
+  int sent = 0;
+  const int kinds = sizeof(analyzer_requests_) / sizeof(analyzer_requests_[0]);
+  const uint64_t limit_ns = (uint64_t)requests * 1000000000ull;
+
+  while(sim_clock::now_ns() < limit_ns){
+    if(!bench.pending && master.ready()){
+      if(sent >= requests) break;
+      const analyzer_request_t& r = analyzer_requests_[sent % kinds];
+      req.clear();
+      master.request_read(req, r.slave, r.cmd, r.reg_adr, r.reg_cnt);
+      bench.request_ns = sim_clock::now_ns();
+      bench.pending = true;
+      ++sent;
+      mu.write(&req[0], req.size());
+    }
+    size_t n = mu.read(buff, sizeof(buff));
+    if(0 != n)
+      master.recieve(master_tx, buff, n);
+    master.idle(master_tx);
+    if(!master.busy())
+      bench.pending = false;
+
+    su.process_frame();
+
+    RS485Serial::rx_stamp_t stamp;
+    while(capture.pop(stamp))
+      analyzer.put(stamp.us, stamp.c);
+    analyzer.idle(us_ticker_read());
+
+    sim_clock::step(1000000);
+  }
+  // 最後の要求の応答待ちを確定させる
+  sim_clock::step(1000000000ull);
+  analyzer.idle(us_ticker_read());
+
+  const modbus_rtu_analyzer::entry_t sum = analyzer_sum_(analyzer);
+  const modbus_rtu_analyzer::totals_t& totals = analyzer.totals();
+  const uint32_t responses = (uint32_t)bench.latency_us.size();
+
+  // 要求は全て応答, 例外応答, 応答無しのいずれかに対応付く
+  bool ok = sum.requests == sum.responses + sum.exceptions + sum.timeouts
+    && 0 == totals.orphans && 0 == totals.overflow && 0 != sum.responses;
+  if(!noisy){
+    ok = ok && sum.requests == (uint32_t)sent
+      && sum.responses == responses
+      && sum.exceptions == bench.exceptions
+      && sum.timeouts == bench.timeouts
+      && 0 == totals.crc_errors && 0 == totals.garbage;
+    // 存在しないスレーブへの要求は全て応答無し
+    for(int ii = 0; ii < analyzer.entry_num(); ++ii){
+      const modbus_rtu_analyzer::entry_t& e = analyzer.entry(ii);
+      if(9 == e.slave)
+        ok = ok && e.requests == (uint32_t)(sent / kinds) && e.timeouts == e.requests;
+    }
+  }
+
+  printf("%-10s %6d %6d %6u %6u %6u | %6u %6u %6u %6u %6u %6u %s\n",
+         name, baud, sent, responses, bench.exceptions, bench.timeouts,
+         sum.requests, sum.responses, sum.exceptions, sum.timeouts,
+         totals.crc_errors, totals.orphans, ok ? "OK" : "NG");
+  return ok;
+}
+
+/**
+ * @brief byte数の破損したフレームの後続を取りこぼさないこと
+ * 最大長を超えるフレーム長を示す応答の先頭に続けて(t3.5 未満の間隔で)要求, 応答を入力する.
+ */
+bool check_analyzer_length_(void)
+{
+  static const uint8_t broken[] = { 0x01, 0x03, 0xff, 0x12, 0x34 };
+  uint8_t request[8] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x01 };
+  uint8_t response[7] = { 0x01, 0x03, 0x02, 0x12, 0x34 };
+  const uint16_t request_crc = crc16_ibm(request, 6);
+  request[6] = (uint8_t)request_crc;
+  request[7] = (uint8_t)(request_crc >> 8);
+  const uint16_t response_crc = crc16_ibm(response, 5);
+  response[5] = (uint8_t)response_crc;
+  response[6] = (uint8_t)(response_crc >> 8);
+
+  modbus_rtu_analyzer analyzer;
+  analyzer.timing(115200, 10);
+  uint32_t us = 1000;
+  for(size_t ii = 0; ii < sizeof(broken); ++ii) analyzer.put(us += 100, broken[ii]);
+  for(size_t ii = 0; ii < sizeof(request); ++ii) analyzer.put(us += 100, request[ii]);
+  us += 1000;
+  for(size_t ii = 0; ii < sizeof(response); ++ii) analyzer.put(us += 100, response[ii]);
+
+  const modbus_rtu_analyzer::entry_t sum = analyzer_sum_(analyzer);
+  const bool ok = 1 == sum.requests && 1 == sum.responses && 1 == analyzer.totals().crc_errors;
+  printf("broken byte count: requests %u, responses %u, crc errors %u, garbage %u %s\n",
+         sum.requests, sum.responses, analyzer.totals().crc_errors, analyzer.totals().garbage,
+         ok ? "OK" : "NG");
+  return ok;
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+  int frames = 1000;
+  if(argc > 1) frames = atoi(argv[1]);
+  if(frames < 1) frames = 1;
+
+  printf("%-21s %6s %3s %6s %9s %8s %8s %8s %7s %5s %6s %6s %5s %6s\n",
+         "scenario", "baud", "fmt", "frames", "frames/s", "p50[us]", "p99[us]", "cpu[ns]",
+         "timeout", "err", "noise", "de_err", "ta[us]", "trace");
+  for(size_t ii = 0; ii < sizeof(scenarios_) / sizeof(scenarios_[0]); ++ii)
+    run_(scenarios_[ii], frames);
+
+  printf("\nplanner: slave 1, 40 holding (every other) + 8 input + 16 coils, gap 1 register\n");
+  printf("%-10s %6s %8s %10s %12s %7s\n", "mode", "baud", "requests", "cycle[us]", "estimate[us]", "timeout");
+  static const int bauds[] = { 19200, 115200 };
+  for(size_t ii = 0; ii < sizeof(bauds) / sizeof(bauds[0]); ++ii){
+    run_planner_(bauds[ii], true, 20);
+    run_planner_(bauds[ii], false, 20);
+  }
+
+  printf("\nanalyzer: slave 1 (response, exception), slave 9 (timeout), master | analyzer\n");
+  printf("%-10s %6s %6s %6s %6s %6s | %6s %6s %6s %6s %6s %6s\n", "scenario", "baud", "sent", "resp", "exc", "timeout",
+         "req", "resp", "exc", "timeout", "crc", "orphan");
+  bool ok = run_analyzer_("clean", 19200, false, 200);
+  ok = run_analyzer_("clean", 115200, false, 200) && ok;
+  ok = run_analyzer_("noise", 19200, true, 200) && ok;
+  ok = run_analyzer_("noise", 115200, true, 200) && ok;
+  ok = check_analyzer_length_() && ok;
+  return ok ? 0 : 1;
+}
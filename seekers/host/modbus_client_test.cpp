@@ -0,0 +1,500 @@
+/**
+ * @file host/modbus_client_test.cpp
+ * @brief MODBUS RTU マスターの要求元(プランナー, スケジューラ, 書き込みキャッシュ)とスレーブ振り分けの動作確認(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:59:58
+ *  - first.
+ * - 2026-10-18 00:00:10
+ *  - std::vector 版の仮想関数を再定義したスレーブの確認を追加.
+ * - 2026-10-18 00:00:20
+ *  - プランナーの後の直接の要求, 書き込みキャッシュの容量超過の確認を追加.
+ *
+ * 以下を確認する. 不一致があれば 1 を返す.
+ *  - modbus_rtu_planner の集約: 隙間の許容値, 1要求の上限(0x03, 0x04: 125点, 0x01, 0x02: 2000点),
+ *    スレーブ/機能コード毎の分割
+ *  - 模擬 RS485 バス(rs485_bus_sim)上で、集約した要求の応答が各点へ振り分けられること
+ *  - 1つのマスターを プランナー, スケジューラ, 書き込みキャッシュ で共有し、応答/タイムアウトが
+ *    要求した側へ渡ること
+ *  - modbus_rtu_slave_mux での複数スレーブへの振り分けとブロードキャスト書き込み
+ *  - modbus_rtu_slave の std::vector 版の仮想関数のみ再定義した派生クラスの応答
+ *  - 要求元を指定した要求の後、直接の要求の応答がマスター自身のハンドラへ渡ること
+ *  - 書き込みキャッシュの点が CAPACITY に達した場合の書き込みの拒否
+ */
+
+#include <stdio.h>
+#include <vector>
+
+#include "mbed.h"
+#include "rs485_bus_sim.hpp"
+#include "../mbed/rs485serial.hpp"
+#include "../modbus_rtu_master.hpp"
+#include "../modbus_rtu_slave.hpp"
+#include "../modbus_rtu_slave_mux.hpp"
+#include "../modbus_rtu_planner.hpp"
+#include "../modbus_rtu_scheduler.hpp"
+#include "../modbus_rtu_write_cache.hpp"
+#include "../modbus_register_bank.hpp"
+
+using namespace seekers;
+using namespace seekers::host;
+
+namespace{
+
+int errors_ = 0;
+
+void check_(bool ok, const char* name)
+{
+  printf("%s %s\n", ok ? "OK" : "NG", name);
+  if(!ok) ++errors_;
+}
+
+/**
+ * @brief デバッグ出力の破棄先
+ */
+class null_stream : public mbed::Stream{
+protected:
+  int _putc(int c) { return c; }
+  int _getc(void) { return -1; }
+};
+
+const int BAUD = 115200;
+
+typedef modbus_register_map<256, 256, 4096, 4096> register_map_t;
+
+/**
+ * @brief マスター1台, スレーブ2台(アドレス1, 2. modbus_rtu_slave_mux で振り分け)のバス
+ * run() はマスター側で登録された要求元の poll() を、要求を送信した次の要求元から順に呼び出す(巡回).
+ */
+struct bus_fixture{
+  rs485_bus_sim bus;
+  RS485SerialT<512, 512> mu;
+  RS485SerialT<512, 512> su;
+  null_stream debug;
+  modbus_rtu_master master;
+#ifndef NDEBUG
+  RawSerial slave_debug;
+#endif
+  modbus_rtu_slave slave1;
+  modbus_rtu_slave slave2;
+  register_map_t regs1;
+  register_map_t regs2;
+  modbus_rtu_slave_mux mux;
+
+  modbus_rtu_planner* planner;
+  modbus_rtu_scheduler* scheduler;
+  modbus_rtu_write_cache* cache;
+  int turn_;
+
+  bus_fixture() :
+    mu(p9, p10, p8),
+    su(p13, p14, p12),
+    master(debug),
+#ifndef NDEBUG
+    slave_debug(USBTX, USBRX),
+    slave1(slave_debug, 1),
+    slave2(slave_debug, 2),
+#else
+    slave1(1),
+    slave2(2),
+#endif
+    planner(NULL),
+    scheduler(NULL),
+    cache(NULL),
+    turn_(0)
+  {
+    sim_clock::reset();
+    mu.baud(BAUD);
+    mu.format(8, SerialBase::None, 1);
+    su.baud(BAUD);
+    su.format(8, SerialBase::None, 1);
+    bus.attach(mu, p8);
+    bus.attach(su, p12);
+    master.timing(BAUD, mu.bit_length());
+
+    for(size_t ii = 0; ii < regs1.holding_size(); ++ii){
+      regs1.holding()[ii] = (uint16_t)(1000 + ii);
+      regs2.holding()[ii] = (uint16_t)(2000 + ii);
+      regs1.input()[ii] = (uint16_t)(3000 + ii);
+      regs2.input()[ii] = (uint16_t)(4000 + ii);
+    }
+    for(size_t ii = 0; ii < regs1.coil_size(); ++ii){
+      modbus_register_bank::setbit(regs1.coil(), ii, 0 != (ii % 3));
+      modbus_register_bank::setbit(regs2.discrete(), ii, 0 != (ii % 5));
+    }
+    slave1.bind(&regs1);
+    slave2.bind(&regs2);
+    mux.timing(BAUD, su.bit_length());
+    mux.attach(&slave1);
+    mux.attach(&slave2);
+    su.frame_attach(&mux);
+  }
+
+  /**
+   * @brief 仮想時間で ms だけ動作させる
+   */
+  void run(uint32_t ms)
+  {
+    const uint64_t until = sim_clock::now_ns() + (uint64_t)ms * 1000000ull;
+    std::vector<uint8_t> rx_dummy;
+    std::vector<uint8_t> tx;
+    uint8_t buff[512];
+    while(sim_clock::now_ns() < until){
+      const size_t n = mu.read(buff, sizeof(buff));
+      if(0 != n)
+        master.recieve(rx_dummy, buff, n);
+      master.idle(rx_dummy);
+
+      tx.clear();
+      for(int ii = 0; ii < 3 && tx.empty(); ++ii){
+        const int client = (turn_ + ii) % 3;
+        if(0 == client && NULL != cache) cache->poll(tx);
+        if(1 == client && NULL != scheduler) scheduler->poll(tx);
+        if(2 == client && NULL != planner) planner->poll(tx);
+        if(!tx.empty()){
+          mu.write(&tx[0], tx.size());
+          turn_ = client + 1;
+        }
+      }
+
+      su.process_frame();
+      sim_clock::step(1000000);
+    }
+  }
+};
+
+/**
+ * @brief 集約の上限(要求数のみ. バスは使用しない)
+ */
+void test_plan_limits_(void)
+{
+  printf("-- planner limits\n");
+  null_stream debug;
+  modbus_rtu_master master(debug);
+
+  {
+    modbus_rtu_planner planner(master);
+    planner.add(1, 0x03, 0);
+    planner.add(1, 0x03, 1);
+    planner.add(1, 0x03, 2);
+    planner.add(1, 0x03, 5);  // 3, 4 が隙間
+    planner.gap(0, 0);
+    check_(2 == planner.plan(), "gap 2 registers, tolerance 0: split");
+    planner.gap(1, 0);
+    check_(2 == planner.plan(), "gap 2 registers, tolerance 1: split");
+    planner.gap(2, 0);
+    check_(1 == planner.plan(), "gap 2 registers, tolerance 2: merged");
+    planner.gap(0, 2);
+    check_(2 == planner.plan(), "bit tolerance does not apply to registers");
+  }
+  {
+    modbus_rtu_planner planner(master);
+    planner.gap(200, 0);
+    planner.add(1, 0x03, 100);
+    const int last = planner.add(1, 0x03, 100 + 124);
+    check_(1 == planner.plan(), "0x03 span 125: one request");
+    planner.remove(last);
+    planner.add(1, 0x03, 100 + 125);
+    check_(2 == planner.plan(), "0x03 span 126: two requests");
+  }
+  {
+    modbus_rtu_planner planner(master);
+    for(int ii = 0; ii < 126; ++ii)
+      planner.add(1, 0x04, (uint16_t)ii);
+    check_(2 == planner.plan(), "126 contiguous input registers: 125 + 1");
+  }
+  {
+    modbus_rtu_planner planner(master);
+    planner.gap(0, 3000);
+    planner.add(1, 0x01, 0);
+    const int last = planner.add(1, 0x01, 1999);
+    check_(1 == planner.plan(), "0x01 span 2000: one request");
+    planner.remove(last);
+    planner.add(1, 0x01, 2000);
+    check_(2 == planner.plan(), "0x01 span 2001: two requests");
+    planner.gap(0, 1997);
+    planner.add(1, 0x01, 1000);
+    check_(2 == planner.plan(), "0x01 gap 999 within tolerance 1997, then span limit");
+  }
+  {
+    modbus_rtu_planner planner(master);
+    planner.gap(100, 100);
+    planner.add(1, 0x03, 0);
+    planner.add(2, 0x03, 1);
+    planner.add(1, 0x04, 2);
+    planner.add(1, 0x03, 3);
+    check_(3 == planner.plan(), "split by slave and function code");
+  }
+}
+
+/**
+ * @brief 集約した要求の応答の振り分け
+ */
+void test_plan_bus_(void)
+{
+  printf("-- planner on rs485_bus_sim\n");
+  bus_fixture fx;
+  modbus_rtu_planner planner(fx.master);
+  fx.planner = &planner;
+
+  planner.gap(123, 2000);
+  const int h0 = planner.add(1, 0x03, 0);
+  const int h2 = planner.add(1, 0x03, 2);
+  const int h5 = planner.add(1, 0x03, 5);
+  const int i0 = planner.add(2, 0x04, 10);
+  const int i1 = planner.add(2, 0x04, 10 + 124);
+  const int c0 = planner.add(1, 0x01, 1);
+  const int c1 = planner.add(1, 0x01, 1 + 1999);
+  const int d0 = planner.add(2, 0x02, 7);
+  check_(4 == planner.plan(), "4 requests");
+
+  fx.run(500);
+  check_(planner.cycles() >= 2, "cycles");
+  check_(planner.valid(h0) && 1000 == planner.value(h0)
+         && planner.valid(h2) && 1002 == planner.value(h2)
+         && planner.valid(h5) && 1005 == planner.value(h5), "holding registers with gaps");
+  check_(planner.valid(i0) && 4010 == planner.value(i0)
+         && planner.valid(i1) && 4134 == planner.value(i1), "input registers, 125 in one request");
+  check_(planner.valid(c0) && 1 == planner.value(c0)
+         && planner.valid(c1) && 1 == planner.value(c1), "coils, 2000 in one request");
+  check_(planner.valid(d0) && 1 == planner.value(d0), "discrete input on slave 2");
+}
+
+/**
+ * @brief スケジューラの応答ハンドラ
+ */
+int poll_count_[2];
+int poll_lost_;
+
+void poll_handler_(modbus_rtu_scheduler*, int id, const uint8_t* frame, size_t)
+{
+  if(NULL == frame)
+    ++poll_lost_;
+  else if(0 <= id && id < 2)
+    ++poll_count_[id];
+}
+
+/**
+ * @brief 1つのマスターの共有(プランナー, スケジューラ, 書き込みキャッシュ)
+ */
+void test_shared_(void)
+{
+  printf("-- planner + scheduler + write cache on one master\n");
+  bus_fixture fx;
+  modbus_rtu_planner planner(fx.master);
+  modbus_rtu_scheduler scheduler(fx.master);
+  modbus_rtu_write_cache cache(fx.master);
+  fx.planner = &planner;
+  fx.scheduler = &scheduler;
+  fx.cache = &cache;
+
+  poll_count_[0] = poll_count_[1] = 0;
+  poll_lost_ = 0;
+  check_(0 == scheduler.add(2, 0x03, 0, 4, 50, 0, poll_handler_), "scheduler add");
+  check_(1 == scheduler.add(7, 0x03, 0, 4, 1000, 1, poll_handler_), "scheduler add (no such slave)");
+
+  const int r10 = planner.add(1, 0x03, 10);
+  const int r11 = planner.add(1, 0x03, 11);
+  const int r12 = planner.add(1, 0x03, 12);
+  const int ghost = planner.add(9, 0x03, 0);  // 応答無し(タイムアウト)
+
+  cache.write_register(1, 10, 0xa010);
+  cache.write_register(1, 11, 0xa011);
+  cache.write_register(1, 12, 0xa012);
+  cache.write_coil(2, 5, true);
+
+  fx.run(3000);
+
+  check_(!cache.dirty() && 0 == cache.errors() && 2 == cache.writes(), "write cache: 0x10 x3 + 0x05, no errors");
+  check_(0xa010 == fx.regs1.holding()[10] && 0xa012 == fx.regs1.holding()[12]
+         && modbus_register_bank::getbit(fx.regs2.coil(), 5), "written to the slaves");
+  check_(planner.valid(r10) && 0xa010 == planner.value(r10)
+         && planner.valid(r11) && 0xa011 == planner.value(r11)
+         && planner.valid(r12) && 0xa012 == planner.value(r12), "planner reads the written values");
+  check_(!planner.valid(ghost), "planner: timeout goes to the planner");
+  check_(poll_count_[0] >= 5, "scheduler: responses from slave 2");
+  check_(0 == poll_count_[1] && poll_lost_ >= 1, "scheduler: timeout goes to the scheduler");
+
+  cache.write_register(1, 10, 0xa010);
+  check_(!cache.dirty() && 1 == cache.suppressed(), "write cache: same value suppressed");
+}
+
+/**
+ * @brief スレーブ振り分けとブロードキャスト
+ */
+void test_mux_(void)
+{
+  printf("-- slave mux\n");
+  bus_fixture fx;
+  modbus_rtu_write_cache cache(fx.master);
+  modbus_rtu_planner planner(fx.master);
+  fx.cache = &cache;
+  fx.planner = &planner;
+
+  const int a = planner.add(1, 0x03, 20);
+  const int b = planner.add(2, 0x03, 20);
+  cache.write_register(0, 20, 0x5555);
+
+  fx.run(300);
+  check_(1 == fx.mux.broadcasts(), "broadcast processed once");
+  check_(0x5555 == fx.regs1.holding()[20] && 0x5555 == fx.regs2.holding()[20], "broadcast written to both slaves");
+  check_(planner.valid(a) && 0x5555 == planner.value(a)
+         && planner.valid(b) && 0x5555 == planner.value(b), "each slave answers its own address");
+
+  fx.mux.detach(2);
+  fx.run(1500);
+  check_(planner.valid(a) && !planner.valid(b), "detached slave does not answer");
+}
+
+/**
+ * @brief マスター自身のハンドラ(直接の要求)
+ */
+struct direct_log{
+  int calls;
+  uint8_t slave;
+  uint16_t value;
+};
+
+void direct_handler_(modbus_rtu_master* master, uint8_t slave, uint16_t, const modbus_register_view& regs)
+{
+  direct_log* log = (direct_log*)master->context();
+  ++log->calls;
+  log->slave = slave;
+  log->value = regs[0];
+}
+
+/**
+ * @brief プランナーの要求の後の直接の要求
+ */
+void test_direct_after_client_(void)
+{
+  printf("-- direct request after a planner request\n");
+  bus_fixture fx;
+  modbus_rtu_planner planner(fx.master);
+  fx.planner = &planner;
+  const int pt = planner.add(1, 0x03, 10);
+
+  direct_log log = { 0, 0, 0 };
+  fx.master.setcontext(&log);
+  fx.master.sethandler(direct_handler_, modbus_rtu_master::READHOLDINGREGISTER);
+
+  fx.run(50);
+  check_(planner.cycles() >= 1 && planner.valid(pt) && 1010 == planner.value(pt), "planner read");
+
+  fx.planner = NULL;
+  fx.run(20);
+  check_(fx.master.ready(), "master idle");
+  std::vector<uint8_t> req;
+  fx.master.request_readholdingregister(req, 2, 30, 1);
+  fx.mu.write(&req[0], req.size());
+  fx.run(50);
+  check_(1 == log.calls && 2 == log.slave && 2030 == log.value, "direct response goes to the master's own handler");
+  check_(1010 == planner.value(pt), "planner not called for the direct response");
+
+  // 生成に失敗した要求でも指定は解除される
+  direct_log other_log = { 0, 0, 0 };
+  modbus_rtu_master::client other;
+  other.setcontext(&other_log);
+  other.sethandler(direct_handler_, modbus_rtu_master::READHOLDINGREGISTER);
+  fx.master.setclient(&other);
+  std::vector<uint8_t> bad;
+  const uint8_t pdu[1] = { 0x2b };
+  check_(!fx.master.request_pdu(bad, 1, pdu, sizeof(pdu)), "request_pdu() rejects an unknown PDU");
+  req.clear();
+  fx.master.request_readholdingregister(req, 2, 31, 1);
+  fx.mu.write(&req[0], req.size());
+  fx.run(50);
+  check_(2 == log.calls && 2031 == log.value && 0 == other_log.calls, "rejected request clears setclient()");
+}
+
+/**
+ * @brief 書き込みキャッシュの容量超過
+ */
+void test_cache_full_(void)
+{
+  printf("-- write cache full\n");
+  null_stream debug;
+  modbus_rtu_master master(debug);
+  modbus_rtu_write_cache cache(master);
+
+  bool ok = true;
+  for(int ii = 0; ii < modbus_rtu_write_cache::CAPACITY; ++ii)
+    ok = cache.write_register(1, (uint16_t)(ii * 2), (uint16_t)ii) && ok;
+  check_(ok && 0 == cache.rejected(), "CAPACITY points accepted");
+  check_(!cache.write_register(1, 1, 0x1234) && !cache.write_coil(2, 0, true) && 2 == cache.rejected(),
+         "new points rejected and counted when full");
+  check_(cache.write_register(1, 10, 0x4321) && 2 == cache.rejected(), "existing point still accepted");
+}
+
+/**
+ * @brief std::vector 版の仮想関数のみ再定義したスレーブ(既存の派生クラス)
+ */
+class legacy_slave : public modbus_rtu_slave{
+public:
+  int calls;
+
+#ifndef NDEBUG
+  legacy_slave(RawSerial& debug) : modbus_rtu_slave(debug, 1), calls(0) {}
+#else
+  legacy_slave() : modbus_rtu_slave(1), calls(0) {}
+#endif
+
+protected:
+  void readholdingregister(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt)
+  {
+    ++calls;
+    const size_t pos = dst.size();
+    dst.push_back(address());
+    dst.push_back(0x03);
+    dst.push_back((uint8_t)(reg_cnt * 2));
+    for(uint16_t ii = 0; ii < reg_cnt; ++ii){
+      dst.push_back(0x12);
+      dst.push_back((uint8_t)(start_adr + ii));
+    }
+    modbus::append_crc(dst, pos);
+  }
+};
+
+void test_legacy_slave_(void)
+{
+  printf("-- slave with std::vector overrides\n");
+#ifndef NDEBUG
+  RawSerial debug(USBTX, USBRX);
+  legacy_slave slave(debug);
+#else
+  legacy_slave slave;
+#endif
+  std::vector<uint8_t> req;
+  modbus::request_read(req, 1, 0x03, 0x20, 2);
+  frame_buff_t tx;
+  slave.recieve_frame(tx, &req[0], req.size());
+
+  const uint8_t head[7] = { 0x01, 0x03, 0x04, 0x12, 0x20, 0x12, 0x21 };
+  std::vector<uint8_t> expect(head, head + 7);
+  modbus::append_crc(expect, 0);
+  check_(1 == slave.calls && std::vector<uint8_t>(tx.begin(), tx.end()) == expect,
+         "frame_buff_t path calls the std::vector override");
+
+  std::vector<uint8_t> req2;
+  modbus::request_read(req2, 1, 0x04, 0x20, 2);
+  tx.clear();
+  slave.recieve_frame(tx, &req2[0], req2.size());
+  check_(5 == tx.size() && 0x84 == tx[1] && 0x01 == tx[2], "not overridden: exception response (0x84, 0x01)");
+}
+
+} /* namespace */
+
+int main(void)
+{
+  test_plan_limits_();
+  test_plan_bus_();
+  test_shared_();
+  test_mux_();
+  test_legacy_slave_();
+  test_direct_after_client_();
+  test_cache_full_();
+
+  printf("modbus_client_test: %s (%d)\n", 0 == errors_ ? "OK" : "NG", errors_);
+  return 0 == errors_ ? 0 : 1;
+}
@@ -0,0 +1,446 @@
+/**
+ * @file host/modbus_tcp_gateway_host.cpp
+ * @brief MODBUS TCP / RTU over TCP ゲートウェイ(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 20:32:07
+ *  - first.
+ * - 2026-10-17 23:58:06
+ *  - マスター/スレーブの記録(trace_log)の標準エラーへの出力(-t)を追加.
+ *
+ * localhost の TCP ポートで要求を受け付け、modbus_tcp_gateway で
+ *  - ユニット1 : 自局のスレーブ(modbus_rtu_slave)
+ *  - ユニット2, 3 : 模擬 RS485 バス(rs485_bus_sim)上のスレーブ(マスター経由)
+ * へ振り分ける. 模擬バスの仮想時間は実時間に合わせて進める.
+ *
+ * usage: modbus_tcp_gateway [-p MBAPポート(既定1502)] [-r RTUポート(既定1503)] [-b 通信速度(既定115200)]
+ *                           [-c クライアント数 -n 要求数 -d 同時要求数] [-t]
+ *  -c を指定すると同じプロセス内のクライアントから MBAP で要求(0x03, 10レジスタ)を
+ *  ユニット1-3へ順に送信し、完了後に要求数/s, 例外数等を出力して終了する.
+ *  この場合、仮想時間は実時間に合わせず次の事象まで進める.
+ *  -t を指定するとマスター/スレーブの記録(trace_log)を整形して標準エラーへ出力する.
+ */
+
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <vector>
+
+#include "mbed.h"
+#include "rs485_bus_sim.hpp"
+#include "../mbed/rs485serial.hpp"
+#include "../modbus_rtu_master.hpp"
+#include "../modbus_rtu_slave.hpp"
+#include "../modbus_register_bank.hpp"
+#include "../modbus_tcp_gateway.hpp"
+#include "../trace_log.hpp"
+
+using namespace seekers;
+using namespace seekers::host;
+
+namespace{
+
+/**
+ * @brief デバッグ出力の破棄先
+ */
+class null_stream : public mbed::Stream{
+protected:
+  int _putc(int c) { return c; }
+  int _getc(void) { return -1; }
+};
+
+uint64_t host_ns_(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void nonblock_(int fd)
+{
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  const int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+int listen_(int port)
+{
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if(fd < 0) return -1;
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if(0 != bind(fd, (struct sockaddr*)&addr, sizeof(addr)) || 0 != listen(fd, 8)){
+    close(fd);
+    return -1;
+  }
+  nonblock_(fd);
+  return fd;
+}
+
+/**
+ * @brief ゲートウェイ側の接続(ソケット)
+ */
+class socket_sink : public modbus_tcp_gateway::sink{
+public:
+  struct connection_t{
+    int fd;
+    std::vector<uint8_t> out;  // 未送信の応答
+  };
+  connection_t connections[modbus_tcp_gateway::CONNECTION_NUM];
+
+  socket_sink()
+  {
+    for(int ii = 0; ii < modbus_tcp_gateway::CONNECTION_NUM; ++ii)
+      connections[ii].fd = -1;
+  }
+
+  void send(int conn, const uint8_t* src, size_t size)
+  {
+    connections[conn].out.insert(connections[conn].out.end(), src, src + size);
+    flush(conn);
+  }
+
+  bool flush(int conn)
+  {
+    connection_t& c = connections[conn];
+    while(!c.out.empty()){
+      const ssize_t n = ::send(c.fd, &c.out[0], c.out.size(), MSG_NOSIGNAL);
+      if(n < 0) return (EAGAIN == errno || EWOULDBLOCK == errno);
+      c.out.erase(c.out.begin(), c.out.begin() + n);
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief 同じプロセス内のクライアント(MBAP)
+ * 同時に depth 個の要求を送信し、応答のトランザクションID, ユニットID, 長さを検証する.
+ */
+struct client_t{
+  int fd;
+  uint16_t tid;
+  int sent;
+  int pending;
+  uint8_t pending_unit[65536 / 256];  // tid の下位8bit -> ユニットID(0: 応答済み)
+  std::vector<uint8_t> in;
+};
+
+struct client_stats_t{
+  uint32_t done;
+  uint32_t exceptions;
+  uint32_t errors;
+};
+
+void client_send_(client_t& c, int requests)
+{
+  if(c.sent >= requests) return;
+  const uint8_t unit = (uint8_t)(1 + c.sent % 3);
+  const uint16_t tid = c.tid++;
+  const uint8_t adu[12] = {
+    (uint8_t)(tid >> 8), (uint8_t)tid, 0x00, 0x00, 0x00, 0x06,
+    unit, 0x03, 0x00, 0x00, 0x00, 0x0a
+  };
+  c.pending_unit[tid & 0xff] = unit;
+  ++c.sent;
+  ++c.pending;
+  if(sizeof(adu) != ::send(c.fd, adu, sizeof(adu), MSG_NOSIGNAL))
+    perror("client send");
+}
+
+void client_recieve_(client_t& c, client_stats_t& stats, int requests)
+{
+  uint8_t buff[1024];
+  ssize_t n;
+  while(0 < (n = recv(c.fd, buff, sizeof(buff), 0)))
+    c.in.insert(c.in.end(), buff, buff + n);
+
+  while(c.in.size() >= 7){
+    const size_t length = (c.in[4] << 8) | c.in[5];
+    if(c.in.size() < 6 + length) break;
+    const uint16_t tid = (c.in[0] << 8) | c.in[1];
+    const uint8_t unit = c.in[6];
+    const uint8_t cmd = c.in[7];
+    if(unit != c.pending_unit[tid & 0xff]){
+      ++stats.errors;
+    }else if(0x80 & cmd){
+      ++stats.exceptions;
+    }else if(0x03 != cmd || 2 + 1 + 20 != length){
+      ++stats.errors;
+    }else{
+      ++stats.done;
+    }
+    c.pending_unit[tid & 0xff] = 0;
+    --c.pending;
+    c.in.erase(c.in.begin(), c.in.begin() + 6 + length);
+    client_send_(c, requests);
+  }
+}
+
+int client_connect_(int port)
+{
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if(0 != connect(fd, (struct sockaddr*)&addr, sizeof(addr))){
+    perror("client connect");
+    close(fd);
+    return -1;
+  }
+  nonblock_(fd);
+  return fd;
+}
+
+/**
+ * @brief 記録の整形後の出力先
+ */
+bool trace_writer_(void*, const char* src, size_t size)
+{
+  fwrite(src, 1, size, stderr);
+  return true;
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+  int mbap_port = 1502;
+  int rtu_port = 1503;
+  int baud = 115200;
+  int client_num = 0;
+  int requests = 1000;
+  int depth = 4;
+  bool trace_enabled = false;
+  int opt;
+  while(-1 != (opt = getopt(argc, argv, "p:r:b:c:n:d:t"))){
+    switch(opt){
+    case 'p': mbap_port = atoi(optarg); break;
+    case 'r': rtu_port = atoi(optarg); break;
+    case 'b': baud = atoi(optarg); break;
+    case 'c': client_num = atoi(optarg); break;
+    case 'n': requests = atoi(optarg); break;
+    case 'd': depth = atoi(optarg); break;
+    case 't': trace_enabled = true; break;
+    default:
+      fprintf(stderr, "usage: %s [-p port] [-r port] [-b baud] [-c clients -n requests -d depth] [-t]\n", argv[0]);
+      return 1;
+    }
+  }
+  if(client_num > modbus_tcp_gateway::CONNECTION_NUM) client_num = modbus_tcp_gateway::CONNECTION_NUM;
+  if(depth < 1) depth = 1;
+  if(depth > 255) depth = 255;
+
+  // 模擬 RS485 バス: マスター, ユニット2, ユニット3
+  rs485_bus_sim bus;
+  RS485SerialT<256, 256> mu(p9, p10, p8);
+  RS485SerialT<256, 256> su2(p13, p14, p12);
+  RS485SerialT<256, 256> su3(p17, p18, p16);
+  mu.baud(baud);
+  su2.baud(baud);
+  su3.baud(baud);
+  bus.attach(mu, p8);
+  bus.attach(su2, p12);
+  bus.attach(su3, p16);
+
+  null_stream debug;
+  modbus_rtu_master master(debug);
+  master.timing(baud, mu.bit_length());
+
+#ifndef NDEBUG
+  RawSerial slave_debug(USBTX, USBRX);
+  modbus_rtu_slave local(slave_debug, 1);
+  modbus_rtu_slave slave2(slave_debug, 2);
+  modbus_rtu_slave slave3(slave_debug, 3);
+#else
+  modbus_rtu_slave local(1);
+  modbus_rtu_slave slave2(2);
+  modbus_rtu_slave slave3(3);
+#endif
+  modbus_register_map<256, 256, 256, 256> regs1, regs2, regs3;
+  for(size_t ii = 0; ii < regs1.holding_size(); ++ii){
+    regs1.holding()[ii] = (uint16_t)(0x1000 + ii);
+    regs2.holding()[ii] = (uint16_t)(0x2000 + ii);
+    regs3.holding()[ii] = (uint16_t)(0x3000 + ii);
+  }
+  local.bind(&regs1);
+  slave2.bind(&regs2);
+  slave3.bind(&regs3);
+  slave2.timing(baud, su2.bit_length());
+  slave3.timing(baud, su3.bit_length());
+  su2.frame_attach(&slave2);
+  su3.frame_attach(&slave3);
+
+  trace_logT<256> trace;
+  if(trace_enabled){
+    master.settrace(&trace);
+    local.settrace(&trace);
+    slave2.settrace(&trace);
+    slave3.settrace(&trace);
+  }
+
+  socket_sink sink;
+  modbus_tcp_gateway gateway(master, sink);
+  gateway.attach(&local);
+  gateway.route(2);
+  gateway.route(3);
+
+  const int mbap_fd = listen_(mbap_port);
+  const int rtu_fd = listen_(rtu_port);
+  if(mbap_fd < 0 || rtu_fd < 0){
+    perror("listen");
+    return 1;
+  }
+  printf("listening 127.0.0.1:%d (MBAP), 127.0.0.1:%d (RTU over TCP), %d bps\n", mbap_port, rtu_port, baud);
+  fflush(stdout);
+
+  std::vector<client_t> clients(client_num);
+  client_stats_t client_stats = { 0, 0, 0 };
+  for(int ii = 0; ii < client_num; ++ii){
+    client_t& c = clients[ii];
+    c.fd = client_connect_(mbap_port);
+    if(c.fd < 0) return 1;
+    c.tid = (uint16_t)(ii * 0x1000);
+    c.sent = 0;
+    c.pending = 0;
+    memset(c.pending_unit, 0, sizeof(c.pending_unit));
+  }
+
+  std::vector<uint8_t> serial_tx;
+  uint8_t buff[512];
+  const uint64_t start_ns = host_ns_();
+  bool started = false;
+
+  for(;;){
+    // ソケット
+    std::vector<struct pollfd> fds;
+    struct pollfd pfd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    pfd.fd = mbap_fd; fds.push_back(pfd);
+    pfd.fd = rtu_fd; fds.push_back(pfd);
+    for(int ii = 0; ii < modbus_tcp_gateway::CONNECTION_NUM; ++ii){
+      pfd.fd = sink.connections[ii].fd;
+      pfd.events = POLLIN | (sink.connections[ii].out.empty() ? 0 : POLLOUT);
+      fds.push_back(pfd);
+    }
+    pfd.events = POLLIN;
+    for(int ii = 0; ii < client_num; ++ii){
+      pfd.fd = clients[ii].fd;
+      fds.push_back(pfd);
+    }
+
+    // 仮想時間が実時間に追い付いていれば待つ
+    int timeout_ms = 0;
+    if(0 == client_num){
+      const uint64_t next = sim_clock::next_ns();
+      const uint64_t real = host_ns_() - start_ns;
+      if(next > real)
+        timeout_ms = (sim_clock::NEVER == next) ? 1 : (int)((next - real) / 1000000);
+      if(timeout_ms > 1) timeout_ms = 1;
+    }
+    poll(&fds[0], fds.size(), timeout_ms);
+
+    for(int ii = 0; ii < 2; ++ii){
+      if(0 == (fds[ii].revents & POLLIN)) continue;
+      const int fd = accept(fds[ii].fd, NULL, NULL);
+      if(fd < 0) continue;
+      int conn = 0;
+      while(conn < modbus_tcp_gateway::CONNECTION_NUM && sink.connections[conn].fd >= 0) ++conn;
+      if(conn == modbus_tcp_gateway::CONNECTION_NUM){
+        close(fd);
+        continue;
+      }
+      nonblock_(fd);
+      sink.connections[conn].fd = fd;
+      sink.connections[conn].out.clear();
+      gateway.open(conn, (0 == ii) ? modbus_tcp_gateway::MODE_MBAP : modbus_tcp_gateway::MODE_RTU);
+    }
+
+    for(int conn = 0; conn < modbus_tcp_gateway::CONNECTION_NUM; ++conn){
+      const struct pollfd& p = fds[2 + conn];
+      if(p.fd < 0 || 0 == p.revents) continue;
+      bool alive = true;
+      if(p.revents & POLLOUT)
+        alive = sink.flush(conn);
+      if(p.revents & (POLLIN | POLLHUP | POLLERR)){
+        const ssize_t n = recv(p.fd, buff, sizeof(buff), 0);
+        if(n > 0)
+          gateway.recieve(conn, buff, n);
+        else if(0 == n || (EAGAIN != errno && EWOULDBLOCK != errno))
+          alive = false;
+      }
+      if(!alive){
+        gateway.close(conn);
+        close(sink.connections[conn].fd);
+        sink.connections[conn].fd = -1;
+      }
+    }
+
+    if(0 != client_num){
+      bool finished = true;
+      for(int ii = 0; ii < client_num; ++ii){
+        client_t& c = clients[ii];
+        if(!started){
+          for(int jj = 0; jj < depth; ++jj)
+            client_send_(c, requests);
+        }
+        client_recieve_(c, client_stats, requests);
+        if(c.sent < requests || 0 != c.pending) finished = false;
+      }
+      started = true;
+      if(finished) break;
+    }
+
+    // 模擬バス, マスター, スレーブ
+    for(;;){
+      const size_t n = mu.read(buff, sizeof(buff));
+      if(0 != n)
+        master.recieve(serial_tx, buff, n);
+      master.idle(serial_tx);
+      gateway.idle(serial_tx);
+      if(!serial_tx.empty()){
+        mu.write(&serial_tx[0], serial_tx.size());
+        serial_tx.clear();
+      }
+      su2.process_frame();
+      su3.process_frame();
+      trace.drain(trace_writer_, NULL);
+
+      if(0 != client_num){
+        // 応答待ちのタイムアウト判定のため最大1ms
+        if(0 == gateway.queued()) break;
+        sim_clock::step(1000000);
+        break;
+      }
+      const uint64_t real = host_ns_() - start_ns;
+      if(sim_clock::now_ns() >= real || sim_clock::next_ns() > real) break;
+      sim_clock::step(real - sim_clock::now_ns());
+    }
+  }
+
+  const double elapsed = (host_ns_() - start_ns) / 1e9;
+  const double virtual_elapsed = sim_clock::now_ns() / 1e9;
+  const uint32_t total = client_stats.done + client_stats.exceptions + client_stats.errors;
+  printf("clients %d, depth %d, requests %u, done %u, exceptions %u, errors %u\n",
+         client_num, depth, total, client_stats.done, client_stats.exceptions, client_stats.errors);
+  printf("host %.3f s (%.0f req/s), virtual %.3f s (%.0f req/s)\n",
+         elapsed, total / elapsed, virtual_elapsed, (0.0 < virtual_elapsed) ? total / virtual_elapsed : 0.0);
+  printf("gateway local %u, forwarded %u, exceptions %u, discarded %u, queue peak %d\n",
+         gateway.local(), gateway.forwarded(), gateway.exceptions(), gateway.discarded(), gateway.queue_peak());
+  return (0 == client_stats.errors) ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file host/rs485_bus_sim.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 19:48:20
+ *  - first.
+ */
+
+#include "rs485_bus_sim.hpp"
+
+namespace seekers{
+namespace host{
+
+/**
+ * @brief コンストラクタ
+ * 既定は雑音無し.
+ */
+rs485_bus_sim::rs485_bus_sim() :
+  node_num_(0),
+  sending_(0),
+  noise_event_(*this)
+{
+  memset(nodes_, 0, sizeof(nodes_));
+  memset(&config_, 0, sizeof(config_));
+  reset_stats();
+}
+
+bool rs485_bus_sim::attach(mbed::SerialBase& uart, PinName de)
+{
+  if(node_num_ >= NODE_NUM) return false;
+  node_t& node = nodes_[node_num_++];
+  node.uart = &uart;
+  node.de = de;
+  node.sending = false;
+  node.de_at_begin = false;
+  node.corrupt = false;
+  uart.sim_connect(this);
+  return true;
+}
+
+void rs485_bus_sim::configure(const config_t& config)
+{
+  config_ = config;
+  random_.seed(config.seed);
+  arm_noise_();
+}
+
+void rs485_bus_sim::reset_stats(void)
+{
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+rs485_bus_sim::node_t* rs485_bus_sim::find_(mbed::SerialBase* uart)
+{
+  for(int ii = 0; ii < node_num_; ++ii){
+    if(nodes_[ii].uart == uart) return &nodes_[ii];
+  }
+  return NULL;
+}
+
+/**
+ * @brief 送出開始
+ * 他に送出中の UART があれば双方を衝突とする
+ */
+void rs485_bus_sim::tx_begin(mbed::SerialBase* from, uint8_t /*c*/)
+{
+  node_t* node = find_(from);
+  if(NULL == node) return;
+
+  node->de_at_begin = (NC == node->de) || 0 != pin_state(node->de);
+  node->corrupt = false;
+  if(node->de_at_begin && 0 != sending_){
+    node->corrupt = true;
+    for(int ii = 0; ii < node_num_; ++ii){
+      if(nodes_[ii].sending) nodes_[ii].corrupt = true;
+    }
+  }
+  node->sending = node->de_at_begin;
+  if(node->sending) ++sending_;
+}
+
+/**
+ * @brief 送出完了
+ * DE が送出の途中で解除されていれば出力しない(最終文字の欠落).
+ */
+void rs485_bus_sim::tx_end(mbed::SerialBase* from, uint8_t c)
+{
+  node_t* node = find_(from);
+  if(NULL == node) return;
+
+  const bool sending = node->sending;
+  if(sending){
+    node->sending = false;
+    --sending_;
+  }
+  const bool de = (NC == node->de) || 0 != pin_state(node->de);
+  if(!sending || !de){
+    ++stats_.de_errors;
+    return;
+  }
+
+  ++stats_.chars;
+  if(node->corrupt){
+    ++stats_.collisions;
+    c = (uint8_t)random_.next();
+  }
+  for(int ii = 0; ii < from->sim_data_bits(); ++ii){
+    if(random_.chance(config_.bit_error_rate)){
+      c ^= (uint8_t)(1 << ii);
+      ++stats_.bit_errors;
+    }
+  }
+  deliver_(node, c, from->sim_baud(), from->sim_bit_length());
+}
+
+/**
+ * @brief 受信イネーブル(DE 非アサート)の UART へ1文字渡す
+ */
+void rs485_bus_sim::deliver_(const node_t* from, uint8_t c, int baud, int bit_length)
+{
+  for(int ii = 0; ii < node_num_; ++ii){
+    const node_t& node = nodes_[ii];
+    if(&node == from) continue;
+    if(NC != node.de && 0 != pin_state(node.de)) continue;
+    if(node.uart->sim_baud() != baud || node.uart->sim_bit_length() != bit_length){
+      ++stats_.framing_errors;
+      continue;
+    }
+    node.uart->sim_rx(c);
+  }
+}
+
+uint64_t rs485_bus_sim::inter_char_gap_ns(mbed::SerialBase* /*from*/)
+{
+  if(!random_.chance(config_.gap_probability)) return 0;
+  ++stats_.gaps;
+  return (uint64_t)config_.gap_us * 1000;
+}
+
+/**
+ * @brief 雑音の混入
+ * 送出中なら送出中の文字を破損させ、無通信なら不定値を受信させる
+ */
+void rs485_bus_sim::noise_(void)
+{
+  ++stats_.noise_chars;
+  if(0 != sending_){
+    for(int ii = 0; ii < node_num_; ++ii){
+      if(nodes_[ii].sending) nodes_[ii].corrupt = true;
+    }
+  }else if(0 < node_num_){
+    const mbed::SerialBase* uart = nodes_[0].uart;
+    deliver_(NULL, (uint8_t)random_.next(), uart->sim_baud(), uart->sim_bit_length());
+  }
+  arm_noise_();
+}
+
+void rs485_bus_sim::arm_noise_(void)
+{
+  if(config_.noise_per_sec <= 0.0){
+    noise_event_.disarm();
+    return;
+  }
+  noise_event_.arm_after((uint64_t)random_.exponential(1e9 / config_.noise_per_sec));
+}
+
+} /* namespace host */
+} /* namespace seekers */
@@ -0,0 +1,127 @@
+/**
+ * @file host/rs485_bus_sim.hpp
+ * @brief RS485 半二重バスのホスト側模擬
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 19:48:20
+ *  - First.
+ */
+
+#ifndef SEEKERS_HOST_RS485_BUS_SIM_HPP
+#define SEEKERS_HOST_RS485_BUS_SIM_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "mbed.h"
+#include "sim_clock.hpp"
+
+namespace seekers{
+namespace host{
+
+/**
+ * @brief RS485 半二重バス
+ * 接続した UART(SerialBase)の送信を、送信イネーブル(DE)が送出開始から完了まで
+ * アサートされていた場合のみバスへ出力し、他の全 UART へ受信させる.
+ * 受信イネーブルは DE と共通とし(/RE = DE)、送信中の UART は受信しない.
+ * 通信速度, 1文字のbit長が送信側と異なる UART はフレーミングエラーとして受信しない.
+ * 送出が重なった場合(衝突)は不定値を受信させる.
+ */
+class rs485_bus_sim : public sim_line{
+public:
+  static const int NODE_NUM = 8;
+
+  /**
+   * @brief 雑音注入の設定
+   */
+  struct config_t{
+    double bit_error_rate;    ///< データbit毎の反転確率
+    double noise_per_sec;     ///< 無通信時に混入する雑音文字の平均発生数[/s]
+    double gap_probability;   ///< 文字間に無通信時間を挿入する確率
+    uint32_t gap_us;          ///< 挿入する無通信時間[us]
+    uint32_t seed;            ///< 疑似乱数の種
+  };
+
+  /**
+   * @brief 統計
+   */
+  struct stats_t{
+    uint32_t chars;           ///< バスへ出力した文字数
+    uint32_t bit_errors;      ///< 反転したbit数
+    uint32_t noise_chars;     ///< 混入した雑音文字数
+    uint32_t collisions;      ///< 衝突で破損した文字数
+    uint32_t framing_errors;  ///< 通信速度/書式の不一致で受信しなかった文字数
+    uint32_t de_errors;       ///< DE 未アサートでバスへ出力されなかった文字数
+    uint32_t gaps;            ///< 挿入した文字間の無通信時間の数
+  };
+
+private:
+  struct node_t{
+    mbed::SerialBase* uart;
+    PinName de;
+    bool sending;
+    bool de_at_begin;
+    bool corrupt;
+  };
+
+  class noise_event_t : public sim_event{
+  private:
+    rs485_bus_sim& bus_;
+  protected:
+    void fire(void)
+    {
+      bus_.noise_();
+    }
+  public:
+    explicit noise_event_t(rs485_bus_sim& bus) :
+      bus_(bus)
+    {}
+  };
+
+  node_t nodes_[NODE_NUM];
+  int node_num_;
+  int sending_;
+
+  config_t config_;
+  stats_t stats_;
+  sim_random random_;
+  noise_event_t noise_event_;
+
+  node_t* find_(mbed::SerialBase* uart);
+  void deliver_(const node_t* from, uint8_t c, int baud, int bit_length);
+  void noise_(void);
+  void arm_noise_(void);
+
+public:
+  rs485_bus_sim();
+
+  /**
+   * @brief UART の接続
+   * @param de 送信イネーブルのピン(DigitalOut). NC なら常にアサートとみなす
+   * @return 接続数の上限を超えたらfalse
+   */
+  bool attach(mbed::SerialBase& uart, PinName de = NC);
+
+  void configure(const config_t& config);
+  const config_t& config(void) const { return config_; }
+
+  const stats_t& stats(void) const { return stats_; }
+  void reset_stats(void);
+
+  /**
+   * @brief 送出中の UART があるか
+   */
+  bool busy(void) const { return 0 != sending_; }
+
+  // sim_line
+  void tx_begin(mbed::SerialBase* from, uint8_t c);
+  void tx_end(mbed::SerialBase* from, uint8_t c);
+  uint64_t inter_char_gap_ns(mbed::SerialBase* from);
+};
+
+} /* namespace host */
+} /* namespace seekers */
+
+#endif /* SEEKERS_HOST_RS485_BUS_SIM_HPP */
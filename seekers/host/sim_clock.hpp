@@ -0,0 +1,140 @@
+/**
+ * @file host/sim_clock.hpp
+ * @brief ホスト側模擬の仮想時間
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 19:48:20
+ *  - First.
+ */
+
+#ifndef SEEKERS_HOST_SIM_CLOCK_HPP
+#define SEEKERS_HOST_SIM_CLOCK_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace seekers{
+namespace host{
+
+/**
+ * @brief 仮想時間で発生する事象
+ * arm() した時刻に sim_clock が fire() を呼び出す(割り込みコンテキスト相当).
+ * 同時刻の事象は arm() した順に発生する.
+ */
+class sim_event{
+private:
+  uint64_t at_ns_;
+  uint64_t seq_;
+  bool armed_;
+
+  friend class sim_clock;
+
+  sim_event(const sim_event&);
+  sim_event& operator=(const sim_event&);
+
+protected:
+  virtual void fire(void) = 0;
+
+public:
+  sim_event();
+  virtual ~sim_event();
+
+  void arm(uint64_t at_ns);
+  void arm_after(uint64_t ns);
+  void disarm(void)
+  {
+    armed_ = false;
+  }
+
+  bool armed(void) const { return armed_; }
+  uint64_t at_ns(void) const { return at_ns_; }
+};
+
+/**
+ * @brief 仮想時間
+ * 時間は step(), advance() でのみ進む. 処理時間は0とみなす.
+ */
+class sim_clock{
+private:
+  sim_clock();
+
+public:
+  static const uint64_t NEVER = ~(uint64_t)0;
+
+  static uint64_t now_ns(void);
+  static uint32_t now_us(void)
+  {
+    return (uint32_t)(now_ns() / 1000);
+  }
+
+  /**
+   * @brief 次の事象の時刻. 無ければ NEVER
+   */
+  static uint64_t next_ns(void);
+
+  /**
+   * @brief 次の事象まで(最大 max_ns)時間を進め、その時刻の事象を全て発生させる
+   * @return 発生した事象の数
+   */
+  static int step(uint64_t max_ns = NEVER);
+
+  /**
+   * @brief ns 後まで時間を進める. 期間内の事象は全て発生させる
+   */
+  static void advance(uint64_t ns);
+
+  /**
+   * @brief 時刻0へ戻す. 登録済みの事象は全て解除する
+   */
+  static void reset(void);
+};
+
+/**
+ * @brief 疑似乱数(xorshift32). 雑音注入の再現性のため
+ */
+class sim_random{
+private:
+  uint32_t x_;
+
+public:
+  explicit sim_random(uint32_t seed = 2463534242u) :
+    x_(seed ? seed : 2463534242u)
+  {}
+
+  void seed(uint32_t seed)
+  {
+    x_ = seed ? seed : 2463534242u;
+  }
+
+  uint32_t next(void)
+  {
+    x_ ^= x_ << 13;
+    x_ ^= x_ >> 17;
+    x_ ^= x_ << 5;
+    return x_;
+  }
+
+  /**
+   * @brief 確率 p で true
+   */
+  bool chance(double p)
+  {
+    if(p <= 0.0) return false;
+    return (next() / 4294967296.0) < p;
+  }
+
+  /**
+   * @brief 平均 mean の指数分布
+   */
+  double exponential(double mean);
+};
+
+} /* namespace host */
+} /* namespace seekers */
+
+#endif /* SEEKERS_HOST_SIM_CLOCK_HPP */
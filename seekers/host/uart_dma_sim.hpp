@@ -0,0 +1,183 @@
+/**
+ * @file host/uart_dma_sim.hpp
+ * @brief DMA/UART 周辺機能のホスト側模擬
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 16:40:27
+ *  - First.
+ * - 2026-10-17 23:59:30
+ *  - 受信累計byte数, 受信バッファ半分毎の通知, 受信停止, 受信アイドル時間の設定を追加.
+ */
+
+#ifndef SEEKERS_HOST_UART_DMA_SIM_HPP
+#define SEEKERS_HOST_UART_DMA_SIM_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <deque>
+#include <vector>
+
+#include "../uart_dma.hpp"
+
+namespace seekers{
+
+/**
+ * @brief DMA/UART 周辺機能のホスト側模擬
+ * 仮想時間[ns]で動作する. inject() した受信データは1文字の時間毎にDMAで
+ * 受信バッファへ書き込まれ、idle_chars 文字分(rx_idle_us() で変更)の無通信で受信アイドルを通知する.
+ * 受信バッファの半分を書き込む毎に on_rx_half() を通知する. 受信停止中の受信データは破棄する.
+ * 送信は size 文字分の時間後に送信完了を通知する.
+ */
+class uart_dma_sim : public uart_dma_port{
+private:
+  struct rx_char_t{
+    uint64_t done_ns;  // ストップビット受信完了時刻
+    uint8_t value;
+  };
+
+  uint64_t char_ns_;
+  uint64_t idle_ns_;
+  uint64_t now_ns_;
+
+  uint8_t* rx_buff_;
+  size_t rx_size_;
+  uint32_t rx_count_;
+  uint32_t rx_count_origin_;
+  std::deque<rx_char_t> rx_line_;
+  uint64_t rx_last_ns_;   // 最後の受信完了時刻
+  bool rx_idle_armed_;
+
+  bool tx_active_;
+  uint64_t tx_done_ns_;
+  bool de_;
+  std::vector<uint8_t> transmitted_;
+
+public:
+  uart_dma_sim(int baud, int bit_length, int idle_chars = 1) :
+    char_ns_((uint64_t)bit_length * 1000000000ull / baud),
+    idle_ns_(char_ns_ * idle_chars),
+    now_ns_(0),
+    rx_buff_(NULL),
+    rx_size_(0),
+    rx_count_(0),
+    rx_count_origin_(0),
+    rx_last_ns_(0),
+    rx_idle_armed_(false),
+    tx_active_(false),
+    tx_done_ns_(0),
+    de_(false)
+  {}
+
+  // uart_dma_port
+  void start_rx(uint8_t* rx_buff, size_t size)
+  {
+    rx_buff_ = rx_buff;
+    rx_size_ = size;
+    rx_count_ = rx_count_origin_;
+  }
+
+  void stop_rx(void)
+  {
+    rx_buff_ = NULL;
+    rx_idle_armed_ = false;
+  }
+
+  uint32_t rx_count(void)
+  {
+    return rx_count_;
+  }
+
+  void rx_idle_us(int us)
+  {
+    idle_ns_ = (uint64_t)us * 1000;
+  }
+
+  void start_tx(const uint8_t* src, size_t size)
+  {
+    transmitted_.insert(transmitted_.end(), src, src + size);
+    tx_active_ = true;
+    tx_done_ns_ = now_ns_ + char_ns_ * size;
+  }
+
+  void driver_enable(bool on)
+  {
+    de_ = on;
+  }
+
+  /**
+   * @brief 受信データの投入
+   * @param gap_us 直前の受信データ(無ければ現在時刻)からの無通信時間
+   */
+  void inject(const uint8_t* src, size_t size, uint32_t gap_us = 0)
+  {
+    uint64_t t = rx_line_.empty() ? now_ns_ : rx_line_.back().done_ns;
+    if(t < now_ns_) t = now_ns_;
+    t += (uint64_t)gap_us * 1000;
+    for(size_t ii = 0; ii < size; ++ii){
+      t += char_ns_;
+      rx_char_t c = { t, src[ii] };
+      rx_line_.push_back(c);
+    }
+  }
+
+  /**
+   * @brief 仮想時間を進める
+   * 期間内の受信, 受信アイドル, 送信完了を発生順に transport へ通知する
+   */
+  void advance(uint64_t us)
+  {
+    const uint64_t end = now_ns_ + us * 1000;
+    for(;;){
+      uint64_t next = end;
+      int ev = 0;
+      if(!rx_line_.empty() && rx_line_.front().done_ns <= next){ next = rx_line_.front().done_ns; ev = 1; }
+      if(rx_idle_armed_ && rx_last_ns_ + idle_ns_ < next){ next = rx_last_ns_ + idle_ns_; ev = 2; }
+      if(tx_active_ && tx_done_ns_ < next){ next = tx_done_ns_; ev = 3; }
+      if(0 == ev) break;
+
+      now_ns_ = next;
+      switch(ev){
+      case 1:
+        if(NULL != rx_buff_){
+          rx_buff_[rx_count_ % rx_size_] = rx_line_.front().value;
+          ++rx_count_;
+          rx_last_ns_ = now_ns_;
+          rx_idle_armed_ = true;
+          if(0 == rx_count_ % (rx_size_ / 2) && NULL != transport_)
+            transport_->on_rx_half();
+        }
+        rx_line_.pop_front();
+        break;
+      case 2:
+        rx_idle_armed_ = false;
+        if(NULL != transport_) transport_->on_idle_line();
+        break;
+      case 3:
+        tx_active_ = false;
+        if(NULL != transport_) transport_->on_tx_complete();
+        break;
+      }
+    }
+    now_ns_ = end;
+  }
+
+  /**
+   * @brief 受信開始時の累計byte数(2^32 での循環の確認用. start_rx() の前に設定)
+   */
+  void rx_count_origin(uint32_t count)
+  {
+    rx_count_origin_ = count;
+  }
+
+  uint64_t now_ns(void) const { return now_ns_; }
+  bool de(void) const { return de_; }
+  const std::vector<uint8_t>& transmitted(void) const { return transmitted_; }
+  void clear_transmitted(void) { transmitted_.clear(); }
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_HOST_UART_DMA_SIM_HPP */
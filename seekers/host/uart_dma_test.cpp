@@ -0,0 +1,311 @@
+/**
+ * @file host/uart_dma_test.cpp
+ * @brief uart_dma_transport の動作確認(ホスト側)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:59:30
+ *  - first.
+ *
+ * uart_dma_sim(仮想時間のDMA/UART)で以下を確認する. 不一致があれば 1 を返す.
+ *  - フレームの通知(折り返し無し/有り), 受信バッファ長ちょうどのフレーム
+ *  - 受信バッファ長を超えたフレームの破棄(一周の検出), read() の上書き検出
+ *  - 累計byte数の 2^32 での循環, 受信バッファ半分毎の通知
+ *  - 送信完了での送信イネーブル解除(連続送信中は解除しない)
+ *  - RS485Serial::dma_attach() でのフレーム受信モード(process_frame())と一括受信
+ * 最後に 115200bps で 8byte フレームを受信した時の割り込み回数を出力する.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "mbed.h"
+#include "uart_dma_sim.hpp"
+#include "../mbed/rs485serial.hpp"
+
+using namespace seekers;
+
+namespace{
+
+int errors_ = 0;
+
+void check_(bool ok, const char* name)
+{
+  printf("%s %s\n", ok ? "OK" : "NG", name);
+  if(!ok) ++errors_;
+}
+
+/**
+ * @brief 通知されたフレームの記録
+ */
+struct frame_log{
+  std::vector<std::vector<uint8_t> > frames;
+  std::vector<size_t> size2;   // 2つ目の領域のbyte数(折り返し)
+  int rx_half;
+  int tx_done;
+
+  frame_log() : rx_half(0), tx_done(0) {}
+
+  static void on_frame(void* context, const uint8_t* data1, size_t size1, const uint8_t* data2, size_t size2)
+  {
+    frame_log* self = static_cast<frame_log*>(context);
+    std::vector<uint8_t> f(data1, data1 + size1);
+    if(NULL != data2)
+      f.insert(f.end(), data2, data2 + size2);
+    self->frames.push_back(f);
+    self->size2.push_back(size2);
+  }
+
+  static void on_rx(void* context)
+  {
+    ++static_cast<frame_log*>(context)->rx_half;
+  }
+
+  static void on_tx(void* context)
+  {
+    ++static_cast<frame_log*>(context)->tx_done;
+  }
+};
+
+std::vector<uint8_t> pattern_(size_t size, uint8_t seed)
+{
+  std::vector<uint8_t> v(size);
+  for(size_t ii = 0; ii < size; ++ii)
+    v[ii] = (uint8_t)(seed + ii * 7);
+  return v;
+}
+
+const int BAUD = 115200;
+const int BITS = 10;
+
+/**
+ * @brief フレーム通知, 折り返し, 受信バッファ長ちょうど, 一周
+ */
+void test_frames_(uint32_t origin, const char* title)
+{
+  printf("-- frames (rx_count origin %08x) %s\n", origin, title);
+  uart_dma_sim port(BAUD, BITS, 4);
+  uart_dma_transportT<64> dma(port);
+  frame_log log;
+  dma.frame_attach(frame_log::on_frame, &log);
+  dma.rx_attach(frame_log::on_rx, &log);
+  port.rx_count_origin(origin);
+  dma.start();
+
+  const std::vector<uint8_t> a = pattern_(10, 0x10);
+  port.inject(&a[0], a.size());
+  port.advance(2000);
+  check_(1 == log.frames.size() && a == log.frames[0] && 0 == log.size2[0], "single frame");
+
+  // 10..50: 折り返し無し, 50..(64)..26: 折り返し有り
+  const std::vector<uint8_t> b = pattern_(40, 0x20);
+  const std::vector<uint8_t> c = pattern_(40, 0x30);
+  port.inject(&b[0], b.size(), 1000);
+  port.inject(&c[0], c.size(), 1000);
+  port.advance(10000);
+  check_(3 == log.frames.size() && b == log.frames[1] && c == log.frames[2], "wrapped frame content");
+  check_(3 == log.size2.size() && 0 == log.size2[1] && 26 == log.size2[2], "wrapped frame split 14 + 26");
+
+  // 受信バッファ長ちょうど(先頭 26 から一周)
+  const std::vector<uint8_t> d = pattern_(64, 0x40);
+  port.inject(&d[0], d.size(), 1000);
+  port.advance(10000);
+  check_(4 == log.frames.size() && d == log.frames[3], "full-buffer frame (64 of 64) delivered");
+  check_(4 == log.size2.size() && 26 == log.size2[3], "full-buffer frame split 38 + 26");
+  check_(0 == dma.frames_lost(), "no frame lost so far");
+
+  // 受信バッファ長を超えたフレーム(先頭が上書き済み)は破棄
+  const std::vector<uint8_t> e = pattern_(65, 0x50);
+  port.inject(&e[0], e.size(), 1000);
+  port.advance(10000);
+  check_(4 == log.frames.size() && 1 == dma.frames_lost(), "lapped frame (65 of 64) dropped and counted");
+
+  // 一周した後も次のフレームは正しく通知される
+  const std::vector<uint8_t> f = pattern_(12, 0x60);
+  port.inject(&f[0], f.size(), 1000);
+  port.advance(10000);
+  check_(5 == log.frames.size() && f == log.frames[4], "frame after lap");
+
+  // 受信数 10 + 40 + 40 + 64 + 65 + 12 = 231 byte, 半分(32byte)毎の通知
+  check_(231 / 32 == log.rx_half, "rx half notifications");
+  check_(5 == dma.frames(), "frames() count");
+}
+
+/**
+ * @brief read() の上書き検出
+ */
+void test_read_(void)
+{
+  printf("-- read\n");
+  uart_dma_sim port(BAUD, BITS, 4);
+  uart_dma_transportT<64> dma(port);
+  dma.start();
+
+  const std::vector<uint8_t> a = pattern_(64, 0x01);
+  port.inject(&a[0], a.size());
+  port.advance(10000);
+  std::vector<uint8_t> buff(128);
+  check_(64 == dma.readable(), "readable() full buffer");
+  size_t n = dma.read(&buff[0], buff.size());
+  check_(64 == n && std::vector<uint8_t>(buff.begin(), buff.begin() + n) == a && 0 == dma.rx_overrun(),
+         "read() exactly one buffer without overrun");
+
+  const std::vector<uint8_t> b = pattern_(100, 0x80);
+  port.inject(&b[0], b.size());
+  port.advance(20000);
+  check_(64 == dma.readable(), "readable() clamps at capacity after lap");
+  n = dma.read(&buff[0], buff.size());
+  check_(64 == n && std::vector<uint8_t>(buff.begin(), buff.begin() + n) == std::vector<uint8_t>(b.begin() + 36, b.end()),
+         "read() after lap returns the newest 64 bytes");
+  check_(36 == dma.rx_overrun(), "rx_overrun() counts the 36 overwritten bytes");
+  check_(0 == dma.read(&buff[0], buff.size()), "read() empty");
+}
+
+/**
+ * @brief 送信完了と送信イネーブル
+ */
+struct chain_tx{
+  uart_dma_transport* dma;
+  const uint8_t* next;
+  size_t size;
+  int done;
+
+  static void on_tx(void* context)
+  {
+    chain_tx* self = static_cast<chain_tx*>(context);
+    ++self->done;
+    if(NULL != self->next){
+      const uint8_t* p = self->next;
+      self->next = NULL;
+      self->dma->write(p, self->size);
+    }
+  }
+};
+
+void test_tx_(void)
+{
+  printf("-- tx\n");
+  uart_dma_sim port(BAUD, BITS, 4);
+  uart_dma_transportT<64> dma(port);
+  dma.start();
+
+  const std::vector<uint8_t> a = pattern_(8, 0x11);
+  const std::vector<uint8_t> b = pattern_(5, 0x22);
+  chain_tx chain = { &dma, &b[0], b.size(), 0 };
+  dma.tx_attach(chain_tx::on_tx, &chain);
+
+  check_(dma.write(&a[0], a.size()) && port.de() && dma.tx_busy(), "write() asserts DE");
+  check_(!dma.write(&a[0], a.size()), "write() while busy is refused");
+  port.advance(8 * 87 + 10);
+  check_(1 == chain.done && port.de() && dma.tx_busy(), "DE kept while the handler chains the next write");
+  port.advance(5 * 87 + 10);
+  check_(2 == chain.done && !port.de() && !dma.tx_busy(), "DE released on the final transmit-complete");
+
+  std::vector<uint8_t> all(a);
+  all.insert(all.end(), b.begin(), b.end());
+  check_(all == port.transmitted(), "transmitted bytes");
+}
+
+/**
+ * @brief 受信フレームをそのまま返すモジュール
+ */
+class echo_module : public basic_static_com_module{
+public:
+  using basic_static_com_module::recieve;
+  using basic_static_com_module::idle;
+  int frames;
+
+  echo_module() : frames(0) {}
+
+  void recieve(frame_buff_t& tx_buf, const uint8_t* src, size_t size)
+  {
+    ++frames;
+    tx_buf.insert(tx_buf.end(), src, src + size);
+  }
+
+  void idle(frame_buff_t&) {}
+};
+
+/**
+ * @brief RS485Serial 経由
+ */
+void test_rs485serial_(void)
+{
+  printf("-- RS485Serial\n");
+  RS485SerialT<256, 256> uart(p9, p10, p8);
+  uart.baud(BAUD);
+  uart.format(8, SerialBase::None, 1);
+
+  uart_dma_sim port(BAUD, BITS, 1);
+  uart_dma_transportT<64> dma(port);
+  uart.dma_attach(&dma);
+  check_(&dma == uart.dma(), "dma_attach()");
+
+  // 一括受信
+  const std::vector<uint8_t> a = pattern_(20, 0x33);
+  port.inject(&a[0], a.size());
+  port.advance(5000);
+  std::vector<uint8_t> buff(64);
+  check_(1 == uart.readable(), "readable() via DMA");
+  const int c = uart.getc();
+  size_t n = uart.read(&buff[0], buff.size());
+  check_(a[0] == c && 19 == n && std::equal(a.begin() + 1, a.end(), buff.begin()), "getc()/read() via DMA");
+
+  // フレーム受信モード. 折り返したフレームを複写して module へ渡し、応答をDMAで送信する
+  echo_module echo;
+  uart.frame_attach(&echo);
+  const std::vector<uint8_t> f = pattern_(60, 0x44); // 受信位置 20 から 80(折り返し)
+  port.inject(&f[0], f.size(), 1000);
+  port.advance(20000);
+  check_(1 == uart.process_frame() && 1 == echo.frames, "process_frame() on a wrapped DMA frame");
+  check_(0 == uart.process_frame(), "process_frame() once per frame");
+  port.advance(20000);
+  check_(f == port.transmitted() && !port.de(), "response sent by DMA");
+  check_(0 == uart.frame_dropped(), "frame_dropped()");
+  check_(1 == uart.turnaround_count(), "turnaround recorded on transmit-complete");
+
+  // 受信バッファ長を超えたフレーム
+  const std::vector<uint8_t> g = pattern_(70, 0x55);
+  port.inject(&g[0], g.size(), 1000);
+  port.advance(20000);
+  check_(0 == uart.process_frame() && 1 == uart.frame_dropped(), "lapped frame reported by frame_dropped()");
+
+  uart.frame_detach();
+  uart.dma_attach(NULL);
+  check_(NULL == uart.dma(), "dma_attach(NULL)");
+}
+
+/**
+ * @brief 割り込み回数
+ */
+void bench_irq_(void)
+{
+  const int FRAMES = 1000;
+  uart_dma_sim port(BAUD, BITS, 4);
+  uart_dma_transportT<512> dma(port);
+  dma.start();
+  const std::vector<uint8_t> f = pattern_(8, 0x66);
+  for(int ii = 0; ii < FRAMES; ++ii){
+    port.inject(&f[0], f.size(), 2000);
+    port.advance(3000);
+  }
+  printf("-- irq: %d frames x %u byte at %dbps: dma %u irq (%.2f/frame), per-byte rx irq %u\n",
+         FRAMES, (unsigned)f.size(), BAUD, dma.irq_count(), (double)dma.irq_count() / FRAMES,
+         (unsigned)(FRAMES * f.size()));
+}
+
+} /* namespace */
+
+int main(void)
+{
+  test_frames_(0, "");
+  test_frames_(0xffffffc0u, "(wraps 2^32)");
+  test_read_();
+  test_tx_();
+  test_rs485serial_();
+  bench_irq_();
+
+  printf("uart_dma_test: %s (%d)\n", 0 == errors_ ? "OK" : "NG", errors_);
+  return 0 == errors_ ? 0 : 1;
+}
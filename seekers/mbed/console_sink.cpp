@@ -0,0 +1,163 @@
+/**
+ * @file mbed/console_sink.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:20:14
+ *  - first.
+ * - 2026-10-17 23:59:50
+ *  - printf() の出力長の上限を LONGBUFSIZE へ拡大. 空き待ちのスリープを割り込み禁止区間で判定.
+ */
+
+#if defined(__MBED__)
+
+#include <cstdarg>
+#include <cstring>
+#include "mbed.h"
+#include "console_sink.hpp"
+
+namespace seekers{
+
+char console_sink::long_buff_[console_sink::LONGBUFSIZE];
+
+/**
+ * @brief コンストラクタ
+ */
+console_sink::console_sink(RawSerial& serial, uint8_t* tx_buff, size_t tx_size) :
+  serial_(serial),
+  tx_buff_(tx_buff, tx_size),
+  tx_active_(false),
+  policy_(POLICY_BLOCK),
+  dropped_(0)
+{}
+
+/**
+ * @brief 割り込みコンテキストの判定
+ */
+bool console_sink::in_isr_(void)
+{
+#if defined(SEEKERS_HOST_SIM)
+  return false;
+#else
+  return 0 != __get_IPSR();
+#endif
+}
+
+/**
+ * @brief 出力
+ * POLICY_BLOCK では全て格納するまで待つ. POLICY_DROP では空きが足りなければ全て破棄する.
+ * @return 全て格納したらtrue
+ */
+bool console_sink::write(const void* src, size_t size)
+{
+  if(in_isr_() || (POLICY_DROP == policy_ && tx_buff_.capacity() - tx_buff_.size() < size)){
+    dropped_ += size;
+    return false;
+  }
+
+  const uint8_t* p = (const uint8_t*)src;
+  size_t done = 0;
+  for(;;){
+    done += tx_buff_.push(p + done, size - done);
+    tx_start_();
+    if(done == size) break;
+
+    // 送信割り込みによる空きを待つ. 判定後の割り込みで起床を逃さないよう、
+    // 判定とスリープは割り込み禁止区間で行う(保留中の割り込みで起床する)
+    core_util_critical_section_enter();
+    if(tx_buff_.full())
+      sleep();
+    core_util_critical_section_exit();
+  }
+  return true;
+}
+
+int console_sink::putc(int c)
+{
+  const uint8_t b = (uint8_t)c;
+  return write(&b, 1) ? c : -1;
+}
+
+int console_sink::puts(const char* s)
+{
+  const size_t n = strlen(s);
+  return write(s, n) ? (int)n : -1;
+}
+
+/**
+ * @brief 書式付き出力
+ * STDBUFSIZE - 1 を超えた場合は静的領域(LONGBUFSIZE)へ再整形する.
+ * LONGBUFSIZE - 1 を超える部分は切り捨てる. 割り込みコンテキストでは整形せずに -1 を返す.
+ */
+int console_sink::printf(const char* format, ...)
+{
+  if(in_isr_()) return -1;
+
+  va_list arg;
+  char buff[STDBUFSIZE];
+  va_start(arg, format);
+  int n = vsnprintf(buff, sizeof(buff), format, arg);
+  va_end(arg);
+  if(0 >= n) return n;
+  if(n < STDBUFSIZE)
+    return write(buff, n) ? n : -1;
+
+  va_start(arg, format);
+  n = vsnprintf(long_buff_, sizeof(long_buff_), format, arg);
+  va_end(arg);
+  if(n > LONGBUFSIZE - 1) n = LONGBUFSIZE - 1;
+  return write(long_buff_, n) ? n : -1;
+}
+
+/**
+ * @brief 送信バッファが空になるまで待つ
+ */
+void console_sink::flush(void)
+{
+  if(in_isr_()) return;
+  core_util_critical_section_enter();
+  while(!tx_buff_.empty()){
+    sleep();
+    core_util_critical_section_exit();  // 保留中の送信割り込みをここで処理
+    core_util_critical_section_enter();
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * @brief 送信開始
+ * 送信割り込みが停止していれば1文字目を送出して送信割り込みを有効にする
+ */
+void console_sink::tx_start_(void)
+{
+  core_util_critical_section_enter();
+  if(!tx_active_){
+    uint8_t c = 0;
+    if(tx_buff_.pop(c)){
+      tx_active_ = true;
+      serial_.putc(c);
+      serial_.attach( callback(this, &console_sink::tx_handler_), Serial::TxIrq);
+    }
+  }
+  core_util_critical_section_exit();
+}
+
+/**
+ * @brief 送信割り込みハンドラ
+ * 送信バッファに残りがあれば次の文字を送出. 空なら送信割り込みを停止する.
+ */
+void console_sink::tx_handler_(console_sink* self)
+{
+  uint8_t c = 0;
+  if(self->tx_buff_.pop(c)){
+    self->serial_.putc(c);
+    return;
+  }
+  self->serial_.attach( Callback<void()>(), Serial::TxIrq);
+  self->tx_active_ = false;
+}
+
+} /* namespace */
+
+#endif /* __MBED__ */
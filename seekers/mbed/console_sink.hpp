@@ -0,0 +1,108 @@
+/**
+ * @file mbed/console_sink.hpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:20:14
+ *  - First.
+ * - 2026-10-17 23:59:50
+ *  - printf() の出力長の上限を LONGBUFSIZE へ拡大. 空き待ちのスリープを割り込み禁止区間で判定.
+ */
+
+#ifndef SEEKERS_MBED_CONSOLE_SINK_HPP
+#define SEEKERS_MBED_CONSOLE_SINK_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#if defined(__MBED__)
+
+#include "mbed.h"
+#include "../spsc_ring.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンソール(RawSerial)への非同期出力
+ * 出力は送信バッファへ格納して即座に戻り、送信割り込みで1文字ずつ送出する.
+ * 送信バッファに空きが無い場合の動作は policy_t で選択する.
+ *  - POLICY_BLOCK : 空くまで待つ(sleep() で送信割り込みを待つ). メニュー等の欠けてはならない出力
+ *  - POLICY_DROP  : 書き込み単位で全て破棄して dropped() を加算する. ダンプ等の連続出力
+ * 生産者はメインループのみ(単一生産者). 割り込みコンテキストからは出力せず、
+ * event_loop::post() でメインループへ通知して出力する(割り込みコンテキストから呼び出された場合は
+ * 送信バッファに触れずに破棄として数える).
+ */
+class console_sink{
+public:
+  enum policy_t{
+    POLICY_BLOCK,
+    POLICY_DROP
+  };
+
+private:
+  static const int STDBUFSIZE = 160;  // printf使用時のバッファサイズ(スタック消費量)
+  static const int LONGBUFSIZE = 512; // STDBUFSIZE を超えた printf の再整形先(静的領域. 出力長の上限)
+  static char long_buff_[LONGBUFSIZE];
+
+  RawSerial& serial_;
+  basic_spsc_ring<uint8_t> tx_buff_;  // 送信バッファ(消費者:送信割り込み)
+  volatile bool tx_active_;           // 送信割り込み動作中
+  policy_t policy_;
+  uint32_t dropped_;
+
+  static void tx_handler_(console_sink*);
+  void tx_start_(void);
+  static bool in_isr_(void);
+
+  console_sink(const console_sink&);
+  console_sink& operator=(const console_sink&);
+
+protected:
+  console_sink(RawSerial& serial, uint8_t* tx_buff, size_t tx_size);
+
+public:
+  bool write(const void* src, size_t size);
+  int putc(int c);
+  int puts(const char* s);
+  int printf(const char* format, ...);
+  void flush(void);
+
+  void policy(policy_t policy) { policy_ = policy; }
+  policy_t policy(void) const { return policy_; }
+
+  /**
+   * @brief POLICY_DROP で破棄したbyte数
+   */
+  uint32_t dropped(void) const { return dropped_; }
+
+  /**
+   * @brief 送信待ちのbyte数
+   */
+  size_t pending(void) const { return tx_buff_.size(); }
+};
+
+
+/**
+ * @brief コンソールへの非同期出力(バッファ容量指定)
+ * @tparam TXSIZE 送信バッファ容量(2のべき乗)
+ */
+template <size_t TXSIZE = 1024>
+class console_sinkT : public console_sink
+{
+private:
+  typedef char power_of_two_check[(0 == (TXSIZE & (TXSIZE - 1))) ? 1 : -1];
+  uint8_t tx_storage_[TXSIZE];
+
+public:
+  explicit console_sinkT(RawSerial& serial) :
+    console_sink(serial, tx_storage_, TXSIZE)
+  {}
+};
+
+} /* namespace */
+
+#endif /* __MBED__ */
+
+#endif /* SEEKERS_MBED_CONSOLE_SINK_HPP */
@@ -0,0 +1,99 @@
+/**
+ * @file mbed/event_loop.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 21:05:40
+ *  - first.
+ * - 2026-10-17 23:20:14
+ *  - イベント処理1回の最大時間(busy_max_us())の計測を追加.
+ */
+
+#if defined(__MBED__)
+
+#include "mbed.h"
+#include "event_loop.hpp"
+
+namespace seekers{
+
+/**
+ * @brief イベントの通知. 割り込みコンテキストから呼び出し可能
+ */
+void event_loop::post(uint32_t events)
+{
+  core_util_critical_section_enter();
+  pending_ |= events;
+  core_util_critical_section_exit();
+}
+
+/**
+ * @brief 通知済みイベントの取り出し(待たない)
+ * @return 前回の取り出しから通知されたイベント. 無ければ0
+ */
+uint32_t event_loop::poll(void)
+{
+  core_util_critical_section_enter();
+  const uint32_t events = pending_;
+  pending_ = 0;
+  core_util_critical_section_exit();
+  return events;
+}
+
+/**
+ * @brief イベントの待ち合わせ
+ * 割り込み禁止のままイベントの有無を確認してスリープするため、確認からスリープまでの間の
+ * 通知を取りこぼさない(保留中の割り込みで WFI から復帰し、割り込み許可で処理される).
+ * @return 通知されたイベント(0以外)
+ */
+uint32_t event_loop::wait(void)
+{
+  if(busy_){
+    const uint32_t busy = us_ticker_read() - busy_start_us_;
+    if(busy > busy_max_us_) busy_max_us_ = busy;
+  }
+  core_util_critical_section_enter();
+  while(0 == pending_){
+    const uint32_t t0 = us_ticker_read();
+    sleep();
+    idle_us_ += us_ticker_read() - t0;
+    ++wakeups_;
+    core_util_critical_section_exit();  // 保留中の割り込みをここで処理
+    core_util_critical_section_enter();
+  }
+  const uint32_t events = pending_;
+  pending_ = 0;
+  core_util_critical_section_exit();
+  busy_start_us_ = us_ticker_read();
+  busy_ = true;
+  return events;
+}
+
+uint32_t event_loop::window_us(void) const
+{
+  return us_ticker_read() - window_start_us_;
+}
+
+uint32_t event_loop::idle_permille(void) const
+{
+  const uint32_t window = window_us();
+  if(0 == window) return 0;
+  return (uint32_t)((uint64_t)idle_us_ * 1000 / window);
+}
+
+/**
+ * @brief アイドル率の計測開始. us_ticker の周回(約71分)より短い間隔で呼び出すこと
+ */
+void event_loop::reset_idle(void)
+{
+  core_util_critical_section_enter();
+  window_start_us_ = us_ticker_read();
+  idle_us_ = 0;
+  wakeups_ = 0;
+  busy_max_us_ = 0;
+  core_util_critical_section_exit();
+}
+
+} /* namespace */
+
+#endif /* defined(__MBED__) */
@@ -0,0 +1,88 @@
+/**
+ * @file mbed/event_loop.hpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 21:05:40
+ *  - First.
+ * - 2026-10-17 23:20:14
+ *  - イベント処理1回の最大時間(busy_max_us())の計測を追加.
+ */
+
+#ifndef SEEKERS_MBED_EVENT_LOOP_HPP
+#define SEEKERS_MBED_EVENT_LOOP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#if defined(__MBED__)
+
+#include "mbed.h"
+
+namespace seekers{
+
+/**
+ * @brief イベント待ちループ
+ * 割り込み(受信, Ticker 等)が post() したイベント(bit)を、メインループが wait() で受け取る.
+ * イベントが無い間はコアをスリープ(WFI)させ、その時間をアイドル時間として計測する.
+ * 同じイベントを複数回 post() しても、受け取るまでは1回分にまとまる.
+ * wait() から戻って次に wait() を呼び出すまでの時間(イベント処理の時間)の最大値を計測する.
+ * この間メインループは他のイベントを処理できないため、応答遅れの上限の目安となる.
+ */
+class event_loop{
+private:
+  volatile uint32_t pending_;
+
+  uint32_t window_start_us_;  // アイドル率の計測開始時刻(us_ticker)
+  uint32_t idle_us_;          // 計測開始からのスリープ時間[us]
+  uint32_t wakeups_;
+  uint32_t busy_start_us_;    // wait() から戻った時刻(us_ticker)
+  uint32_t busy_max_us_;      // イベント処理1回の最大時間[us]
+  bool busy_;                 // イベント処理中(wait() から戻った後)
+
+public:
+  event_loop() :
+    pending_(0),
+    window_start_us_(0),
+    idle_us_(0),
+    wakeups_(0),
+    busy_start_us_(0),
+    busy_max_us_(0),
+    busy_(false)
+  {}
+
+  void post(uint32_t events);
+  uint32_t poll(void);
+  uint32_t wait(void);
+
+  /**
+   * @brief アイドル率[0.1%]
+   * reset_idle() からの経過時間に占めるスリープ時間の割合
+   */
+  uint32_t idle_permille(void) const;
+
+  /**
+   * @brief reset_idle() からの経過時間[us]
+   */
+  uint32_t window_us(void) const;
+
+  /**
+   * @brief reset_idle() からの復帰回数(割り込み毎)
+   */
+  uint32_t wakeups(void) const { return wakeups_; }
+
+  /**
+   * @brief reset_idle() からのイベント処理1回の最大時間[us](メインループの最大停止時間)
+   */
+  uint32_t busy_max_us(void) const { return busy_max_us_; }
+
+  void reset_idle(void);
+};
+
+} /* namespace */
+
+#endif /* defined(__MBED__) */
+
+#endif /* SEEKERS_MBED_EVENT_LOOP_HPP */
@@ -6,11 +6,30 @@
  * @par history
  * - 2016-11-04 08:14:42
  *  - first.
+ * - 2026-10-17 14:52:30
+ *  - フレーム受信モード(無通信時間でフレーム終端を検出)を追加.
+ * - 2026-10-17 15:30:02
+ *  - 送受信バッファを容量指定可能なSPSCリングへ変更. 送信を割り込み駆動へ変更.
+ * - 2026-10-17 16:02:11
+ *  - printf(), process_frame() を一括送信へ変更.
+ * - 2026-10-17 16:58:44
+ *  - weデサート時間を整数[us]化. 送信完了(TEMT)検出によるデサートと、ターンアラウンド統計を追加.
+ * - 2026-10-17 17:20:06
+ *  - フレーム受信モードの応答バッファを固定容量(frame_buff_t)へ変更.
+ * - 2026-10-17 21:05:40
+ *  - 受信通知 rx_attach() を追加.
+ * - 2026-10-17 22:10:31
+ *  - 受信時刻付きの受信(capture_attach())を追加.
+ * - 2026-10-17 23:59:05
+ *  - process_frame() 処理中の面を受信割り込みで上書きしないよう変更. 破棄フレーム数 frame_dropped() を追加.
+ * - 2026-10-17 23:59:30
+ *  - DMA転送による送受信(dma_attach())を追加.
  */
 
 #if defined(__MBED__)
 
 #include <cstdarg>
+#include <string.h>
 #include "mbed.h"
 #include "rs485serial.hpp"
 
@@ -21,16 +40,38 @@ namespace seekers{
 /**
  * @brief コンストラクタ
  */
-RS485Serial::RS485Serial(PinName tx, PinName rx, PinName we) :
+RS485Serial::RS485Serial(PinName tx, PinName rx, PinName we,
+                         uint8_t* rx_buff, size_t rx_size,
+                         uint8_t* tx_buff, size_t tx_size) :
   RawSerial(tx, rx),
   we_(we),
+  rx_buff_(rx_buff, rx_size),
+  tx_buff_(tx_buff, tx_size),
+  capture_(NULL),
+  tx_active_(false),
   auto_dessert_(true),
   baud_(9600),
   bit_length_(10),
-  we_time_( 0.0 )
+  we_time_us_(0),
+  bit_time_us_(0),
+  we_release_(WE_RELEASE_TIMER),
+  tx_empty_at_(0),
+  turnaround_last_us_(0),
+  turnaround_max_us_(0),
+  turnaround_count_(0),
+  frame_fill_(0),
+  frame_len_(0),
+  frame_ready_(NULL),
+  frame_ready_len_(0),
+  frame_held_(false),
+  frame_dropped_(0),
+  frame_mode_(false),
+  frame_gap_us_(0),
+  frame_module_(NULL),
+  dma_(NULL),
+  dma_tx_len_(0)
 {
   we_ = 0;
-  RawSerial::attach( callback(this, &RS485Serial::tx_handler_), Serial::TxIrq);
   RawSerial::attach( callback(this, &RS485Serial::rx_handler_), Serial::RxIrq);
   update_we_time_();
 }
@@ -47,21 +88,62 @@ int RS485Serial::printf(const char* format, ...)
   va_end(arg);
   if(0 >= n) return n;
 
-  for(int ii = 0; ii < n; ++ii)
-    putc(buff[ii]);
-
+  write((const uint8_t*)buff, n);
   return n;
 }
 
+/**
+ * @brief 送信開始
+ * 送信割り込みが停止していれば1文字目を送出して送信割り込みを有効にする.
+ * DMA転送時は tx_buff_ の先頭から連続した領域をDMAで送出する.
+ */
+void RS485Serial::tx_start_(void)
+{
+  core_util_critical_section_enter();
+  if(!tx_active_ && NULL != dma_){
+    size_t size = 0;
+    const uint8_t* src = tx_buff_.peek(size);
+    if(0 < size){
+      tx_active_ = true;
+      dma_tx_len_ = size;
+      dma_->write(src, size);
+    }
+  }else if(!tx_active_){
+    uint8_t c = 0;
+    if(tx_buff_.pop(c)){
+      tx_active_ = true;
+      RawSerial::putc(c);
+      RawSerial::attach( callback(this, &RS485Serial::tx_handler_), Serial::TxIrq);
+    }
+  }
+  core_util_critical_section_exit();
+}
+
 /**
  * @brief 送信割り込みハンドラ
- * 送信割り込み後、タイマー割り込みを起動
+ * 送信バッファに残りがあれば次の文字を送出.
+ * 空なら送信割り込みを停止し、タイマー割り込みを起動.
+ * 送信割り込みは最終文字が送信シフトレジスタへ移った時点のため、デサートは1文字分後.
+ * WE_RELEASE_TXC では 1bit分早く起動し、送信完了を確認してからデサートする.
  */
 void RS485Serial::tx_handler_(RS485Serial* self)
 {
   self->we_timer_.detach();
+
+  uint8_t c = 0;
+  if(self->tx_buff_.pop(c)){
+    self->RawSerial::putc(c);
+    return;
+  }
+
+  self->RawSerial::attach( Callback<void()>(), Serial::TxIrq);
+  self->tx_active_ = false;
   if(self->auto_dessert_){
-    self->we_timer_.attach( callback(self, &RS485Serial::we_timer_handler_), self->we_time_ );
+    int us = self->we_time_us_;
+    if(WE_RELEASE_TXC == self->we_release_ && us > self->bit_time_us_)
+      us -= self->bit_time_us_;
+    self->tx_empty_at_ = us_ticker_read();
+    self->we_timer_.attach_us( callback(self, &RS485Serial::we_timer_handler_), us );
   }
 }
 
@@ -71,17 +153,285 @@ void RS485Serial::tx_handler_(RS485Serial* self)
  */
 void RS485Serial::rx_handler_(RS485Serial* self)
 {
+  basic_spsc_ring<rx_stamp_t>* capture = self->capture_;
+  const uint32_t now = (NULL != capture) ? us_ticker_read() : 0;  // 受信処理の前に取得する
   int c = self->getc_();
-  if(c >= 0 && !self->rx_buff_.full())
-    self->rx_buff_.push(c);
+  if(self->frame_mode_){
+    if(c >= 0 && self->frame_len_ < FRAMESIZE)
+      self->frame_buff_[self->frame_fill_][self->frame_len_++] = c;
+    self->frame_timer_.attach_us( callback(self, &RS485Serial::frame_timer_handler_), self->frame_gap_us_ );
+    return;
+  }
+  if(c >= 0){
+    if(NULL != capture){
+      rx_stamp_t stamp;
+      stamp.us = now;
+      stamp.c = (uint8_t)c;
+      capture->push(stamp);
+    }else{
+      self->rx_buff_.push((uint8_t)c);
+    }
+    if(self->rx_notify_)
+      self->rx_notify_();
+  }
+}
+
+/**
+ * @brief 受信通知の登録
+ * 受信バッファへ格納する毎に notify を割り込みコンテキストで呼び出す(event_loop::post() 等).
+ * フレーム受信モードでは呼び出さない(frame_attach() の notify を使用する).
+ */
+void RS485Serial::rx_attach(Callback<void()> notify)
+{
+  rx_notify_ = notify;
+}
+
+/**
+ * @brief 受信時刻付きの受信の開始/終了(NULL)
+ * 受信データを rx_buff_ の代わりに ring へ受信割り込みの時刻と共に格納する.
+ * ring が満杯なら破棄して ring の overrun() を加算する. フレーム受信モードでは使用しない.
+ * DMA転送時は受信時刻を得られないため、終了まで受信を受信割り込みへ戻す.
+ */
+void RS485Serial::capture_attach(basic_spsc_ring<rx_stamp_t>* ring)
+{
+  if(NULL != dma_ && (NULL == capture_) != (NULL == ring)){
+    if(NULL != ring){
+      dma_->stop();
+      RawSerial::attach( callback(this, &RS485Serial::rx_handler_), Serial::RxIrq);
+    }else{
+      RawSerial::attach( Callback<void()>(), Serial::RxIrq);
+      dma_->start();
+    }
+  }
+  capture_ = ring;
+}
+
+/**
+ * @brief DMA転送の開始/終了(NULL)
+ * 受信, フレーム受信モードのフレーム終端(受信アイドル), 送信を dma で行う.
+ * 受信データの通知(rx_attach())は受信アイドル時と受信バッファの半分毎、
+ * フレーム受信モードのフレームは frame_buff_ へ複写してから通知する.
+ * 送信が完了してから呼び出すこと.
+ */
+void RS485Serial::dma_attach(uart_dma_transport* dma)
+{
+  if(NULL != dma_){
+    dma_->stop();
+    dma_->frame_attach(NULL, NULL);
+    dma_->rx_attach(NULL, NULL);
+    dma_->tx_attach(NULL, NULL);
+  }
+
+  dma_ = dma;
+  if(NULL == dma_){
+    RawSerial::attach( callback(this, &RS485Serial::rx_handler_), Serial::RxIrq);
+    return;
+  }
+
+  dma_->frame_attach(&RS485Serial::dma_frame_handler_, this);
+  dma_->rx_attach(&RS485Serial::dma_rx_handler_, this);
+  dma_->tx_attach(&RS485Serial::dma_tx_handler_, this);
+  dma_->rx_idle_us(frame_gap_us_);
+  if(NULL == capture_){
+    RawSerial::attach( Callback<void()>(), Serial::RxIrq);
+    dma_->start();
+  }
+}
+
+/**
+ * @brief DMA受信アイドルハンドラ
+ * フレーム受信モードでは受信したフレームを受信中の面へ複写して受信完了とする.
+ */
+void RS485Serial::dma_frame_handler_(void* context, const uint8_t* data1, size_t size1, const uint8_t* data2, size_t size2)
+{
+  RS485Serial* self = static_cast<RS485Serial*>(context);
+  if(!self->frame_mode_){
+    if(self->rx_notify_)
+      self->rx_notify_();
+    return;
+  }
+
+  uint8_t* dst = self->frame_buff_[self->frame_fill_];
+  if(size1 > (size_t)FRAMESIZE) size1 = FRAMESIZE;
+  if(size2 > FRAMESIZE - size1) size2 = FRAMESIZE - size1;
+  memcpy(dst, data1, size1);
+  if(0 < size2)
+    memcpy(dst + size1, data2, size2);
+  self->frame_len_ = size1 + size2;
+  frame_complete_(self);
+}
+
+/**
+ * @brief DMA受信バッファ半分の受信
+ */
+void RS485Serial::dma_rx_handler_(void* context)
+{
+  RS485Serial* self = static_cast<RS485Serial*>(context);
+  if(!self->frame_mode_ && self->rx_notify_)
+    self->rx_notify_();
+}
+
+/**
+ * @brief DMA送信完了ハンドラ
+ * tx_buff_ に残りがあれば続けて送出する. 空なら送信完了(最終ビット送出済み)のため
+ * 直ちにweをデサートする.
+ */
+void RS485Serial::dma_tx_handler_(void* context)
+{
+  RS485Serial* self = static_cast<RS485Serial*>(context);
+  const uint32_t now = us_ticker_read();
+  self->tx_buff_.consume(self->dma_tx_len_);
+  self->dma_tx_len_ = 0;
+
+  size_t size = 0;
+  const uint8_t* src = self->tx_buff_.peek(size);
+  if(0 < size){
+    self->dma_tx_len_ = size;
+    self->dma_->write(src, size);
+    return;
+  }
+
+  self->tx_active_ = false;
+  if(self->auto_dessert_){
+    self->we_dessert();
+    self->turnaround_(us_ticker_read() - now);
+  }
+}
+
+/**
+ * @brief フレーム終端タイマハンドラ
+ */
+void RS485Serial::frame_timer_handler_(RS485Serial* self)
+{
+  frame_complete_(self);
+}
+
+/**
+ * @brief フレームの受信完了
+ * 受信中の面を受信完了とし、ハンドラへ通知する.
+ * 通知したフレームは、次のフレームの受信完了まで有効.
+ * basic_com_module 使用時、他方の面を process_frame() が処理中なら面を切り替えられないため
+ * 受信したフレームを破棄する. 未処理のフレームは新しいフレームで置き換える.
+ */
+void RS485Serial::frame_complete_(RS485Serial* self)
+{
+  if(0 == self->frame_len_) return;
+
+  if(self->frame_held_){
+    self->frame_len_ = 0;
+    self->frame_dropped_ = self->frame_dropped_ + 1;
+    return;
+  }
+
+  const uint8_t* frame = self->frame_buff_[self->frame_fill_];
+  const size_t size = self->frame_len_;
+  self->frame_fill_ ^= 1;
+  self->frame_len_ = 0;
+
+  if(NULL != self->frame_module_){
+    if(NULL != self->frame_ready_)
+      self->frame_dropped_ = self->frame_dropped_ + 1;
+    self->frame_ready_len_ = size;
+    self->frame_ready_ = frame;
+  }
+
+  if(self->frame_handler_)
+    self->frame_handler_(frame, size);
+  if(self->frame_notify_)
+    self->frame_notify_();
+}
+
+/**
+ * @brief フレーム受信モードの開始(コールバック)
+ * 最終受信から t3.5 経過した時点で、受信したフレームを割り込みコンテキストで
+ * handler へ渡す. readable()/getc() は使用できない.
+ */
+void RS485Serial::frame_attach(Callback<void(const uint8_t*, size_t)> handler)
+{
+  frame_detach();
+  frame_handler_ = handler;
+  frame_mode_ = true;
+}
+
+/**
+ * @brief フレーム受信モードの開始(basic_com_module)
+ * 受信完了時に notify を割り込みコンテキストで呼び出す(EventQueue::event() 等).
+ * process_frame() でフレームを module へ渡し、応答を送信する.
+ */
+void RS485Serial::frame_attach(basic_com_module* module, Callback<void()> notify)
+{
+  frame_detach();
+  frame_module_ = module;
+  frame_notify_ = notify;
+  frame_mode_ = true;
+}
+
+/**
+ * @brief フレーム受信モードの終了
+ */
+void RS485Serial::frame_detach(void)
+{
+  frame_mode_ = false;
+  frame_timer_.detach();
+  frame_handler_ = Callback<void(const uint8_t*, size_t)>();
+  frame_notify_ = Callback<void()>();
+  frame_module_ = NULL;
+  frame_len_ = 0;
+  frame_ready_ = NULL;
+  frame_held_ = false;
+}
+
+/**
+ * @brief 受信完了フレームを basic_com_module へ渡し、応答を送信
+ * 受信完了フレームの取り出しは割り込み禁止区間で行い、処理中(frame_held_)は
+ * 受信割り込みがその面へ切り替えないため、フレームを複写せずに渡す.
+ * @return 処理したフレーム数(0 or 1)
+ */
+int RS485Serial::process_frame(void)
+{
+  if(NULL == frame_module_) return 0;
+
+  core_util_critical_section_enter();
+  const uint8_t* frame = frame_ready_;
+  const size_t size = frame_ready_len_;
+  frame_ready_ = NULL;
+  frame_held_ = (NULL != frame);
+  core_util_critical_section_exit();
+  if(NULL == frame) return 0;
+
+  frame_tx_.clear();
+  frame_module_->recieve_frame(frame_tx_, frame, size);
+  frame_module_->idle(frame_tx_);
+  frame_held_ = false;
+
+  if(!frame_tx_.empty())
+    write(frame_tx_.data(), frame_tx_.size());
+  return 1;
 }
 
 /**
  * @brief weデサート用タイマハンドラ
+ * WE_RELEASE_TXC で送信が完了していなければ 1bit分後に再判定
  */
 void RS485Serial::we_timer_handler_(RS485Serial* self)
 {
+  if(WE_RELEASE_TXC == self->we_release_ && !self->tx_complete_()){
+    self->we_timer_.attach_us( callback(self, &RS485Serial::we_timer_handler_), self->bit_time_us_ );
+    return;
+  }
   self->we_dessert();
+  self->turnaround_(us_ticker_read() - self->tx_empty_at_);
+}
+
+/**
+ * @brief ターンアラウンド統計の更新
+ */
+void RS485Serial::turnaround_(uint32_t us)
+{
+  turnaround_last_us_ = us;
+  if(us > turnaround_max_us_)
+    turnaround_max_us_ = us;
+  turnaround_count_ = turnaround_count_ + 1;
 }
 
 } /* namespace */
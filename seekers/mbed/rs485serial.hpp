@@ -6,6 +6,26 @@
  * @par history
  * - 2016-11-04 07:57:06
  *  - First.
+ * - 2026-10-17 14:05:18
+ *  - 通信速度, 1文字のbit長の取得を追加.
+ * - 2026-10-17 14:52:30
+ *  - フレーム受信モード(無通信時間でフレーム終端を検出)を追加.
+ * - 2026-10-17 15:30:02
+ *  - 送受信バッファを容量指定可能なSPSCリングへ変更. 送信を割り込み駆動へ変更.
+ * - 2026-10-17 16:02:11
+ *  - 一括送受信 write(), read() を追加.
+ * - 2026-10-17 16:58:44
+ *  - weデサート時間を整数[us]化. 送信完了(TEMT)検出によるデサートと、ターンアラウンド統計を追加.
+ * - 2026-10-17 17:20:06
+ *  - フレーム受信モードの応答バッファを固定容量(frame_buff_t)へ変更.
+ * - 2026-10-17 21:05:40
+ *  - 受信通知 rx_attach() を追加.
+ * - 2026-10-17 22:10:31
+ *  - 受信時刻付きの受信(capture_attach())を追加.
+ * - 2026-10-17 23:59:05
+ *  - process_frame() 処理中の面を受信割り込みで上書きしないよう変更. 破棄フレーム数 frame_dropped() を追加.
+ * - 2026-10-17 23:59:30
+ *  - DMA転送による送受信(dma_attach())を追加.
  */
 
 #ifndef SEEKERS_MBED_RS485SERIAL_HPP
@@ -18,43 +38,110 @@
 #if defined(__MBED__)
 
 #include "mbed.h"
-#include "CircularBuffer.h"
+#include "../basic_com_module.hpp"
+#include "../spsc_ring.hpp"
+#include "../uart_dma.hpp"
 
 namespace seekers{
 
 /**
  * @brief RS485 半二重制御付きシリアル
+ * 送受信バッファの領域は派生クラス(RS485SerialT)が用意する.
+ * 受信は割り込みで rx_buff_ へ格納(満杯時は破棄して rx_overrun() を加算)、
+ * 送信は tx_buff_ へ格納して即座に戻り、送信割り込みで1文字ずつ送出する.
+ * dma_attach() 後は受信をDMAの循環バッファ、送信を tx_buff_ からのDMA転送で行い、
+ * 1byte毎の割り込みを発生させない(インターフェースは同じ).
  */
 class RS485Serial : public RawSerial
 {
+public:
+  /**
+   * @brief weデサートの契機
+   */
+  enum we_release_t{
+    WE_RELEASE_TIMER, ///< 最終文字の送信割り込みから1文字分の時間後
+    WE_RELEASE_TXC    ///< 送信完了(シフトレジスタ空)の検出後. 検出手段の無いターゲットでは WE_RELEASE_TIMER と同じ
+  };
+
+  /**
+   * @brief 受信時刻付きの受信データ
+   */
+  struct rx_stamp_t{
+    uint32_t us;  ///< 受信割り込み時刻(us_ticker)
+    uint8_t c;
+  };
+
 private:
-  static const int BUFSIZE = 64;
   static const int STDBUFSIZE = 64; // printf使用時のバッファサイズ(スタック消費量)
   DigitalOut we_;
   Timeout we_timer_;
 
-  CircularBuffer<uint8_t, BUFSIZE> rx_buff_; // 受信バッファ
+  basic_spsc_ring<uint8_t> rx_buff_; // 受信バッファ(生産者:受信割り込み)
+  basic_spsc_ring<uint8_t> tx_buff_; // 送信バッファ(消費者:送信割り込み)
+  Callback<void()> rx_notify_;
+  basic_spsc_ring<rx_stamp_t>* capture_;  // 受信時刻付きの受信先(NULLなら rx_buff_)
+  volatile bool tx_active_;          // 送信割り込み動作中
 
   bool auto_dessert_;
 
   int baud_;
   int bit_length_;
-  double we_time_;
+  int we_time_us_;        // 1文字の送信時間[us]
+  int bit_time_us_;       // 1bitの送信時間[us]
+  we_release_t we_release_;
+
+  // ターンアラウンド統計(最終文字の送信割り込みからweデサートまで)
+  uint32_t tx_empty_at_;  // 最終文字の送信割り込み時刻(us_ticker)
+  volatile uint32_t turnaround_last_us_;
+  volatile uint32_t turnaround_max_us_;
+  volatile uint32_t turnaround_count_;
+
+  // フレーム受信モード
+  static const int FRAMESIZE = 256;
+  Timeout frame_timer_;
+  uint8_t frame_buff_[2][FRAMESIZE];  // 受信中/受信完了の2面
+  int frame_fill_;                    // 受信中の面
+  size_t frame_len_;                  // 受信中のフレーム長
+  const uint8_t* volatile frame_ready_;  // 受信完了フレーム(未処理ならNULL以外)
+  volatile size_t frame_ready_len_;
+  volatile bool frame_held_;          // process_frame() が受信完了の面を処理中
+  volatile uint32_t frame_dropped_;   // 未処理/処理中のため破棄したフレーム数
+  bool frame_mode_;
+  int frame_gap_us_;
+  Callback<void(const uint8_t*, size_t)> frame_handler_;
+  basic_com_module* frame_module_;
+  Callback<void()> frame_notify_;
+  frame_buff_t frame_tx_;
+
+  // DMA転送(NULLなら割り込み駆動)
+  uart_dma_transport* dma_;
+  size_t dma_tx_len_;     // DMA送信中のbyte数(tx_buff_ の先頭から)
 
   static void we_timer_handler_(RS485Serial*);
   static void tx_handler_(RS485Serial*);
   static void rx_handler_(RS485Serial*);
+  static void frame_timer_handler_(RS485Serial*);
+  static void frame_complete_(RS485Serial*);
+  static void dma_frame_handler_(void* context, const uint8_t* data1, size_t size1, const uint8_t* data2, size_t size2);
+  static void dma_rx_handler_(void* context);
+  static void dma_tx_handler_(void* context);
 
   int getc_(void);
+  void tx_start_(void);
+  bool tx_complete_(void);
 
   void update_we_time_(void);
+  void turnaround_(uint32_t us);
 
   // method disable.
   void attach(Callback<void()>, IrqType);
 
-public:
-  RS485Serial(PinName tx = p9, PinName rx = p10, PinName we = p8);
+protected:
+  RS485Serial(PinName tx, PinName rx, PinName we,
+              uint8_t* rx_buff, size_t rx_size,
+              uint8_t* tx_buff, size_t tx_size);
 
+public:
   ~RS485Serial()
   {}
 
@@ -64,19 +151,112 @@ public:
   int getc(void);
   void putc(int c);
   int printf(const char* format, ...);
+  size_t write(const uint8_t* src, size_t size);
+  size_t read(uint8_t* dst, size_t size);
+
+  int baudrate(void) const { return baud_; }
+  int bit_length(void) const { return bit_length_; }
+
+  /**
+   * @brief 受信バッファ満杯による破棄数
+   */
+  uint32_t rx_overrun(void) const
+  {
+    return (NULL != dma_) ? dma_->rx_overrun() : rx_buff_.overrun();
+  }
+
+  void rx_attach(Callback<void()> notify);
+  void capture_attach(basic_spsc_ring<rx_stamp_t>* ring);
+  void dma_attach(uart_dma_transport* dma);
+
+  /**
+   * @brief DMA転送中の transport(割り込み駆動なら NULL)
+   */
+  uart_dma_transport* dma(void) const { return dma_; }
 
   void we_assert(bool auto_dessert = true);
   void we_dessert(void);
+
+  /**
+   * @brief weデサートの契機の変更
+   */
+  void we_release(we_release_t mode)
+  {
+    we_release_ = mode;
+  }
+
+  /**
+   * @brief ターンアラウンド時間[us]
+   * 最終文字の送信割り込み(DMA転送時は送信完了の通知)から、自動デサートまでの時間(前回値/最大値/回数)
+   */
+  uint32_t turnaround_us(void) const { return turnaround_last_us_; }
+  uint32_t turnaround_max_us(void) const { return turnaround_max_us_; }
+  uint32_t turnaround_count(void) const { return turnaround_count_; }
+  void reset_turnaround(void)
+  {
+    turnaround_last_us_ = turnaround_max_us_ = turnaround_count_ = 0;
+  }
+
+  void frame_attach(Callback<void(const uint8_t*, size_t)> handler);
+  void frame_attach(basic_com_module* module, Callback<void()> notify = Callback<void()>());
+  void frame_detach(void);
+  int process_frame(void);
+
+  /**
+   * @brief フレーム受信モード(basic_com_module)で破棄したフレーム数
+   * process_frame() の呼び出しが間に合わず、上書き又は破棄したフレームの数
+   */
+  uint32_t frame_dropped(void) const
+  {
+    return frame_dropped_ + ((NULL != dma_) ? dma_->frames_lost() : 0);
+  }
+
+  /**
+   * @brief フレーム終端とみなす無通信時間[us]の変更
+   * baud(), format() で t3.5 に再設定される
+   */
+  void frame_gap(int us)
+  {
+    frame_gap_us_ = us;
+    if(NULL != dma_)
+      dma_->rx_idle_us(us);
+  }
+};
+
+
+/**
+ * @brief RS485 半二重制御付きシリアル(バッファ容量指定)
+ * @tparam RXSIZE 受信バッファ容量(2のべき乗)
+ * @tparam TXSIZE 送信バッファ容量(2のべき乗)
+ */
+template <size_t RXSIZE = 256, size_t TXSIZE = 256>
+class RS485SerialT : public RS485Serial
+{
+private:
+  typedef char power_of_two_check[(0 == (RXSIZE & (RXSIZE - 1)) && 0 == (TXSIZE & (TXSIZE - 1))) ? 1 : -1];
+  uint8_t rx_storage_[RXSIZE];
+  uint8_t tx_storage_[TXSIZE];
+
+public:
+  RS485SerialT(PinName tx = p9, PinName rx = p10, PinName we = p8) :
+    RS485Serial(tx, rx, we, rx_storage_, RXSIZE, tx_storage_, TXSIZE)
+  {}
 };
 
 
 inline void RS485Serial::update_we_time_(void)
 {
-  we_time_ = ((double)bit_length_ * 1.0) / (double)baud_;
+  we_time_us_ = (bit_length_ * 1000000 + baud_ - 1) / baud_;
+  bit_time_us_ = (1000000 + baud_ - 1) / baud_;
+  frame_gap_us_ = (bit_length_ * 3500000 + baud_ - 1) / baud_; // t3.5
+  if(NULL != dma_)
+    dma_->rx_idle_us(frame_gap_us_);
 }
 
 inline int RS485Serial::readable(void)
 {
+  if(NULL != dma_)
+    return ( (0 < dma_->readable()) ? 1 : 0 );
   return ( (!rx_buff_.empty()) ? 1 : 0 );
 }
 
@@ -99,17 +279,49 @@ inline void RS485Serial::format(int bits, Parity parity, int stop)
 
 inline int RS485Serial::getc(void)
 {
-    if(rx_buff_.empty()) return -1;
-
     uint8_t b = 0;
-    rx_buff_.pop(b);
+    if(NULL != dma_){
+      if(0 == dma_->read(&b, 1)) return -1;
+      return b;
+    }
+    if(!rx_buff_.pop(b)) return -1;
     return b;
 }
 
 inline void RS485Serial::putc(int c)
 {
   we_assert();
-  RawSerial::putc(c);
+  while(tx_buff_.full())
+    ; // 送信割り込みによる空きを待つ
+  tx_buff_.push((uint8_t)c);
+  tx_start_();
+}
+
+/**
+ * @brief 一括送信
+ * 送信イネーブルのアサートは1度のみ. 送信バッファに空きが無い間のみ待つ.
+ * 送信イネーブルは最後の文字の送信後に解除される.
+ */
+inline size_t RS485Serial::write(const uint8_t* src, size_t size)
+{
+  we_assert();
+  size_t done = 0;
+  while(done < size){
+    done += tx_buff_.push(src + done, size - done);
+    tx_start_();
+  }
+  return size;
+}
+
+/**
+ * @brief 一括受信
+ * @return 受信バッファから取り出したbyte数(待たない)
+ */
+inline size_t RS485Serial::read(uint8_t* dst, size_t size)
+{
+  if(NULL != dma_)
+    return dma_->read(dst, size);
+  return rx_buff_.pop(dst, size);
 }
 
 inline void RS485Serial::we_assert(bool auto_dessert)
@@ -132,6 +344,18 @@ inline int RS485Serial::getc_(void)
   return RawSerial::getc();
 }
 
+/**
+ * @brief 送信完了(送信シフトレジスタ空)判定
+ */
+inline bool RS485Serial::tx_complete_(void)
+{
+#if defined(TARGET_LPC176X)
+  return 0 != (_serial.uart->LSR & (1 << 6)); // TEMT
+#else
+  return true; // 検出手段無し. タイマーのみで判断する
+#endif
+}
+
 } /* namespace */
 
 #endif /* __MBED__ */
@@ -0,0 +1,264 @@
+/**
+ * @file mbed/uart_dma_lpc176x.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:59:30
+ *  - first.
+ */
+
+#if defined(__MBED__) && defined(TARGET_LPC176X)
+
+#include "mbed.h"
+#include "uart_dma_lpc176x.hpp"
+
+namespace seekers{
+
+namespace{
+
+// GPDMA チャネル制御(DMACCControl)
+const uint32_t CONTROL_SI = 1u << 26;   // 転送元アドレスの加算
+const uint32_t CONTROL_DI = 1u << 27;   // 転送先アドレスの加算
+const uint32_t CONTROL_I  = 1u << 31;   // 転送完了割り込み
+
+// GPDMA チャネル設定(DMACCConfig)
+const uint32_t CONFIG_E   = 1u << 0;
+const uint32_t CONFIG_M2P = 1u << 11;
+const uint32_t CONFIG_P2M = 2u << 11;
+const uint32_t CONFIG_IE  = 1u << 14;
+const uint32_t CONFIG_ITC = 1u << 15;
+
+// UART FCR: FIFO有効 + DMAモード(受信トリガ1文字)
+const uint8_t FCR_FIFO_DMA = 0x01 | 0x08;
+const uint32_t LSR_TEMT = 1u << 6;
+
+} /* namespace */
+
+uart_dma_lpc176x* uart_dma_lpc176x::channels_[CHANNEL_NUM] = { NULL };
+
+/**
+ * @brief コンストラクタ
+ * @param uart 対象のUART(UART_0 〜 UART_3)
+ * @param rx_channel, tx_channel 使用するGPDMAチャネル(0 〜 7)
+ */
+uart_dma_lpc176x::uart_dma_lpc176x(UARTName uart, int rx_channel, int tx_channel) :
+  uart_((LPC_UART_TypeDef*)uart),
+  rx_request_(0),
+  tx_request_(0),
+  rx_channel_(rx_channel),
+  tx_channel_(tx_channel),
+  half_(0),
+  halves_(0),
+  rx_active_(false),
+  idle_us_(0),
+  idle_count_(0),
+  idle_armed_(false),
+  char_us_(1),
+  bit_us_(1),
+  tx_chars_(0)
+{
+  // DMA要求番号(UARTn Tx = 8 + 2n, Rx = 9 + 2n)
+  switch(uart){
+  case UART_0: tx_request_ = 8;  break;
+  case UART_1: tx_request_ = 10; break;
+  case UART_2: tx_request_ = 12; break;
+  default:     tx_request_ = 14; break;
+  }
+  rx_request_ = tx_request_ + 1;
+
+  LPC_SC->PCONP |= (1u << 29); // PCGPDMA
+  LPC_GPDMA->DMACConfig = 1;
+  LPC_SC->DMAREQSEL &= ~((1u << (tx_request_ - 8)) | (1u << (rx_request_ - 8))); // タイマではなくUART
+
+  channels_[rx_channel_] = this;
+  channels_[tx_channel_] = this;
+  NVIC_SetVector(DMA_IRQn, (uint32_t)&uart_dma_lpc176x::dma_irq_);
+  NVIC_EnableIRQ(DMA_IRQn);
+}
+
+uart_dma_lpc176x::~uart_dma_lpc176x()
+{
+  stop_rx();
+  channel_(tx_channel_)->DMACCConfig = 0;
+  temt_timer_.detach();
+  channels_[rx_channel_] = NULL;
+  channels_[tx_channel_] = NULL;
+}
+
+LPC_GPDMACH_TypeDef* uart_dma_lpc176x::channel_(int ch)
+{
+  return (LPC_GPDMACH_TypeDef*)(LPC_GPDMACH0_BASE + 0x20 * ch);
+}
+
+/**
+ * @brief 受信開始
+ * 受信バッファの前半/後半を指すLLIを互いに連結し、停止するまで書き込み続ける.
+ */
+void uart_dma_lpc176x::start_rx(uint8_t* rx_buff, size_t size)
+{
+  LPC_GPDMACH_TypeDef* ch = channel_(rx_channel_);
+  ch->DMACCConfig = 0;
+
+  half_ = size / 2;
+  const uint32_t control = half_ | CONTROL_DI | CONTROL_I; // 1byte幅, バースト1
+  rx_lli_[0].src = (uint32_t)&uart_->RBR;
+  rx_lli_[0].dst = (uint32_t)rx_buff;
+  rx_lli_[0].next = (uint32_t)&rx_lli_[1];
+  rx_lli_[0].control = control;
+  rx_lli_[1].src = (uint32_t)&uart_->RBR;
+  rx_lli_[1].dst = (uint32_t)(rx_buff + half_);
+  rx_lli_[1].next = (uint32_t)&rx_lli_[0];
+  rx_lli_[1].control = control;
+
+  LPC_GPDMA->DMACIntTCClear = 1u << rx_channel_;
+  LPC_GPDMA->DMACIntErrClr = 1u << rx_channel_;
+  ch->DMACCSrcAddr = rx_lli_[0].src;
+  ch->DMACCDestAddr = rx_lli_[0].dst;
+  ch->DMACCLLI = rx_lli_[0].next;
+  ch->DMACCControl = control;
+  halves_ = 0;
+
+  uart_->FCR = FCR_FIFO_DMA;
+  ch->DMACCConfig = CONFIG_E | (rx_request_ << 1) | CONFIG_P2M | CONFIG_IE | CONFIG_ITC;
+  rx_active_ = true;
+  idle_start_();
+}
+
+/**
+ * @brief 受信停止
+ */
+void uart_dma_lpc176x::stop_rx(void)
+{
+  idle_ticker_.detach();
+  channel_(rx_channel_)->DMACCConfig = 0;
+  rx_active_ = false;
+}
+
+/**
+ * @brief 受信開始からの累計byte数
+ * 半周の転送完了直後(割り込み処理前)は DMACIntTCStat で補正する.
+ */
+uint32_t uart_dma_lpc176x::rx_count(void)
+{
+  const uint32_t bit = 1u << rx_channel_;
+  uint32_t halves;
+  uint32_t remain;
+  bool pending;
+  for(;;){
+    core_util_critical_section_enter();
+    halves = halves_;
+    const uint32_t before = LPC_GPDMA->DMACIntTCStat & bit;
+    remain = channel_(rx_channel_)->DMACCControl & TRANSFER_MAX;
+    const uint32_t after = LPC_GPDMA->DMACIntTCStat & bit;
+    core_util_critical_section_exit();
+    pending = (0 != after);
+    if(before == after) break;
+  }
+  if(0 == remain)
+    return (halves + 1) * half_;  // 半周の終端(次のLLIの読み込み前)
+  if(pending)
+    ++halves;
+  return halves * half_ + (half_ - remain);
+}
+
+/**
+ * @brief 送信開始
+ */
+void uart_dma_lpc176x::start_tx(const uint8_t* src, size_t size)
+{
+  LPC_GPDMACH_TypeDef* ch = channel_(tx_channel_);
+  ch->DMACCConfig = 0;
+  LPC_GPDMA->DMACIntTCClear = 1u << tx_channel_;
+  LPC_GPDMA->DMACIntErrClr = 1u << tx_channel_;
+  ch->DMACCSrcAddr = (uint32_t)src;
+  ch->DMACCDestAddr = (uint32_t)&uart_->THR;
+  ch->DMACCLLI = 0;
+  ch->DMACCControl = (size & TRANSFER_MAX) | CONTROL_SI | CONTROL_I;
+  tx_chars_ = (size < 16) ? (int)size : 16;
+
+  uart_->FCR = FCR_FIFO_DMA;
+  ch->DMACCConfig = CONFIG_E | (tx_request_ << 6) | CONFIG_M2P | CONFIG_IE | CONFIG_ITC;
+}
+
+/**
+ * @brief 受信アイドルとみなす無通信時間[us]
+ * 1文字の時間(送信完了の確認周期)も t3.5 とみなして求める.
+ */
+void uart_dma_lpc176x::rx_idle_us(int us)
+{
+  idle_us_ = us;
+  char_us_ = (us * 2 + 6) / 7;
+  bit_us_ = (char_us_ + 9) / 10;
+  if(rx_active_)
+    idle_start_();
+}
+
+void uart_dma_lpc176x::idle_start_(void)
+{
+  idle_ticker_.detach();
+  idle_count_ = rx_count();
+  idle_armed_ = false;
+  if(0 < idle_us_)
+    idle_ticker_.attach_us(callback(this, &uart_dma_lpc176x::idle_handler_), (idle_us_ + 1) / 2);
+}
+
+/**
+ * @brief 受信アイドルの確認(idle_us_ / 2 周期)
+ */
+void uart_dma_lpc176x::idle_handler_(uart_dma_lpc176x* self)
+{
+  const uint32_t count = self->rx_count();
+  if(count != self->idle_count_){
+    self->idle_count_ = count;
+    self->idle_armed_ = true;
+  }else if(self->idle_armed_){
+    self->idle_armed_ = false;
+    if(NULL != self->transport_)
+      self->transport_->on_idle_line();
+  }
+}
+
+/**
+ * @brief 送信完了(LSR.TEMT)の確認
+ */
+void uart_dma_lpc176x::temt_handler_(uart_dma_lpc176x* self)
+{
+  if(0 == (self->uart_->LSR & LSR_TEMT)){
+    self->temt_timer_.attach_us(callback(self, &uart_dma_lpc176x::temt_handler_), self->bit_us_);
+    return;
+  }
+  if(NULL != self->transport_)
+    self->transport_->on_tx_complete();
+}
+
+/**
+ * @brief GPDMA 割り込み
+ * 受信: 半周毎の転送完了. 送信: FIFOへの書き込み完了(FIFO内の残りは送信完了で確認).
+ */
+void uart_dma_lpc176x::dma_irq_(void)
+{
+  const uint32_t tc = LPC_GPDMA->DMACIntTCStat;
+  const uint32_t err = LPC_GPDMA->DMACIntErrStat;
+  LPC_GPDMA->DMACIntTCClear = tc;
+  LPC_GPDMA->DMACIntErrClr = err;
+
+  for(int ch = 0; ch < CHANNEL_NUM; ++ch){
+    uart_dma_lpc176x* self = channels_[ch];
+    if(NULL == self || 0 == ((tc | err) & (1u << ch)))
+      continue;
+    if(ch == self->rx_channel_){
+      if(0 == (tc & (1u << ch)))
+        continue;
+      self->halves_ = self->halves_ + 1;
+      if(NULL != self->transport_)
+        self->transport_->on_rx_half();
+    }else if(ch == self->tx_channel_){
+      self->temt_timer_.attach_us(callback(self, &uart_dma_lpc176x::temt_handler_), self->char_us_ * self->tx_chars_);
+    }
+  }
+}
+
+} /* namespace */
+
+#endif /* defined(__MBED__) && defined(TARGET_LPC176X) */
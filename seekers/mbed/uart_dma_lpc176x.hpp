@@ -0,0 +1,92 @@
+/**
+ * @file mbed/uart_dma_lpc176x.hpp
+ * @brief DMA/UART 周辺機能(LPC176x)
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:59:30
+ *  - First.
+ */
+
+#ifndef SEEKERS_MBED_UART_DMA_LPC176X_HPP
+#define SEEKERS_MBED_UART_DMA_LPC176X_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#if defined(__MBED__) && defined(TARGET_LPC176X)
+
+#include "mbed.h"
+#include "../uart_dma.hpp"
+
+namespace seekers{
+
+/**
+ * @brief DMA/UART 周辺機能(LPC176x GPDMA)
+ * 受信: 受信バッファの前半/後半を指す2つのLLIを循環させるP2M転送. 各LLIの転送完了割り込みで
+ *       半周数を数え、累計byte数は 半周数 x size/2 + 転送済み数 で求める.
+ * 送信: M2P転送. 転送完了(FIFOへの書き込み完了)後、LSR.TEMT で送信完了を確認する.
+ * LPC176x のUARTには受信アイドル割り込みが無いため、rx_idle_us() の半分の周期で累計byte数を
+ * 確認し、1周期の間変化が無ければ受信アイドルとする(検出は無通信 t/2 〜 t).
+ * UART(mbed の RawSerial 等)の初期化, 通信速度の設定は別途行うこと. 受信割り込みは使用しない.
+ * start_tx() の size は 4095 以下, start_rx() の size は 8190 以下とする.
+ */
+class uart_dma_lpc176x : public uart_dma_port{
+private:
+  struct lli_t{
+    uint32_t src;
+    uint32_t dst;
+    uint32_t next;
+    uint32_t control;
+  };
+
+  static const int CHANNEL_NUM = 8;
+  static const size_t TRANSFER_MAX = 0xfff;
+  static uart_dma_lpc176x* channels_[CHANNEL_NUM];
+
+  LPC_UART_TypeDef* uart_;
+  int rx_request_;
+  int tx_request_;
+  int rx_channel_;
+  int tx_channel_;
+  lli_t rx_lli_[2];
+
+  uint32_t half_;               // 受信バッファの半分のbyte数
+  volatile uint32_t halves_;    // 受信した半周数
+  bool rx_active_;
+
+  Ticker idle_ticker_;
+  int idle_us_;
+  uint32_t idle_count_;         // 前回確認時の累計byte数
+  bool idle_armed_;             // 前回のアイドル検出後に受信あり
+
+  Timeout temt_timer_;
+  int char_us_;                 // 1文字の時間(受信アイドル時間 t3.5 から求める)
+  int bit_us_;                  // 送信完了の再確認の周期
+  int tx_chars_;                // 転送完了時に送信FIFOに残る文字数(最大16)
+
+  static LPC_GPDMACH_TypeDef* channel_(int ch);
+  static void dma_irq_(void);
+  static void idle_handler_(uart_dma_lpc176x*);
+  static void temt_handler_(uart_dma_lpc176x*);
+
+  void idle_start_(void);
+
+public:
+  uart_dma_lpc176x(UARTName uart, int rx_channel = 0, int tx_channel = 1);
+  ~uart_dma_lpc176x();
+
+  // uart_dma_port
+  void start_rx(uint8_t* rx_buff, size_t size);
+  void stop_rx(void);
+  uint32_t rx_count(void);
+  void start_tx(const uint8_t* src, size_t size);
+  void rx_idle_us(int us);
+};
+
+} /* namespace */
+
+#endif /* defined(__MBED__) && defined(TARGET_LPC176X) */
+
+#endif /* SEEKERS_MBED_UART_DMA_LPC176X_HPP */
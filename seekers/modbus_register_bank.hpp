@@ -0,0 +1,175 @@
+/**
+ * @file modbus_register_bank.hpp
+ * @brief MODBUS レジスタ領域
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 12:30:51
+ *  - First.
+ */
+
+#ifndef SEEKERS_MODBUS_REGISTER_BANK_HPP
+#define SEEKERS_MODBUS_REGISTER_BANK_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace seekers{
+
+/**
+ * @brief MODBUS レジスタ領域
+ * holding/input register, coil, discrete input を連続した配列として保持する.
+ * coil, discrete input は 8点/byte (LSB先頭) で格納する.
+ * 配列は呼び出し側が用意する(modbus_register_map 参照).
+ */
+class modbus_register_bank{
+private:
+  uint16_t* holding_;
+  size_t holding_size_;
+  uint16_t* input_;
+  size_t input_size_;
+  uint8_t* coil_;
+  size_t coil_size_;
+  uint8_t* discrete_;
+  size_t discrete_size_;
+
+public:
+  modbus_register_bank(
+    uint16_t* holding, size_t holding_size,
+    uint16_t* input, size_t input_size,
+    uint8_t* coil, size_t coil_size,
+    uint8_t* discrete, size_t discrete_size) :
+    holding_(holding),
+    holding_size_(holding_size),
+    input_(input),
+    input_size_(input_size),
+    coil_(coil),
+    coil_size_(coil_size),
+    discrete_(discrete),
+    discrete_size_(discrete_size)
+  {}
+
+  uint16_t* holding(void) { return holding_; }
+  size_t holding_size(void) const { return holding_size_; }
+  uint16_t* input(void) { return input_; }
+  size_t input_size(void) const { return input_size_; }
+  uint8_t* coil(void) { return coil_; }
+  size_t coil_size(void) const { return coil_size_; }
+  uint8_t* discrete(void) { return discrete_; }
+  size_t discrete_size(void) const { return discrete_size_; }
+
+  /**
+   * @brief 範囲判定
+   */
+  static bool in_range(size_t start, size_t cnt, size_t size)
+  {
+    return start < size && cnt <= size - start;
+  }
+
+  static bool getbit(const uint8_t* src, size_t idx)
+  {
+    return 0 != (src[idx >> 3] & (1 << (idx & 7)));
+  }
+
+  static void setbit(uint8_t* dst, size_t idx, bool on)
+  {
+    if(on)
+      dst[idx >> 3] |= (uint8_t)(1 << (idx & 7));
+    else
+      dst[idx >> 3] &= (uint8_t)~(1 << (idx & 7));
+  }
+
+  static void read_bits(uint8_t* dst, const uint8_t* src, size_t start, size_t cnt);
+  static void write_bits(uint8_t* dst, size_t start, const uint8_t* src, size_t cnt);
+  static void read_registers(uint8_t* dst, const uint16_t* src, size_t cnt);
+  static void write_registers(uint16_t* dst, const uint8_t* src, size_t cnt);
+};
+
+/**
+ * @brief bit列の取り出し
+ * src の start bit目から cnt bit を dst の先頭から詰めて格納する(応答データ形式)
+ */
+inline void modbus_register_bank::read_bits(uint8_t* dst, const uint8_t* src, size_t start, size_t cnt)
+{
+  const size_t bytes = (cnt + 7) >> 3;
+  const size_t shift = start & 7;
+  const size_t last = (start + cnt - 1) >> 3; // 参照する最終byte
+  src += start >> 3;
+  if(0 == shift){
+    for(size_t ii = 0; ii < bytes; ++ii)
+      dst[ii] = src[ii];
+  }else{
+    for(size_t ii = 0; ii < bytes; ++ii){
+      uint8_t b = (uint8_t)(src[ii] >> shift);
+      if((start >> 3) + ii + 1 <= last)
+        b |= (uint8_t)(src[ii + 1] << (8 - shift));
+      dst[ii] = b;
+    }
+  }
+  if(cnt & 7)
+    dst[bytes - 1] &= (uint8_t)((1 << (cnt & 7)) - 1);
+}
+
+/**
+ * @brief bit列の書き込み
+ * src(要求データ形式)の cnt bit を dst の start bit目から書き込む
+ */
+inline void modbus_register_bank::write_bits(uint8_t* dst, size_t start, const uint8_t* src, size_t cnt)
+{
+  for(size_t ii = 0; ii < cnt; ++ii)
+    setbit(dst, start + ii, getbit(src, ii));
+}
+
+/**
+ * @brief レジスタ値をビッグエンディアンで格納
+ */
+inline void modbus_register_bank::read_registers(uint8_t* dst, const uint16_t* src, size_t cnt)
+{
+  for(size_t ii = 0; ii < cnt; ++ii){
+    dst[ii * 2] = (uint8_t)(src[ii] >> 8);
+    dst[ii * 2 + 1] = (uint8_t)(src[ii]);
+  }
+}
+
+/**
+ * @brief ビッグエンディアンのデータをレジスタへ格納
+ */
+inline void modbus_register_bank::write_registers(uint16_t* dst, const uint8_t* src, size_t cnt)
+{
+  for(size_t ii = 0; ii < cnt; ++ii)
+    dst[ii] = (uint16_t)((src[ii * 2] << 8) | src[ii * 2 + 1]);
+}
+
+/**
+ * @brief 固定長のレジスタ領域
+ * @tparam NHOLD holding register 数
+ * @tparam NINPUT input register 数
+ * @tparam NCOIL coil 点数
+ * @tparam NDISCRETE discrete input 点数
+ */
+template <size_t NHOLD, size_t NINPUT, size_t NCOIL, size_t NDISCRETE>
+class modbus_register_map : public modbus_register_bank{
+private:
+  uint16_t holding_buff_[NHOLD ? NHOLD : 1];
+  uint16_t input_buff_[NINPUT ? NINPUT : 1];
+  uint8_t coil_buff_[NCOIL ? (NCOIL + 7) / 8 : 1];
+  uint8_t discrete_buff_[NDISCRETE ? (NDISCRETE + 7) / 8 : 1];
+
+public:
+  modbus_register_map() :
+    modbus_register_bank(holding_buff_, NHOLD, input_buff_, NINPUT, coil_buff_, NCOIL, discrete_buff_, NDISCRETE)
+  {
+    for(size_t ii = 0; ii < sizeof(holding_buff_) / sizeof(holding_buff_[0]); ++ii) holding_buff_[ii] = 0;
+    for(size_t ii = 0; ii < sizeof(input_buff_) / sizeof(input_buff_[0]); ++ii) input_buff_[ii] = 0;
+    for(size_t ii = 0; ii < sizeof(coil_buff_); ++ii) coil_buff_[ii] = 0;
+    for(size_t ii = 0; ii < sizeof(discrete_buff_); ++ii) discrete_buff_[ii] = 0;
+  }
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_REGISTER_BANK_HPP */
@@ -0,0 +1,301 @@
+/**
+ * @file modbus_rtu_analyzer.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 22:45:52
+ *  - first.
+ * - 2026-10-18 00:00:40
+ *  - request_length_(), response_length_() で最大長を超えるフレーム長を未対応として扱う.
+ */
+
+#include <string.h>
+#include "modbus_rtu_analyzer.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンストラクタ
+ */
+modbus_rtu_analyzer::modbus_rtu_analyzer() :
+  len_(0),
+  first_us_(0),
+  last_us_(0),
+  synced_(true),
+  pending_(false),
+  pending_slave_(0),
+  pending_function_(0),
+  pending_us_(0),
+  pending_entry_(NULL),
+  gap_us_(modbus_rtu_timing::t35_us(9600, 10)),
+  timeout_us_(500000),
+  entry_num_(0),
+  start_us_(0),
+  started_(false)
+{
+  reset();
+}
+
+/**
+ * @brief 集計の初期化
+ */
+void modbus_rtu_analyzer::reset(void)
+{
+  memset(index_, 0, sizeof(index_));
+  memset(entries_, 0, sizeof(entries_));
+  memset(crc_errors_, 0, sizeof(crc_errors_));
+  memset(&totals_, 0, sizeof(totals_));
+  entry_num_ = 0;
+  pending_ = false;
+  pending_entry_ = NULL;
+  started_ = false;
+  start_us_ = last_us_;
+}
+
+int modbus_rtu_analyzer::function_class_(uint8_t function)
+{
+  switch(function){
+  case 0x01: case 0x02: case 0x03: case 0x04: case 0x05: case 0x06:
+    return function - 1;
+  case 0x0f: return 6;
+  case 0x10: return 7;
+  case 0x17: return 8;
+  default:   return 9;
+  }
+}
+
+/**
+ * @brief フレーム長の上限の判定
+ * @return 最大長を超えていれば -1
+ */
+int modbus_rtu_analyzer::limit_length_(int length)
+{
+  return (length > MAX_FRAME_LENGTH) ? -1 : length;
+}
+
+/**
+ * @brief 要求のフレーム長
+ * @return 0: 判定にデータ不足, -1: 未対応の機能コード, 最大長超過
+ */
+int modbus_rtu_analyzer::request_length_(const uint8_t* data, size_t size)
+{
+  if(size < 2) return 0;
+  switch(data[1]){
+  case 0x01: case 0x02: case 0x03: case 0x04: case 0x05: case 0x06:
+    return 8;
+  case 0x0f: case 0x10:
+    return (size < 7) ? 0 : limit_length_(9 + data[6]);
+  case 0x17:
+    return (size < 11) ? 0 : limit_length_(13 + data[10]);
+  default:
+    return -1;
+  }
+}
+
+/**
+ * @brief 応答のフレーム長
+ * @return 0: 判定にデータ不足, -1: 未対応の機能コード, 最大長超過
+ */
+int modbus_rtu_analyzer::response_length_(const uint8_t* data, size_t size)
+{
+  if(size < 2) return 0;
+  if(0x80 & data[1]) return 5;
+  switch(data[1]){
+  case 0x01: case 0x02: case 0x03: case 0x04: case 0x17:
+    return (size < 3) ? 0 : limit_length_(5 + data[2]);
+  case 0x05: case 0x06: case 0x0f: case 0x10:
+    return 8;
+  default:
+    return -1;
+  }
+}
+
+/**
+ * @brief 集計表の参照. 未割り当てなら割り当てる
+ * @return 容量超過ならNULL
+ */
+modbus_rtu_analyzer::entry_t* modbus_rtu_analyzer::entry_(uint8_t slave, uint8_t function)
+{
+  uint8_t& index = index_[slave][function_class_(function)];
+  if(0 != index) return &entries_[index - 1];
+  if(entry_num_ == ENTRY_NUM) return NULL;
+
+  entry_t& e = entries_[entry_num_++];
+  e.slave = slave;
+  e.function = function;
+  e.response_min_us = 0xffffffff;
+  index = (uint8_t)entry_num_;
+  return &e;
+}
+
+/**
+ * @brief 受信データ
+ * @param us 受信時刻(RS485Serial::rx_stamp_t)
+ */
+void modbus_rtu_analyzer::put(uint32_t us, uint8_t c)
+{
+  if(!started_){
+    started_ = true;
+    start_us_ = us;
+    last_us_ = us;
+  }
+  idle(us);
+  ++totals_.bytes;
+
+  if(0 == len_) first_us_ = us;
+  if(len_ == sizeof(buff_)){
+    discard_();
+    first_us_ = us;
+  }
+  buff_[len_++] = c;
+  last_us_ = us;
+  parse_();
+}
+
+/**
+ * @brief 時間経過の判定
+ * t3.5 を超えて途切れた未完了のフレームを破棄し、応答待ちのタイムアウトを判定する.
+ */
+void modbus_rtu_analyzer::idle(uint32_t now_us)
+{
+  if(!started_) return;
+  if(0 != len_ && now_us - last_us_ > gap_us_){
+    discard_();
+    synced_ = true;
+  }
+  if(pending_ && now_us - pending_us_ > timeout_us_)
+    timeout_();
+}
+
+/**
+ * @brief 先頭から size byte を取り除く
+ */
+void modbus_rtu_analyzer::consume_(size_t size)
+{
+  len_ -= size;
+  memmove(buff_, buff_ + size, len_);
+}
+
+/**
+ * @brief フレームにならなかった受信データの破棄
+ */
+void modbus_rtu_analyzer::discard_(void)
+{
+  if(0 == len_) return;
+  if(synced_){
+    ++totals_.crc_errors;
+    ++crc_errors_[buff_[0]];
+  }
+  totals_.garbage += len_;
+  len_ = 0;
+}
+
+/**
+ * @brief フレームの切り出し
+ * 応答待ちのスレーブからなら応答, それ以外は要求として先に判定し、crcが一致しなければ他方で判定する.
+ * どちらにも一致しなければ1byte読み捨てて同期し直す.
+ */
+void modbus_rtu_analyzer::parse_(void)
+{
+  while(len_ >= 2){
+    const bool expect_response = pending_ && buff_[0] == pending_slave_
+      && (buff_[1] & 0x7f) == pending_function_;
+    int lengths[2];
+    lengths[0] = expect_response ? response_length_(buff_, len_) : request_length_(buff_, len_);
+    lengths[1] = expect_response ? request_length_(buff_, len_) : response_length_(buff_, len_);
+
+    bool need_more = false;
+    bool matched = false;
+    for(int ii = 0; ii < 2 && !matched; ++ii){
+      const int length = lengths[ii];
+      if(0 == length || (length > 0 && (size_t)length > len_)){
+        need_more = true;
+        continue;
+      }
+      if(length < 0 || 0 != crc16_ibm(buff_, length))
+        continue;
+
+      // フレームは最終文字の受信時点で完成する(末尾の受信時刻 = last_us_)
+      frame_(buff_, (0 == ii) == expect_response, first_us_, last_us_);
+      consume_(length);
+      first_us_ = last_us_;
+      synced_ = true;
+      matched = true;
+    }
+    if(matched) continue;
+    if(need_more) return;
+
+    // どちらの形式にも一致しない
+    if(synced_){
+      ++totals_.crc_errors;
+      ++crc_errors_[buff_[0]];
+      synced_ = false;
+    }
+    ++totals_.garbage;
+    consume_(1);
+  }
+}
+
+/**
+ * @brief 切り出したフレームの集計
+ */
+void modbus_rtu_analyzer::frame_(const uint8_t* frame, bool response, uint32_t first_us, uint32_t last_us)
+{
+  ++totals_.frames;
+  const uint8_t slave = frame[0];
+  const uint8_t function = frame[1] & 0x7f;
+
+  if(!response){
+    if(pending_)
+      timeout_();
+    if(0 == slave){
+      ++totals_.broadcasts;
+      return;
+    }
+    entry_t* e = entry_(slave, function);
+    if(NULL == e){
+      ++totals_.overflow;
+      return;
+    }
+    ++e->requests;
+    pending_ = true;
+    pending_slave_ = slave;
+    pending_function_ = function;
+    pending_us_ = last_us;
+    pending_entry_ = e;
+    return;
+  }
+
+  if(!pending_ || slave != pending_slave_ || function != pending_function_){
+    ++totals_.orphans;
+    return;
+  }
+  pending_ = false;
+  entry_t* e = pending_entry_;
+  if(0x80 & frame[1])
+    ++e->exceptions;
+  else
+    ++e->responses;
+
+  const uint32_t us = first_us - pending_us_;
+  if(us < e->response_min_us) e->response_min_us = us;
+  if(us > e->response_max_us) e->response_max_us = us;
+  e->response_sum_us += us;
+
+  uint32_t ms = us / 1000;
+  int bucket = 0;
+  while(0 != ms && bucket < HISTOGRAM_NUM - 1){
+    ms >>= 1;
+    ++bucket;
+  }
+  ++e->histogram[bucket];
+}
+
+void modbus_rtu_analyzer::timeout_(void)
+{
+  pending_ = false;
+  ++pending_entry_->timeouts;
+}
+
+} /* namespace */
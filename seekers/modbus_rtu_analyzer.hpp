@@ -0,0 +1,164 @@
+/**
+ * @file modbus_rtu_analyzer.hpp
+ * @brief MODBUS RTU 通信の受動解析
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 22:45:52
+ *  - First.
+ * - 2026-10-18 00:00:40
+ *  - フレーム長が最大長(MAX_FRAME_LENGTH)を超える場合は未対応の機能コードと同様に同期し直す.
+ */
+
+#ifndef SEEKERS_MODBUS_RTU_ANALYZER_HPP
+#define SEEKERS_MODBUS_RTU_ANALYZER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include "utils.hpp"
+#include "modbus_rtu_frame.hpp"
+
+namespace seekers{
+
+/**
+ * @brief MODBUS RTU 通信の受動解析
+ * バス上の受信データ(受信時刻付き)からフレームを切り出し、要求と応答を対応付けて
+ * スレーブ, 機能コード毎に集計する.
+ *  - フレーム長は機能コードから求める(要求/応答の形式は応答待ちの状態で判別し、crcで確認する).
+ *    t3.5 を超える無通信時間は常にフレームの区切りとする.
+ *    byte数の破損等でフレーム長が最大長(256byte)を超える場合は、未対応の機能コードと同様に
+ *    1byte読み捨てて同期し直す(後続のフレームを受信バッファ満杯まで待たない).
+ *  - 応答時間は要求の最終文字から応答の先頭文字までの受信時刻の差.
+ *  - 集計表は固定容量(ENTRY_NUM)で、スレーブ, 機能コードから索引表で O(1) に引く.
+ *    容量を超えた組は totals_t::overflow のみ数える.
+ */
+class modbus_rtu_analyzer{
+public:
+  static const int ENTRY_NUM = 32;
+  static const int HISTOGRAM_NUM = 12;  // [0]:1ms未満, [n]:2^(n-1)ms以上 2^n ms未満, [11]:1024ms以上
+
+  /**
+   * @brief スレーブ, 機能コード毎の集計
+   */
+  struct entry_t{
+    uint8_t slave;
+    uint8_t function;
+    uint32_t requests;
+    uint32_t responses;    ///< 正常応答
+    uint32_t exceptions;   ///< 例外応答
+    uint32_t timeouts;     ///< 応答無し
+    uint32_t response_min_us;
+    uint32_t response_max_us;
+    uint64_t response_sum_us;  ///< 応答(例外を含む)の応答時間の合計
+    uint32_t histogram[HISTOGRAM_NUM];
+  };
+
+  /**
+   * @brief 全体の集計
+   */
+  struct totals_t{
+    uint32_t frames;       ///< crcの一致したフレーム
+    uint32_t bytes;
+    uint32_t crc_errors;   ///< フレームとして切り出せなかった塊(crc不一致, 途切れ)
+    uint32_t garbage;      ///< 読み捨てたbyte数
+    uint32_t broadcasts;
+    uint32_t orphans;      ///< 要求と対応しない応答
+    uint32_t overflow;     ///< 集計表の容量超過で数えなかったフレーム
+  };
+
+private:
+  enum{
+    FUNCTION_CLASS_NUM = 10, // 0x01-0x06, 0x0f, 0x10, 0x17, その他
+    MAX_FRAME_LENGTH = 256   // RTU のフレームの最大長
+  };
+
+  uint8_t buff_[MAX_FRAME_LENGTH];
+  size_t len_;
+  uint32_t first_us_;   // buff_ 先頭の受信時刻
+  uint32_t last_us_;    // 最終受信時刻
+  bool synced_;         // 読み捨て中でない
+
+  // 応答待ちの要求
+  bool pending_;
+  uint8_t pending_slave_;
+  uint8_t pending_function_;
+  uint32_t pending_us_;   // 要求の最終文字の受信時刻
+  entry_t* pending_entry_;
+
+  uint32_t gap_us_;
+  uint32_t timeout_us_;
+
+  uint8_t index_[256][FUNCTION_CLASS_NUM];  // 集計表の番号 + 1(0: 未割り当て)
+  entry_t entries_[ENTRY_NUM];
+  int entry_num_;
+  uint32_t crc_errors_[256];  // スレーブ(先頭byte)毎
+  totals_t totals_;
+  uint32_t start_us_;
+  bool started_;
+
+  static int function_class_(uint8_t function);
+  static int limit_length_(int length);
+  static int request_length_(const uint8_t* data, size_t size);
+  static int response_length_(const uint8_t* data, size_t size);
+
+  entry_t* entry_(uint8_t slave, uint8_t function);
+  void parse_(void);
+  void consume_(size_t size);
+  void frame_(const uint8_t* frame, bool response, uint32_t first_us, uint32_t last_us);
+  void timeout_(void);
+  void discard_(void);
+
+public:
+  modbus_rtu_analyzer();
+
+  /**
+   * @brief 通信速度の設定. フレームの区切りとする無通信時間(t3.5)を求める
+   */
+  void timing(int baud, int bit_length)
+  {
+    gap_us_ = modbus_rtu_timing::t35_us(baud, bit_length);
+  }
+
+  /**
+   * @brief 応答無しとする時間[us](既定 500ms)
+   */
+  void response_limit(uint32_t us)
+  {
+    timeout_us_ = us;
+  }
+
+  void put(uint32_t us, uint8_t c);
+  void idle(uint32_t now_us);
+  void reset(void);
+
+  int entry_num(void) const { return entry_num_; }
+  const entry_t& entry(int index) const { return entries_[index]; }
+  const totals_t& totals(void) const { return totals_; }
+  uint32_t crc_errors(uint8_t slave) const { return crc_errors_[slave]; }
+
+  /**
+   * @brief 集計開始からの経過時間[us]
+   */
+  uint32_t elapsed_us(void) const { return last_us_ - start_us_; }
+
+  /**
+   * @brief 応答時間の度数分布の上限[ms](最後の区間は0)
+   */
+  static uint32_t histogram_limit_ms(int index)
+  {
+    return (index < HISTOGRAM_NUM - 1) ? (1u << index) : 0;
+  }
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_RTU_ANALYZER_HPP */
@@ -0,0 +1,194 @@
+/**
+ * @file modbus_rtu_frame.hpp
+ * @brief MODBUS RTU 受信フレーム組み立てバッファ
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 11:02:37
+ *  - First.
+ * - 2026-10-17 14:05:18
+ *  - 通信速度からt1.5/t3.5を求める modbus_rtu_timing を追加.
+ * - 2026-10-17 23:58:40
+ *  - seek()/consume() でのcrc再計算を止め、crc_check() で必要な分だけ計算する.
+ * - 2026-10-18 00:00:30
+ *  - append() でのcrc計算を止め crc_check() のみで計算する. append(), seek() に1byteの処理を追加.
+ */
+
+#ifndef SEEKERS_MODBUS_RTU_FRAME_HPP
+#define SEEKERS_MODBUS_RTU_FRAME_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <string.h>
+
+#include "utils.hpp"
+
+namespace seekers{
+
+/**
+ * @brief MODBUS RTU 文字間/フレーム間時間
+ * 通信速度と1文字のbit長(スタート + データ + パリティ + ストップ)から
+ * t1.5(文字間の許容時間), t3.5(フレーム間の無通信時間)を整数[us]で求める.
+ */
+struct modbus_rtu_timing{
+  static int char_us(int baud, int bit_length)
+  {
+    return (bit_length * 1000000 + baud - 1) / baud;
+  }
+
+  static int t15_us(int baud, int bit_length)
+  {
+    return (bit_length * 1500000 + baud - 1) / baud;
+  }
+
+  static int t35_us(int baud, int bit_length)
+  {
+    return (bit_length * 3500000 + baud - 1) / baud;
+  }
+};
+
+/**
+ * @brief MODBUS RTU 受信フレーム組み立てバッファ
+ * RTU最大フレーム長(256byte)の固定領域に受信データを追記し、先頭位置(head_)の
+ * 移動で頭出し・フレーム破棄を行う. ヒープは使用しない.
+ * 末尾に空きが無くなった時のみ未処理分を先頭へ詰める.
+ * crcは crc_check() で判定に必要な範囲のうち未計算の分だけ計算する(フレームが分割して
+ * 受信されても計算済みの範囲は再計算しない). 頭出し・破棄で先頭が移動した時は計算済みの
+ * 長さを0とするだけとし、頭出しで読み捨てる雑音のcrcは計算しない.
+ * 1byte毎の受信(RS485Serial のbyte単位の受信)では memcpy/memchr を介さずに処理する.
+ */
+class modbus_rtu_frame{
+public:
+  static const size_t CAPACITY = 256;
+
+private:
+  uint8_t buff_[CAPACITY];
+  size_t head_;
+  size_t tail_;
+
+  crc16_ibm_state crc_;  // 先頭からcrc_len_ byte分のcrc(crc_len_ が0なら未初期化)
+  size_t crc_len_;
+
+  void reset_crc_(void)
+  {
+    crc_len_ = 0;
+  }
+
+public:
+  modbus_rtu_frame() :
+    head_(0),
+    tail_(0),
+    crc_len_(0)
+  {}
+
+  const uint8_t* data(void) const
+  {
+    return buff_ + head_;
+  }
+
+  uint8_t operator[](size_t idx) const
+  {
+    return buff_[head_ + idx];
+  }
+
+  size_t size(void) const
+  {
+    return tail_ - head_;
+  }
+
+  bool empty(void) const
+  {
+    return head_ == tail_;
+  }
+
+  void clear(void)
+  {
+    head_ = tail_ = 0;
+    reset_crc_();
+  }
+
+  size_t append(const uint8_t* src, size_t size);
+  void seek(uint8_t adr);
+  void consume(size_t size);
+  bool crc_check(size_t frame_size);
+};
+
+/**
+ * @brief 受信データの追記
+ * @return 追記したbyte数(CAPACITYを超えた分は破棄)
+ */
+inline size_t modbus_rtu_frame::append(const uint8_t* src, size_t size)
+{
+  if(head_ == tail_)
+    head_ = tail_ = 0;
+
+  if(1 == size && tail_ < CAPACITY){
+    buff_[tail_++] = *src;
+    return 1;
+  }
+
+  if(tail_ + size > CAPACITY && head_ > 0){
+    const size_t n = tail_ - head_;
+    memmove(buff_, buff_ + head_, n);
+    head_ = 0;
+    tail_ = n;
+  }
+
+  if(tail_ + size > CAPACITY)
+    size = CAPACITY - tail_;
+
+  memcpy(buff_ + tail_, src, size);
+  tail_ += size;
+  return size;
+}
+
+/**
+ * @brief 頭出し
+ * 先頭がadrとなるまでデータを読み捨てる
+ */
+inline void modbus_rtu_frame::seek(uint8_t adr)
+{
+  if(head_ == tail_ || buff_[head_] == adr)
+    return;
+
+  reset_crc_();
+  if(tail_ - head_ == 1){
+    head_ = tail_;
+    return;
+  }
+  const uint8_t* p = (const uint8_t*)memchr(buff_ + head_, adr, tail_ - head_);
+  head_ = (NULL == p) ? tail_ : (size_t)(p - buff_);
+}
+
+/**
+ * @brief 先頭からsize byteを破棄
+ */
+inline void modbus_rtu_frame::consume(size_t size)
+{
+  head_ += (size < tail_ - head_) ? size : tail_ - head_;
+  reset_crc_();
+}
+
+/**
+ * @brief 先頭からframe_size byte(crc含む)のcrc判定
+ * 前回の判定から先頭が移動していなければ、計算済みの範囲は再計算しない.
+ */
+inline bool modbus_rtu_frame::crc_check(size_t frame_size)
+{
+  if(frame_size > size())
+    return false;
+
+  if(0 == crc_len_ || crc_len_ > frame_size){
+    crc_.init();
+    crc_len_ = 0;
+  }
+  crc_.update(buff_ + head_ + crc_len_, frame_size - crc_len_);
+  crc_len_ = frame_size;
+  return crc_.residue_ok();
+}
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_RTU_FRAME_HPP */
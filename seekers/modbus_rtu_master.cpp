@@ -6,6 +6,28 @@
  * @par history
  * - 2016-11-05 09:45:10
  *  - first.
+ * - 2026-10-17 10:21:03
+ *  - 受信データのcrcを逐次計算するよう変更.
+ * - 2026-10-17 11:02:37
+ *  - 受信バッファをmodbus_rtu_frameへ変更.
+ * - 2026-10-17 13:20:44
+ *  - 0x02-0x04 読み出し要求に対応.
+ * - 2026-10-17 14:05:18
+ *  - フレーム終端を通信速度から求めたt3.5のタイムアウトで判定するよう変更.
+ * - 2026-10-17 14:52:30
+ *  - recieve_frame() に対応.
+ * - 2026-10-17 17:48:31
+ *  - 0x05/0x06/0x0f/0x10/0x17 要求に対応. 応答をレジスタ列/bit列の参照で渡すハンドラを追加.
+ * - 2026-10-17 20:32:07
+ *  - PDU からの要求 request_pdu() を追加.
+ * - 2026-10-17 23:58:06
+ *  - デバッグ出力(debug_.printf)を trace_log への記録へ変更.
+ * - 2026-10-17 23:59:40
+ *  - handler_type_() の戻り値を handler_type_t へ変更. 未対応の機能コードの応答はハンドラを引かずに破棄する.
+ * - 2026-10-17 23:59:55
+ *  - 応答/タイムアウトを要求元(client)のハンドラへ渡すよう変更.
+ * - 2026-10-18 00:00:20
+ *  - 要求元の指定(client_)を1要求毎に解除する.
  */
 
 #include "mbed.h"
@@ -14,12 +36,12 @@
 namespace seekers{
 
 /**
- * @brief readcoilstatus要求フレームを生成
+ * @brief 読み出し要求フレーム(0x01-0x04)を生成
  */
-void modbus::request_readcoilstatus(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt)
+void modbus::request_read(std::vector<uint8_t>& dst, uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t reg_cnt)
 {
   uint8_t data[8] = {
-    slave, 0x01,
+    slave, cmd,
     (uint8_t)(reg_adr >> 8), (uint8_t)(reg_adr),
     (uint8_t)(reg_cnt >> 8), (uint8_t)(reg_cnt)
   };
@@ -29,37 +51,341 @@ void modbus::request_readcoilstatus(std::vector<uint8_t>& dst, uint8_t slave, ui
   dst.insert(dst.end(), data, data + 8);
 }
 
+/**
+ * @brief readcoilstatus要求フレームを生成
+ */
+void modbus::request_readcoilstatus(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt)
+{
+  request_read(dst, slave, 0x01, reg_adr, reg_cnt);
+}
+
+/**
+ * @brief dst[pos]以降のフレームへcrcを付加
+ */
+void modbus::append_crc(std::vector<uint8_t>& dst, size_t pos)
+{
+  const uint16_t crc = crc16_ibm(&dst[pos], dst.size() - pos);
+  dst.push_back(0xFF & crc);
+  dst.push_back(0xFF & (crc >> 8));
+}
+
+/**
+ * @brief forcesinglecoil要求フレーム(0x05)を生成
+ */
+void modbus::request_forcesinglecoil(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, bool value)
+{
+  request_read(dst, slave, 0x05, reg_adr, value ? 0xff00 : 0x0000);
+}
+
+/**
+ * @brief presetsingleregister要求フレーム(0x06)を生成
+ */
+void modbus::request_presetsingleregister(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t value)
+{
+  request_read(dst, slave, 0x06, reg_adr, value);
+}
+
+/**
+ * @brief forcemultiplecoils要求フレーム(0x0f)を生成
+ * @param values 書き込むbit列(LSB first)
+ * @return 書き込み数が範囲外(1-1968)ならfalse
+ */
+bool modbus::request_forcemultiplecoils(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt, const uint8_t* values)
+{
+  if(reg_cnt < 1 || reg_cnt > 1968) return false;
+
+  const size_t pos = dst.size();
+  const uint8_t data_byte = (reg_cnt + 7) / 8;
+  const uint8_t head[7] = {
+    slave, 0x0f,
+    (uint8_t)(reg_adr >> 8), (uint8_t)(reg_adr),
+    (uint8_t)(reg_cnt >> 8), (uint8_t)(reg_cnt),
+    data_byte
+  };
+  dst.insert(dst.end(), head, head + 7);
+  dst.insert(dst.end(), values, values + data_byte);
+  if(0 != (reg_cnt & 7))
+    dst.back() &= (1 << (reg_cnt & 7)) - 1; // 余りbitは0
+  append_crc(dst, pos);
+  return true;
+}
+
+/**
+ * @brief presetmultipleregisters要求フレーム(0x10)を生成
+ * @return 書き込み数が範囲外(1-123)ならfalse
+ */
+bool modbus::request_presetmultipleregisters(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt, const uint16_t* values)
+{
+  if(reg_cnt < 1 || reg_cnt > 123) return false;
+
+  const size_t pos = dst.size();
+  const uint8_t head[7] = {
+    slave, 0x10,
+    (uint8_t)(reg_adr >> 8), (uint8_t)(reg_adr),
+    (uint8_t)(reg_cnt >> 8), (uint8_t)(reg_cnt),
+    (uint8_t)(reg_cnt * 2)
+  };
+  dst.insert(dst.end(), head, head + 7);
+  for(uint16_t ii = 0; ii < reg_cnt; ++ii){
+    dst.push_back((uint8_t)(values[ii] >> 8));
+    dst.push_back((uint8_t)(values[ii]));
+  }
+  append_crc(dst, pos);
+  return true;
+}
+
+/**
+ * @brief readwritemultipleregisters要求フレーム(0x17)を生成
+ * @return 読み出し数(1-125), 書き込み数(1-121)が範囲外ならfalse
+ */
+bool modbus::request_readwritemultipleregisters(std::vector<uint8_t>& dst, uint8_t slave,
+                                                uint16_t read_adr, uint16_t read_cnt,
+                                                uint16_t write_adr, uint16_t write_cnt, const uint16_t* values)
+{
+  if(read_cnt < 1 || read_cnt > 125) return false;
+  if(write_cnt < 1 || write_cnt > 121) return false;
+
+  const size_t pos = dst.size();
+  const uint8_t head[11] = {
+    slave, 0x17,
+    (uint8_t)(read_adr >> 8), (uint8_t)(read_adr),
+    (uint8_t)(read_cnt >> 8), (uint8_t)(read_cnt),
+    (uint8_t)(write_adr >> 8), (uint8_t)(write_adr),
+    (uint8_t)(write_cnt >> 8), (uint8_t)(write_cnt),
+    (uint8_t)(write_cnt * 2)
+  };
+  dst.insert(dst.end(), head, head + 11);
+  for(uint16_t ii = 0; ii < write_cnt; ++ii){
+    dst.push_back((uint8_t)(values[ii] >> 8));
+    dst.push_back((uint8_t)(values[ii]));
+  }
+  append_crc(dst, pos);
+  return true;
+}
+
 
 /**
  * @brief 応答ハンドラを設定
  */
-void modbus_rtu_master::sethandler(response_handler_t handler, handler_type_t handler_type)
+void modbus_rtu_master::client::sethandler(response_handler_t handler, handler_type_t handler_type)
 {
-  switch(handler_type)
-  {
-  case READCOILSTATUS:
-    readcoilstatus_handler_ = handler;
-    break;
-  case EXCEPTIONRESPONSE:
-    exceptionresponse_handler_ = handler;
-    break;
+  if(handler_type < HANDLER_TYPE_NUM)
+    handlers_[handler_type].response = handler;
+}
+
+/**
+ * @brief bit列の読み出し応答ハンドラを設定(READCOILSTATUS, READINPUTSTATUS)
+ */
+void modbus_rtu_master::client::sethandler(bits_handler_t handler, handler_type_t handler_type)
+{
+  if(handler_type < HANDLER_TYPE_NUM)
+    handlers_[handler_type].bits = handler;
+}
+
+/**
+ * @brief レジスタ列の読み出し応答ハンドラを設定(READHOLDINGREGISTER, READINPUTREGISTER, READWRITEMULTIPLEREGISTERS)
+ */
+void modbus_rtu_master::client::sethandler(registers_handler_t handler, handler_type_t handler_type)
+{
+  if(handler_type < HANDLER_TYPE_NUM)
+    handlers_[handler_type].registers = handler;
+}
+
+/**
+ * @brief 書き込み応答ハンドラを設定(FORCESINGLECOIL, PRESETSINGLEREGISTER, FORCEMULTIPLECOILS, PRESETMULTIPLEREGISTERS)
+ */
+void modbus_rtu_master::client::sethandler(write_handler_t handler, handler_type_t handler_type)
+{
+  if(handler_type < HANDLER_TYPE_NUM)
+    handlers_[handler_type].write = handler;
+}
+
+/**
+ * @brief 機能コードに対応するハンドラ種別
+ * @return 未対応の機能コードは HANDLER_TYPE_NUM
+ */
+modbus_rtu_master::handler_type_t modbus_rtu_master::handler_type_(uint8_t cmd)
+{
+  switch(cmd){
+  case 0x01: return READCOILSTATUS;
+  case 0x02: return READINPUTSTATUS;
+  case 0x03: return READHOLDINGREGISTER;
+  case 0x04: return READINPUTREGISTER;
+  case 0x05: return FORCESINGLECOIL;
+  case 0x06: return PRESETSINGLEREGISTER;
+  case 0x0f: return FORCEMULTIPLECOILS;
+  case 0x10: return PRESETMULTIPLEREGISTERS;
+  case 0x17: return READWRITEMULTIPLEREGISTERS;
   }
+  return HANDLER_TYPE_NUM;
 }
 
 /**
- * @brief readcoilstatus要求フレームを生成、応答待ち状態への遷移
+ * @brief 応答待ち状態への遷移
+ * ブロードキャスト(slave = 0)は応答が無いため遷移しない.
+ * 応答/タイムアウトは setclient() で指定された要求元へ渡す. 指定はこの要求のみ有効.
  */
-void modbus_rtu_master::request_readcoilstatus(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt)
+void modbus_rtu_master::wait_response_(uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t reg_cnt)
 {
-  modbus::request_readcoilstatus(dst, slave, reg_adr, reg_cnt);
+  client* const owner = client_;
+  client_ = &own_;
+  if(0 == slave) return;
 
+  tgt_client_ = owner;
   tgt_slave_ = slave;
-  tgt_cmd_ = 0x01;
+  tgt_cmd_ = cmd;
+  tgt_adr_ = reg_adr;
+  tgt_cnt_ = reg_cnt;
   stat_ = STAT_WAIT_FOR_REQUEST;
+  rx_frame_.clear();
   response_timer_.start();
   response_timer_.reset();
 }
 
+/**
+ * @brief 要求フレームを生成しない場合の要求元の指定の解除
+ * @return false
+ */
+bool modbus_rtu_master::reject_(void)
+{
+  client_ = &own_;
+  return false;
+}
+
+/**
+ * @brief 読み出し要求フレーム(0x01-0x04)を生成、応答待ち状態への遷移
+ */
+void modbus_rtu_master::request_read(std::vector<uint8_t>& dst, uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t reg_cnt)
+{
+  modbus::request_read(dst, slave, cmd, reg_adr, reg_cnt);
+  wait_response_(slave, cmd, reg_adr, reg_cnt);
+}
+
+/**
+ * @brief readcoilstatus要求フレームを生成、応答待ち状態への遷移
+ */
+void modbus_rtu_master::request_readcoilstatus(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt)
+{
+  request_read(dst, slave, 0x01, reg_adr, reg_cnt);
+}
+
+/**
+ * @brief readinputstatus要求フレームを生成、応答待ち状態への遷移
+ */
+void modbus_rtu_master::request_readinputstatus(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt)
+{
+  request_read(dst, slave, 0x02, reg_adr, reg_cnt);
+}
+
+/**
+ * @brief readholdingregister要求フレームを生成、応答待ち状態への遷移
+ */
+void modbus_rtu_master::request_readholdingregister(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt)
+{
+  request_read(dst, slave, 0x03, reg_adr, reg_cnt);
+}
+
+/**
+ * @brief readinputregister要求フレームを生成、応答待ち状態への遷移
+ */
+void modbus_rtu_master::request_readinputregister(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt)
+{
+  request_read(dst, slave, 0x04, reg_adr, reg_cnt);
+}
+
+/**
+ * @brief forcesinglecoil要求フレームを生成、応答待ち状態への遷移
+ */
+void modbus_rtu_master::request_forcesinglecoil(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, bool value)
+{
+  modbus::request_forcesinglecoil(dst, slave, reg_adr, value);
+  wait_response_(slave, 0x05, reg_adr, value ? 0xff00 : 0x0000);
+}
+
+/**
+ * @brief presetsingleregister要求フレームを生成、応答待ち状態への遷移
+ */
+void modbus_rtu_master::request_presetsingleregister(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t value)
+{
+  modbus::request_presetsingleregister(dst, slave, reg_adr, value);
+  wait_response_(slave, 0x06, reg_adr, value);
+}
+
+/**
+ * @brief forcemultiplecoils要求フレームを生成、応答待ち状態への遷移
+ */
+bool modbus_rtu_master::request_forcemultiplecoils(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt, const uint8_t* values)
+{
+  if(!modbus::request_forcemultiplecoils(dst, slave, reg_adr, reg_cnt, values))
+    return reject_();
+  wait_response_(slave, 0x0f, reg_adr, reg_cnt);
+  return true;
+}
+
+/**
+ * @brief presetmultipleregisters要求フレームを生成、応答待ち状態への遷移
+ */
+bool modbus_rtu_master::request_presetmultipleregisters(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt, const uint16_t* values)
+{
+  if(!modbus::request_presetmultipleregisters(dst, slave, reg_adr, reg_cnt, values))
+    return reject_();
+  wait_response_(slave, 0x10, reg_adr, reg_cnt);
+  return true;
+}
+
+/**
+ * @brief readwritemultipleregisters要求フレームを生成、応答待ち状態への遷移
+ * 応答は読み出し側(read_adr, read_cnt)
+ */
+bool modbus_rtu_master::request_readwritemultipleregisters(std::vector<uint8_t>& dst, uint8_t slave,
+                                                           uint16_t read_adr, uint16_t read_cnt,
+                                                           uint16_t write_adr, uint16_t write_cnt, const uint16_t* values)
+{
+  if(!modbus::request_readwritemultipleregisters(dst, slave, read_adr, read_cnt, write_adr, write_cnt, values))
+    return reject_();
+  wait_response_(slave, 0x17, read_adr, read_cnt);
+  return true;
+}
+
+/**
+ * @brief PDU(機能コード + データ)から要求フレームを生成、応答待ち状態への遷移
+ * 応答の照合に用いるアドレス/数は PDU から取り出す.
+ * @return 未対応の機能コード, PDU長が機能コードと一致しなければfalse
+ */
+bool modbus_rtu_master::request_pdu(std::vector<uint8_t>& dst, uint8_t slave, const uint8_t* pdu, size_t size)
+{
+  if(size < 5) return reject_();
+
+  const uint8_t cmd = pdu[0];
+  size_t length = 5;
+  switch(cmd){
+  case 0x01: case 0x02: case 0x03: case 0x04:
+  case 0x05: case 0x06:
+    break;
+  case 0x0f: case 0x10:
+    if(size < 6) return reject_();
+    length = 6 + pdu[5];
+    break;
+  case 0x17:
+    if(size < 10) return reject_();
+    length = 10 + pdu[9];
+    break;
+  default:
+    return reject_();
+  }
+  if(size != length) return reject_();
+
+  const size_t pos = dst.size();
+  dst.push_back(slave);
+  dst.insert(dst.end(), pdu, pdu + size);
+  modbus::append_crc(dst, pos);
+
+  const uint16_t reg_adr = (pdu[1] << 8) | pdu[2];
+  const uint16_t reg_cnt = (pdu[3] << 8) | pdu[4];
+  wait_response_(slave, cmd, reg_adr, reg_cnt);
+  return true;
+}
+
 /**
  * @brief アイドル処理
  */
@@ -69,89 +395,83 @@ void modbus_rtu_master::idle(std::vector<uint8_t>& tx_buff)
 
   // 応答待ちタイムアウトを図る
   if( response_timer_.read_ms() >= response_limit_ ){
-    if(NULL != response_timeout_handler_)
-      response_timeout_handler_(this, tgt_slave_, tgt_cmd_);
-#ifndef NDEBUG
-    debug_.printf("[DEBUG] modubs_rtu_master::idle() response_timeout.\r\n");
-#endif
-    rx_buff_.clear();
+    if(NULL != tgt_client_->response_timeout_handler_)
+      tgt_client_->response_timeout_handler_(this, tgt_slave_, tgt_cmd_);
+    if(NULL != trace_)
+      trace_->put(TRACE_MASTER_IDLE_TIMEOUT, tgt_slave_, tgt_cmd_);
+    rx_frame_.clear();
     stat_ = STAT_HALT;
   }
 }
 
+/**
+ * @brief フレーム単位の受信処理
+ */
+void modbus_rtu_master::recieve_frame(std::vector<uint8_t>& tx_buff, const uint8_t* src, size_t size)
+{
+  recieve(tx_buff, src, size);
+  frame_timer_.detach();
+  frame_end_ = true;
+}
+
+/**
+ * @brief t3.5経過(フレーム終端)
+ */
+void modbus_rtu_master::frame_timer_handler_(modbus_rtu_master* self)
+{
+  self->frame_end_ = true;
+}
+
 /**
  * @brief 受信処理
  */
 void modbus_rtu_master::recieve(std::vector<uint8_t>& tx_buff, const uint8_t* src, size_t size)
 {
-  if(idle_timer_.read_ms() >= idle_limit_ ){
-    rx_buff_.clear();
+  if(frame_end_){
+    rx_frame_.clear();
   }
-  idle_timer_.reset();
-  rx_buff_.insert(rx_buff_.end(), src, src + size);
+  frame_end_ = false;
+  frame_timer_.attach_us(callback(this, &modbus_rtu_master::frame_timer_handler_), t35_us_);
+  rx_frame_.append(src, size);
 
   if(stat_ != STAT_WAIT_FOR_REQUEST)
     return;
 
   // 応答待ちタイムアウトを図る
   if( response_timer_.read_ms() >= response_limit_ ){
-    if(NULL != response_timeout_handler_)
-      response_timeout_handler_(this, tgt_slave_, tgt_cmd_);
-#ifndef NDEBUG
-    debug_.printf("[DEBUG] modubs_rtu_master::recieve() response_timeout.\r\n");
-#endif
-    rx_buff_.clear();
+    if(NULL != tgt_client_->response_timeout_handler_)
+      tgt_client_->response_timeout_handler_(this, tgt_slave_, tgt_cmd_);
+    if(NULL != trace_)
+      trace_->put(TRACE_MASTER_RECIEVE_TIMEOUT, tgt_slave_, tgt_cmd_);
+    rx_frame_.clear();
     stat_ = STAT_HALT;
   }
 
   // 頭出し
-  while( rx_buff_.size() > 1 && rx_buff_[0] != tgt_slave_ )
-    rx_buff_.erase(rx_buff_.begin());
+  rx_frame_.seek(tgt_slave_);
 
   // 最低フレームサイズ(adr + cmd + crc)より少なければ次
-  if(rx_buff_.size() < 4 )
+  if(rx_frame_.size() < 4 )
     return;
 
   bool request_result = false;
   switch(tgt_cmd_){
   case 0x01:
-    request_result = readcoilstatus_() | exceptionresponse_();
-    break;
-    /*
   case 0x02:
-    result_request = readholdingregister_() | exceptionresponse_();
-    break;
   case 0x03:
-    request_result = readinputregister_() | exceptionresponse_();
-    break;
   case 0x04:
-    request_result = forcesinglecoil_() | exceptionresponse_();
+  case 0x17:
+    request_result = readresponse_() | exceptionresponse_();
     break;
   case 0x05:
-    request_result = presetsingleregister_() | exceptionresponse_();
-    break;
   case 0x06:
-    request_result = diagnostics_() | exceptionresponse_();
-    break;
-  case 0x07:
-    request_result = fetchcommeventcounter_() | exceptionresponse_();
-    break;
-  case 0x08:
-    request_result = fetchcommeventlog_() | exceptionresponse_();
-    break;
-  case 0x09:
-    request_result = forcemultiplecoils_() | exceptionresponse_();
-    break;
+  case 0x0f:
   case 0x10:
-    request_result = presetmultipleregisters_() | exceptionresponse_();
-    break;
-  case 0x11:
-    request_result = reportslaveid_() | exceptionresponse_();
+    request_result = writeresponse_() | exceptionresponse_();
     break;
-    */
   }
   if(request_result){
-    rx_buff_.clear();
+    rx_frame_.clear();
     stat_ = STAT_HALT;
   }
 }
@@ -161,56 +481,103 @@ void modbus_rtu_master::recieve(std::vector<uint8_t>& tx_buff, const uint8_t* sr
  */
 bool modbus_rtu_master::exceptionresponse_(void)
 {
-  if(rx_buff_[1] != (0x80 | tgt_cmd_) ) return false;
-  if(rx_buff_.size() < 5 ) return false;
+  if(rx_frame_[1] != (0x80 | tgt_cmd_) ) return false;
+  if(rx_frame_.size() < 5 ) return false;
 
-  const uint16_t crc_src = rx_buff_[3] | (rx_buff_[4] << 8);
-  const uint16_t crc_calc = crc16(&rx_buff_[0], 3);
-
-  if(crc_src != crc_calc) {
-#ifndef NDEBUG
-    debug_.printf("[DEBUG] modbus_rtu_master exceptionresponse_(): crc error. src = %04xh calc = %04xh(%d)\r\n",crc_src, crc_calc);
-#endif
+  if(!rx_frame_.crc_check(3 + 2)) {
+    if(NULL != trace_)
+      trace_->put(TRACE_MASTER_EXCEPTION_CRC, rx_frame_[3] | (rx_frame_[4] << 8));
     return true;
   }
 
-  if(NULL != exceptionresponse_handler_)
-    exceptionresponse_handler_(this, &rx_buff_[0], 3 + 2);
+  if(NULL != tgt_client_->handlers_[EXCEPTIONRESPONSE].response)
+    tgt_client_->handlers_[EXCEPTIONRESPONSE].response(this, rx_frame_.data(), 3 + 2);
 
-#ifndef NDEBUG
-  debug_.printf("[DEBUG] modbus_rtu_master exceptionresponse_(): complate.\r\n");
-#endif
+  if(NULL != trace_)
+    trace_->put(TRACE_MASTER_EXCEPTION, tgt_slave_, rx_frame_[2]);
 
   return true;
 }
 
 /**
- * @brief readcoilstatus応答を対応
+ * @brief 読み出し応答(0x01-0x04, 0x17)を対応
+ * データbyte数が要求した数と一致しなければ破棄する(ハンドラを呼ばない).
  */
-bool modbus_rtu_master::readcoilstatus_(void)
+bool modbus_rtu_master::readresponse_(void)
 {
-  if(rx_buff_[1] != 0x01) return false;
-  if(rx_buff_.size() < 3 ) return false;
+  if(rx_frame_[1] != tgt_cmd_) return false;
+  if(rx_frame_.size() < 3 ) return false;
 
-  const size_t data_byte = rx_buff_[2];
-  if(rx_buff_.size() < (3 + 2 + data_byte)) return false;
+  const size_t data_byte = rx_frame_[2];
+  if(rx_frame_.size() < (3 + 2 + data_byte)) return false;
 
-  const uint16_t crc_src = rx_buff_[3 + data_byte] | (rx_buff_[3 + data_byte + 1] << 8);
-  const uint16_t crc_calc = crc16(&rx_buff_[0], 3 + data_byte);
+  if(!rx_frame_.crc_check(3 + data_byte + 2)) {
+    if(NULL != trace_)
+      trace_->put(TRACE_MASTER_READ_CRC, rx_frame_[3 + data_byte] | (rx_frame_[3 + data_byte + 1] << 8));
+    return true;
+  }
 
-  if(crc_src != crc_calc) {
-#ifndef NDEBUG
-    debug_.printf("[DEBUG] modbus_rtu_master readcoilstatus_(): crc error. src = %04xh calc = %04xh(%d)\r\n",crc_src, crc_calc);
-#endif
+  const bool bits = (tgt_cmd_ == 0x01 || tgt_cmd_ == 0x02);
+  if(data_byte != (bits ? (tgt_cnt_ + 7u) / 8 : tgt_cnt_ * 2u)){
+    if(NULL != trace_)
+      trace_->put(TRACE_MASTER_READ_COUNT, data_byte);
     return true;
   }
 
-  if(NULL != readcoilstatus_handler_)
-    readcoilstatus_handler_(this, &rx_buff_[0], 3 + data_byte + 2);
+  const handler_type_t type = handler_type_(tgt_cmd_);
+  if(HANDLER_TYPE_NUM == type)
+    return true; // 未対応の機能コード. 破棄
+
+  const client::handler_t& handler = tgt_client_->handlers_[type];
+  const uint8_t* frame = rx_frame_.data();
+  if(NULL != handler.response)
+    handler.response(this, frame, 3 + data_byte + 2);
+  if(bits && NULL != handler.bits)
+    handler.bits(this, tgt_slave_, tgt_adr_, modbus_bit_view(frame + 3, tgt_cnt_));
+  if(!bits && NULL != handler.registers)
+    handler.registers(this, tgt_slave_, tgt_adr_, modbus_register_view(frame + 3, tgt_cnt_));
+
+  if(NULL != trace_)
+    trace_->put(TRACE_MASTER_READ, tgt_slave_, tgt_cmd_);
+
+  return true;
+}
+
+/**
+ * @brief 書き込み応答(0x05, 0x06, 0x0f, 0x10)を対応
+ * 応答はアドレスと値(数)のエコー. 要求と一致しなければ破棄する(ハンドラを呼ばない).
+ */
+bool modbus_rtu_master::writeresponse_(void)
+{
+  if(rx_frame_[1] != tgt_cmd_) return false;
+  if(rx_frame_.size() < 8 ) return false;
+
+  if(!rx_frame_.crc_check(8)) {
+    if(NULL != trace_)
+      trace_->put(TRACE_MASTER_WRITE_CRC, rx_frame_[6] | (rx_frame_[7] << 8));
+    return true;
+  }
+
+  const uint16_t reg_adr = (rx_frame_[2] << 8) | rx_frame_[3];
+  const uint16_t value = (rx_frame_[4] << 8) | rx_frame_[5];
+  if(reg_adr != tgt_adr_ || value != tgt_cnt_){
+    if(NULL != trace_)
+      trace_->put(TRACE_MASTER_WRITE_ECHO, reg_adr, value);
+    return true;
+  }
+
+  const handler_type_t type = handler_type_(tgt_cmd_);
+  if(HANDLER_TYPE_NUM == type)
+    return true; // 未対応の機能コード. 破棄
+
+  const client::handler_t& handler = tgt_client_->handlers_[type];
+  if(NULL != handler.response)
+    handler.response(this, rx_frame_.data(), 8);
+  if(NULL != handler.write)
+    handler.write(this, tgt_slave_, tgt_cmd_, reg_adr, value);
 
-#ifndef NDEBUG
-  debug_.printf("[DEBUG] modbus_rtu_master readcoilstatus_(): complate.\r\n");
-#endif
+  if(NULL != trace_)
+    trace_->put(TRACE_MASTER_WRITE, tgt_slave_, tgt_cmd_);
 
   return true;
 }
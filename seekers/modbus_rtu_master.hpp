@@ -6,6 +6,33 @@
  * @par history
  * - 2016-11-05 08:41:11
  *  - First.
+ * - 2026-10-17 10:21:03
+ *  - 受信データのcrcを逐次計算するよう変更.
+ * - 2026-10-17 11:02:37
+ *  - 受信バッファをmodbus_rtu_frameへ変更.
+ * - 2026-10-17 13:20:44
+ *  - 0x02-0x04 読み出し要求に対応. スケジューラ向けに busy(), ready(), context を追加.
+ * - 2026-10-17 14:05:18
+ *  - フレーム終端を通信速度から求めたt3.5のタイムアウトで判定するよう変更.
+ * - 2026-10-17 14:52:30
+ *  - recieve_frame() に対応.
+ * - 2026-10-17 17:20:06
+ *  - basic_com_module の frame_buff_t 版を using で公開.
+ * - 2026-10-17 17:48:31
+ *  - 0x05/0x06/0x0f/0x10/0x17 要求に対応. 応答をレジスタ列/bit列の参照で渡すハンドラを追加.
+ * - 2026-10-17 19:48:20
+ *  - NDEBUG 定義時にコンストラクタがビルドできない不具合を修正.
+ * - 2026-10-17 20:32:07
+ *  - PDU からの要求 request_pdu() を追加(ゲートウェイ向け).
+ * - 2026-10-17 23:58:06
+ *  - デバッグ出力を trace_log への記録(settrace())へ変更. NDEBUG に関わらず記録する.
+ *    コンストラクタの debug は未使用(互換のため残す).
+ * - 2026-10-17 23:59:40
+ *  - handler_type_() の戻り値を handler_type_t へ変更.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラ, context を要求元(client)毎に持つよう変更. 応答は要求した client のハンドラへ渡す.
+ * - 2026-10-18 00:00:20
+ *  - setclient() の指定を次の1要求のみとする.
  */
 
 #ifndef SEEKERS_MODBUS_RTU_MASTER_HPP
@@ -24,6 +51,9 @@
 
 #include "utils.hpp"
 #include "basic_com_module.hpp"
+#include "modbus_rtu_frame.hpp"
+#include "modbus_view.hpp"
+#include "trace_log.hpp"
 
 namespace seekers{
 
@@ -34,7 +64,16 @@ class modbus{
 private:
   modbus();
 public:
+  static void append_crc(std::vector<uint8_t>& dst, size_t pos);
+  static void request_read(std::vector<uint8_t>& dst, uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t reg_cnt);
   static void request_readcoilstatus(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt);
+  static void request_forcesinglecoil(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, bool value);
+  static void request_presetsingleregister(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t value);
+  static bool request_forcemultiplecoils(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt, const uint8_t* values);
+  static bool request_presetmultipleregisters(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt, const uint16_t* values);
+  static bool request_readwritemultipleregisters(std::vector<uint8_t>& dst, uint8_t slave,
+                                                 uint16_t read_adr, uint16_t read_cnt,
+                                                 uint16_t write_adr, uint16_t write_cnt, const uint16_t* values);
 };
 
 /**
@@ -46,9 +85,87 @@ public:
   typedef void (*response_handler_t)( modbus_rtu_master*, const uint8_t*, size_t );
   typedef void (*response_timeout_handler_t)( modbus_rtu_master*, uint8_t, uint8_t );
 
+  /**
+   * @brief 読み出し応答(0x01, 0x02)ハンドラ
+   * bits は受信バッファを参照する. ハンドラ内でのみ有効.
+   */
+  typedef void (*bits_handler_t)( modbus_rtu_master*, uint8_t slave, uint16_t reg_adr, const modbus_bit_view& bits );
+
+  /**
+   * @brief 読み出し応答(0x03, 0x04, 0x17)ハンドラ
+   * regs は受信バッファを参照する. ハンドラ内でのみ有効.
+   */
+  typedef void (*registers_handler_t)( modbus_rtu_master*, uint8_t slave, uint16_t reg_adr, const modbus_register_view& regs );
+
+  /**
+   * @brief 書き込み応答(0x05, 0x06, 0x0f, 0x10)ハンドラ
+   * value は 0x05, 0x06 では書き込んだ値, 0x0f, 0x10 では書き込んだ数.
+   */
+  typedef void (*write_handler_t)( modbus_rtu_master*, uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t value );
+
   enum handler_type_t{
     READCOILSTATUS,
-    EXCEPTIONRESPONSE
+    READINPUTSTATUS,
+    READHOLDINGREGISTER,
+    READINPUTREGISTER,
+    EXCEPTIONRESPONSE,
+    FORCESINGLECOIL,
+    PRESETSINGLEREGISTER,
+    FORCEMULTIPLECOILS,
+    PRESETMULTIPLEREGISTERS,
+    READWRITEMULTIPLEREGISTERS,
+    HANDLER_TYPE_NUM
+  };
+
+  /**
+   * @brief 要求元(応答ハンドラ, タイムアウトハンドラ, context の組)
+   * 1つのマスターを複数の要求元(プランナー, 書き込みキャッシュ等)で共有する場合は要求元毎に持ち、
+   * 要求の直前に setclient() で指定する. 応答/タイムアウトは要求した client のハンドラへ渡し、
+   * ハンドラ内の modbus_rtu_master::context() は その client の context を返す.
+   */
+  class client{
+    friend class modbus_rtu_master;
+  private:
+    struct handler_t{
+      response_handler_t response;  // 応答フレームそのまま
+      bits_handler_t bits;
+      registers_handler_t registers;
+      write_handler_t write;
+    };
+    handler_t handlers_[HANDLER_TYPE_NUM];
+    response_timeout_handler_t response_timeout_handler_;
+    void* context_;
+
+  public:
+    void sethandler(response_handler_t handler, handler_type_t handler_type);
+    void sethandler(bits_handler_t handler, handler_type_t handler_type);
+    void sethandler(registers_handler_t handler, handler_type_t handler_type);
+    void sethandler(write_handler_t handler, handler_type_t handler_type);
+
+    void settimeout_handler(response_timeout_handler_t handler)
+    {
+      response_timeout_handler_ = handler;
+    }
+
+    /**
+     * @brief ハンドラから参照する任意のポインタ
+     */
+    void setcontext(void* context)
+    {
+      context_ = context;
+    }
+
+    void* context(void) const
+    {
+      return context_;
+    }
+
+    client() :
+      response_timeout_handler_(NULL),
+      context_(NULL)
+    {
+      memset(handlers_, 0, sizeof(handlers_));
+    }
   };
 
 private:
@@ -58,59 +175,169 @@ private:
   };
 
   stat_t stat_;
-  Timer idle_timer_;
+  Timeout frame_timer_;
   Timer response_timer_;
 
-  int idle_limit_;
+  volatile bool frame_end_;  // 最終受信からt3.5経過
+  int t35_us_;
   int response_limit_;
 
   uint8_t tgt_slave_;
   uint8_t tgt_cmd_;
+  uint16_t tgt_adr_;
+  uint16_t tgt_cnt_;  // 読み出し/書き込み数(0x05, 0x06 では書き込み値)
 
-  std::vector<uint8_t> rx_buff_;
+  modbus_rtu_frame rx_frame_;
+
+  static void frame_timer_handler_(modbus_rtu_master* self);
 
   uint16_t crc16(const uint8_t* src, size_t size){
     return seekers::crc16_ibm(src, size);
   }
 
-#ifdef __MBED__
-#ifndef NDEBUG
-  mbed::Stream& debug_;
-#endif
-#endif
+  trace_log* trace_;  // 記録先(NULLなら記録しない)
 
-  response_timeout_handler_t response_timeout_handler_;
+  client own_;         // setclient() で指定しない要求の要求元
+  client* client_;     // 次の1要求の要求元(setclient())
+  client* tgt_client_; // 応答待ちの要求の要求元
 
-  response_handler_t exceptionresponse_handler_;
-  response_handler_t readcoilstatus_handler_;
+  static handler_type_t handler_type_(uint8_t cmd);
+  void wait_response_(uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t reg_cnt);
+  bool reject_(void);
 
   bool exceptionresponse_(void);
-  bool readcoilstatus_(void);
+  bool readresponse_(void);
+  bool writeresponse_(void);
 
 public:
+  using basic_com_module::recieve;
+  using basic_com_module::recieve_frame;
+  using basic_com_module::idle;
+
+  void request_read(std::vector<uint8_t>& dst, uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t reg_cnt);
   void request_readcoilstatus(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt);
+  void request_readinputstatus(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt);
+  void request_readholdingregister(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt);
+  void request_readinputregister(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt);
+  void request_forcesinglecoil(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, bool value);
+  void request_presetsingleregister(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t value);
+  bool request_forcemultiplecoils(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt, const uint8_t* values);
+  bool request_presetmultipleregisters(std::vector<uint8_t>& dst, uint8_t slave, uint16_t reg_adr, uint16_t reg_cnt, const uint16_t* values);
+  bool request_readwritemultipleregisters(std::vector<uint8_t>& dst, uint8_t slave,
+                                          uint16_t read_adr, uint16_t read_cnt,
+                                          uint16_t write_adr, uint16_t write_cnt, const uint16_t* values);
+  bool request_pdu(std::vector<uint8_t>& dst, uint8_t slave, const uint8_t* pdu, size_t size);
   void idle(std::vector<uint8_t>& dst);
 
   void recieve(std::vector<uint8_t>& tx_buff, const uint8_t* src, size_t size);
-  void sethandler(response_handler_t handler, handler_type_t handler_type);
+  void recieve_frame(std::vector<uint8_t>& tx_buff, const uint8_t* src, size_t size);
+  void sethandler(response_handler_t handler, handler_type_t handler_type)
+  {
+    own_.sethandler(handler, handler_type);
+  }
+
+  void sethandler(bits_handler_t handler, handler_type_t handler_type)
+  {
+    own_.sethandler(handler, handler_type);
+  }
+
+  void sethandler(registers_handler_t handler, handler_type_t handler_type)
+  {
+    own_.sethandler(handler, handler_type);
+  }
+
+  void sethandler(write_handler_t handler, handler_type_t handler_type)
+  {
+    own_.sethandler(handler, handler_type);
+  }
+
+  /**
+   * @brief 通信速度の設定
+   * @param baud 通信速度[bps]
+   * @param bit_length 1文字のbit長(スタート + データ + パリティ + ストップ)
+   */
+  void timing(int baud, int bit_length)
+  {
+    t35_us_ = modbus_rtu_timing::t35_us(baud, bit_length);
+  }
+
   void settimeout_handler(response_timeout_handler_t handler)
   {
-    response_timeout_handler_ = handler;
+    own_.settimeout_handler(handler);
+  }
+
+  /**
+   * @brief 次の1要求の要求元(NULLでマスター自身の sethandler(), setcontext() の設定)
+   * 指定は次の request_*() の呼び出し(生成に失敗した場合を含む)で解除され、
+   * 以降の要求はマスター自身のハンドラへ戻る. 要求元は要求の直前に毎回指定すること.
+   */
+  void setclient(client* c)
+  {
+    client_ = (NULL != c) ? c : &own_;
+  }
+
+  /**
+   * @brief 応答待ち中か
+   */
+  bool busy(void) const
+  {
+    return stat_ == STAT_WAIT_FOR_REQUEST;
+  }
+
+  /**
+   * @brief c の要求の応答待ち中か
+   */
+  bool busy(const client& c) const
+  {
+    return busy() && tgt_client_ == &c;
+  }
+
+  /**
+   * @brief 次の要求を送信可能か(応答待ちでなく、フレーム間隔が経過済み)
+   */
+  bool ready(void)
+  {
+    return !busy() && frame_end_;
+  }
+
+  /**
+   * @brief ハンドラから参照する任意のポインタ
+   */
+  void setcontext(void* context)
+  {
+    own_.setcontext(context);
+  }
+
+  /**
+   * @brief 応答待ち(直前)の要求の要求元の context. ハンドラ内では要求元の context となる
+   */
+  void* context(void) const
+  {
+    return tgt_client_->context_;
+  }
+
+  /**
+   * @brief 記録先の設定(NULLで記録しない)
+   */
+  void settrace(trace_log* trace)
+  {
+    trace_ = trace;
   }
 
 public:
-  modbus_rtu_master(mbed::Stream& debug) :
+  modbus_rtu_master(mbed::Stream& /*debug*/) :
     stat_(STAT_HALT),
-    idle_limit_(4),
+    frame_end_(true),
+    t35_us_(modbus_rtu_timing::t35_us(9600, 10)),
     response_limit_(500),
     tgt_slave_(0x00),
     tgt_cmd_(0x00),
-    debug_(debug),
-    response_timeout_handler_(NULL),
-    exceptionresponse_handler_(NULL),
-    readcoilstatus_handler_(NULL)
+    tgt_adr_(0),
+    tgt_cnt_(0),
+    trace_(NULL),
+    client_(&own_),
+    tgt_client_(&own_)
   {
-    idle_timer_.start();
     response_timer_.start();
   }
 };
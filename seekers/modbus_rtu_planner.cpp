@@ -0,0 +1,272 @@
+/**
+ * @file modbus_rtu_planner.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 18:15:40
+ *  - first.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラを client_ へ設定し、要求の前に setclient() で要求元を指定するよう変更.
+ */
+
+#include "modbus_rtu_planner.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンストラクタ
+ */
+modbus_rtu_planner::modbus_rtu_planner(modbus_rtu_master& master) :
+  master_(master),
+  request_num_(0),
+  planned_(true),
+  register_gap_(0),
+  bit_gap_(0),
+  pending_(-1),
+  next_(0),
+  cycles_(0)
+{
+  for(int ii = 0; ii < POINT_CAPACITY; ++ii)
+    points_[ii].used = false;
+
+  client_.setcontext(this);
+  client_.sethandler(bits_handler_, modbus_rtu_master::READCOILSTATUS);
+  client_.sethandler(bits_handler_, modbus_rtu_master::READINPUTSTATUS);
+  client_.sethandler(registers_handler_, modbus_rtu_master::READHOLDINGREGISTER);
+  client_.sethandler(registers_handler_, modbus_rtu_master::READINPUTREGISTER);
+  client_.sethandler(exception_handler_, modbus_rtu_master::EXCEPTIONRESPONSE);
+  client_.settimeout_handler(timeout_handler_);
+}
+
+/**
+ * @brief 読み出す点の追加
+ * @return 点ID. 空きが無い, 機能コードが 0x01-0x04 以外の場合は -1
+ */
+int modbus_rtu_planner::add(uint8_t slave, uint8_t cmd, uint16_t reg_adr)
+{
+  if(cmd < 0x01 || cmd > 0x04) return -1;
+
+  for(int ii = 0; ii < POINT_CAPACITY; ++ii){
+    point_t& pt = points_[ii];
+    if(pt.used) continue;
+    pt.used = true;
+    pt.valid = false;
+    pt.slave = slave;
+    pt.cmd = cmd;
+    pt.reg_adr = reg_adr;
+    pt.value = 0;
+    planned_ = false;
+    return ii;
+  }
+  return -1;
+}
+
+/**
+ * @brief 読み出す点の削除
+ */
+void modbus_rtu_planner::remove(int id)
+{
+  if(id < 0 || id >= POINT_CAPACITY) return;
+  points_[id].used = false;
+  planned_ = false;
+}
+
+/**
+ * @brief 点の順序(スレーブ, 機能コード, アドレス)
+ */
+bool modbus_rtu_planner::less_(int lhs, int rhs) const
+{
+  const point_t& l = points_[lhs];
+  const point_t& r = points_[rhs];
+  if(l.slave != r.slave) return l.slave < r.slave;
+  if(l.cmd != r.cmd) return l.cmd < r.cmd;
+  return l.reg_adr < r.reg_adr;
+}
+
+/**
+ * @brief order_[0..num) の整列(挿入ソート)
+ */
+void modbus_rtu_planner::sort_(int num)
+{
+  for(int ii = 1; ii < num; ++ii){
+    const int id = order_[ii];
+    int jj = ii;
+    for(; jj > 0 && less_(id, order_[jj - 1]); --jj)
+      order_[jj] = order_[jj - 1];
+    order_[jj] = id;
+  }
+}
+
+/**
+ * @brief 要求の集約
+ * 整列した点を先頭から順に、同じスレーブ/機能コードで、要求の最大点数を超えず、
+ * 直前の点との隙間が許容値以下である限り同じ要求に含める.
+ * @return 要求数. 要求が REQUEST_CAPACITY を超える場合、超えた点は読み出さない
+ */
+int modbus_rtu_planner::plan(void)
+{
+  int num = 0;
+  for(int ii = 0; ii < POINT_CAPACITY; ++ii){
+    if(points_[ii].used)
+      order_[num++] = ii;
+  }
+  sort_(num);
+
+  request_num_ = 0;
+  for(int ii = 0; ii < num; ++ii){
+    const point_t& pt = points_[order_[ii]];
+    if(request_num_ > 0){
+      request_t& req = requests_[request_num_ - 1];
+      const bool bits = (pt.cmd == 0x01 || pt.cmd == 0x02);
+      const uint32_t last = req.reg_adr + req.reg_cnt - 1;
+      if(req.slave == pt.slave && req.cmd == pt.cmd
+         && pt.reg_adr <= last + 1 + (bits ? bit_gap_ : register_gap_)
+         && (uint32_t)pt.reg_adr + 1 - req.reg_adr <= (bits ? 2000u : 125u)){
+        if(pt.reg_adr > last)
+          req.reg_cnt = pt.reg_adr + 1 - req.reg_adr;
+        ++req.count;
+        continue;
+      }
+    }
+    if(request_num_ >= REQUEST_CAPACITY) break;
+
+    request_t& req = requests_[request_num_++];
+    req.slave = pt.slave;
+    req.cmd = pt.cmd;
+    req.reg_adr = pt.reg_adr;
+    req.reg_cnt = 1;
+    req.first = ii;
+    req.count = 1;
+  }
+
+  planned_ = true;
+  pending_ = -1;
+  next_ = 0;
+  return request_num_;
+}
+
+/**
+ * @brief 送信処理
+ */
+void modbus_rtu_planner::poll(std::vector<uint8_t>& tx_buff)
+{
+  if(pending_ >= 0 && !master_.busy(client_))
+    pending_ = -1;
+
+  if(pending_ >= 0 || !master_.ready())
+    return;
+
+  if(!planned_)
+    plan();
+  if(0 == request_num_)
+    return;
+
+  const request_t& req = requests_[next_];
+  master_.setclient(&client_);
+  master_.request_read(tx_buff, req.slave, req.cmd, req.reg_adr, req.reg_cnt);
+  pending_ = next_;
+  if(++next_ >= request_num_){
+    next_ = 0;
+    ++cycles_;
+  }
+}
+
+/**
+ * @brief 応答を各点へ振り分け
+ * 応答が無い(例外応答, タイムアウト)場合は regs, bits ともNULLで、各点を無効とする.
+ */
+void modbus_rtu_planner::scatter_(const modbus_register_view* regs, const modbus_bit_view* bits)
+{
+  if(pending_ < 0) return;
+  const request_t& req = requests_[pending_];
+
+  for(int ii = req.first; ii < req.first + req.count; ++ii){
+    point_t& pt = points_[order_[ii]];
+    const size_t idx = pt.reg_adr - req.reg_adr;
+    if(NULL != regs){
+      pt.value = (*regs)[idx];
+      pt.valid = true;
+    }
+    else if(NULL != bits){
+      pt.value = (*bits)[idx] ? 1 : 0;
+      pt.valid = true;
+    }
+    else{
+      pt.valid = false;
+    }
+  }
+}
+
+/**
+ * @brief modbus_rtu_master 応答ハンドラ(0x03, 0x04)
+ */
+void modbus_rtu_planner::registers_handler_(modbus_rtu_master* master, uint8_t, uint16_t, const modbus_register_view& regs)
+{
+  modbus_rtu_planner* self = (modbus_rtu_planner*)master->context();
+  self->scatter_(&regs, NULL);
+}
+
+/**
+ * @brief modbus_rtu_master 応答ハンドラ(0x01, 0x02)
+ */
+void modbus_rtu_planner::bits_handler_(modbus_rtu_master* master, uint8_t, uint16_t, const modbus_bit_view& bits)
+{
+  modbus_rtu_planner* self = (modbus_rtu_planner*)master->context();
+  self->scatter_(NULL, &bits);
+}
+
+/**
+ * @brief modbus_rtu_master 例外応答ハンドラ
+ */
+void modbus_rtu_planner::exception_handler_(modbus_rtu_master* master, const uint8_t*, size_t)
+{
+  modbus_rtu_planner* self = (modbus_rtu_planner*)master->context();
+  self->scatter_(NULL, NULL);
+}
+
+/**
+ * @brief modbus_rtu_master 応答待ちタイムアウトハンドラ
+ */
+void modbus_rtu_planner::timeout_handler_(modbus_rtu_master* master, uint8_t /*slave*/, uint8_t /*cmd*/)
+{
+  modbus_rtu_planner* self = (modbus_rtu_planner*)master->context();
+  self->scatter_(NULL, NULL);
+}
+
+/**
+ * @brief 読み出し1回のバス占有時間[us]
+ * 要求(8byte) + 応答(5byte + データ) と、それぞれの後のt3.5. スレーブの処理時間は含まない.
+ */
+int modbus_rtu_planner::transaction_us(uint8_t cmd, uint16_t reg_cnt, int baud, int bit_length)
+{
+  const int data_byte = (cmd == 0x01 || cmd == 0x02) ? (reg_cnt + 7) / 8 : reg_cnt * 2;
+  return (8 + 5 + data_byte) * modbus_rtu_timing::char_us(baud, bit_length)
+    + 2 * modbus_rtu_timing::t35_us(baud, bit_length);
+}
+
+/**
+ * @brief 集約後の全要求を1巡するバス占有時間[us]
+ */
+int modbus_rtu_planner::cycle_us(int baud, int bit_length) const
+{
+  int us = 0;
+  for(int ii = 0; ii < request_num_; ++ii)
+    us += transaction_us(requests_[ii].cmd, requests_[ii].reg_cnt, baud, bit_length);
+  return us;
+}
+
+/**
+ * @brief 点毎に1要求とした場合に1巡するバス占有時間[us](比較用)
+ */
+int modbus_rtu_planner::unplanned_cycle_us(int baud, int bit_length) const
+{
+  int us = 0;
+  for(int ii = 0; ii < POINT_CAPACITY; ++ii){
+    if(points_[ii].used)
+      us += transaction_us(points_[ii].cmd, 1, baud, bit_length);
+  }
+  return us;
+}
+
+} /* namespace */
@@ -0,0 +1,134 @@
+/**
+ * @file modbus_rtu_planner.hpp
+ * @brief MODBUS RTU マスター 読み出し要求の集約
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 18:15:40
+ *  - First.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラを modbus_rtu_master::client で設定し、マスターを他の要求元と共有できるよう変更.
+ */
+
+#ifndef SEEKERS_MODBUS_RTU_PLANNER_HPP
+#define SEEKERS_MODBUS_RTU_PLANNER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <vector>
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#endif
+
+#include "modbus_rtu_master.hpp"
+
+namespace seekers{
+
+/**
+ * @brief MODBUS RTU マスター 読み出し要求の集約
+ * 読み出す点(スレーブ, 機能コード, アドレス)を登録すると、スレーブ/機能コード毎に
+ * アドレス順で連続する点を1要求(0x01, 0x02: 2000点, 0x03, 0x04: 125点まで)へまとめ、
+ * 要求を順に送信して応答を各点へ振り分ける.
+ * 点の間の隙間が許容値以下なら、隙間を読み捨てて同じ要求に含める.
+ * 応答ハンドラは要求元(modbus_rtu_master::client)として設定するため、1つのマスターを
+ * 他の要求元(プランナー, スケジューラ, 書き込みキャッシュ, ゲートウェイ)と共有できる.
+ */
+class modbus_rtu_planner{
+public:
+  static const int POINT_CAPACITY = 128;
+  static const int REQUEST_CAPACITY = 32;
+
+private:
+  struct point_t{
+    bool used;
+    bool valid;      // 最後の要求で値を取得できた
+    uint8_t slave;
+    uint8_t cmd;
+    uint16_t reg_adr;
+    uint16_t value;
+  };
+
+  struct request_t{
+    uint8_t slave;
+    uint8_t cmd;
+    uint16_t reg_adr;
+    uint16_t reg_cnt;
+    int first;       // order_ 内の先頭
+    int count;       // 含む点の数
+  };
+
+  modbus_rtu_master& master_;
+  modbus_rtu_master::client client_;  // 応答ハンドラ, context
+  point_t points_[POINT_CAPACITY];
+  int order_[POINT_CAPACITY];  // (スレーブ, 機能コード, アドレス)順の点ID
+  request_t requests_[REQUEST_CAPACITY];
+  int request_num_;
+  bool planned_;
+
+  uint16_t register_gap_;
+  uint16_t bit_gap_;
+
+  int pending_;      // 応答待ちの要求(-1:なし)
+  int next_;
+  uint32_t cycles_;
+
+  bool less_(int lhs, int rhs) const;
+  void sort_(int num);
+  void scatter_(const modbus_register_view* regs, const modbus_bit_view* bits);
+
+  static void registers_handler_(modbus_rtu_master*, uint8_t, uint16_t, const modbus_register_view&);
+  static void bits_handler_(modbus_rtu_master*, uint8_t, uint16_t, const modbus_bit_view&);
+  static void exception_handler_(modbus_rtu_master*, const uint8_t*, size_t);
+  static void timeout_handler_(modbus_rtu_master*, uint8_t, uint8_t);
+
+public:
+  explicit modbus_rtu_planner(modbus_rtu_master& master);
+
+  int add(uint8_t slave, uint8_t cmd, uint16_t reg_adr);
+  void remove(int id);
+
+  /**
+   * @brief 1要求にまとめる隙間の許容値
+   * @param registers 0x03, 0x04 で読み捨てを許容するレジスタ数
+   * @param bits 0x01, 0x02 で読み捨てを許容するbit数
+   */
+  void gap(uint16_t registers, uint16_t bits)
+  {
+    register_gap_ = registers;
+    bit_gap_ = bits;
+    planned_ = false;
+  }
+
+  int plan(void);
+
+  /**
+   * @brief 送信処理
+   * modbus_rtu_master::idle() の後に呼び出す. 送信可能なら次の要求を tx_buff へ追加する.
+   */
+  void poll(std::vector<uint8_t>& tx_buff);
+
+  uint16_t value(int id) const { return points_[id].value; }
+  bool valid(int id) const { return points_[id].valid; }
+
+  /**
+   * @brief 集約後の要求数
+   */
+  int requests(void) const { return request_num_; }
+
+  /**
+   * @brief 全要求を送信し終えた回数
+   */
+  uint32_t cycles(void) const { return cycles_; }
+
+  int cycle_us(int baud, int bit_length) const;
+  int unplanned_cycle_us(int baud, int bit_length) const;
+  static int transaction_us(uint8_t cmd, uint16_t reg_cnt, int baud, int bit_length);
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_RTU_PLANNER_HPP */
@@ -0,0 +1,207 @@
+/**
+ * @file modbus_rtu_scheduler.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 13:20:44
+ *  - first.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラを client_ へ設定し、要求の前に setclient() で要求元を指定するよう変更.
+ */
+
+#include "modbus_rtu_scheduler.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンストラクタ
+ */
+modbus_rtu_scheduler::modbus_rtu_scheduler(modbus_rtu_master& master) :
+  master_(master),
+  now_ms_(0),
+  now_us_(0),
+  pending_(-1),
+  responded_(false),
+  baud_(9600),
+  bit_length_(10),
+  bus_chars_(0),
+  stat_ms_(0)
+{
+  for(int ii = 0; ii < CAPACITY; ++ii)
+    requests_[ii].used = false;
+
+  client_.setcontext(this);
+  client_.sethandler(response_handler_, modbus_rtu_master::READCOILSTATUS);
+  client_.sethandler(response_handler_, modbus_rtu_master::READINPUTSTATUS);
+  client_.sethandler(response_handler_, modbus_rtu_master::READHOLDINGREGISTER);
+  client_.sethandler(response_handler_, modbus_rtu_master::READINPUTREGISTER);
+  client_.sethandler(response_handler_, modbus_rtu_master::EXCEPTIONRESPONSE);
+  client_.settimeout_handler(timeout_handler_);
+  clock_.start();
+}
+
+/**
+ * @brief 周期要求の追加
+ * @param period_ms 要求周期[ms]. 0なら可能な限り連続して要求する
+ * @param priority 優先度(小さい方が優先)
+ * @return 要求ID. 空きが無い場合は -1
+ */
+int modbus_rtu_scheduler::add(uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t reg_cnt,
+                              uint32_t period_ms, int priority, poll_handler_t handler)
+{
+  if(cmd < 0x01 || cmd > 0x04) return -1;
+
+  tick_();
+  for(int ii = 0; ii < CAPACITY; ++ii){
+    request_t& req = requests_[ii];
+    if(req.used) continue;
+    req.used = true;
+    req.slave = slave;
+    req.cmd = cmd;
+    req.reg_adr = reg_adr;
+    req.reg_cnt = reg_cnt;
+    req.period_ms = period_ms;
+    req.priority = priority;
+    req.due_ms = now_ms_;
+    req.handler = handler;
+    return ii;
+  }
+  return -1;
+}
+
+/**
+ * @brief 周期要求の削除
+ */
+void modbus_rtu_scheduler::remove(int id)
+{
+  if(id < 0 || id >= CAPACITY) return;
+  requests_[id].used = false;
+}
+
+/**
+ * @brief 時刻の更新
+ */
+void modbus_rtu_scheduler::tick_(void)
+{
+  now_us_ += clock_.read_us();
+  clock_.reset();
+  now_ms_ += now_us_ / 1000;
+  now_us_ %= 1000;
+}
+
+/**
+ * @brief 次に送信する要求の選択
+ * 期限を過ぎた要求のうち優先度が高いもの、同じ優先度なら期限の古いもの
+ * @return 要求ID. 該当なしは -1
+ */
+int modbus_rtu_scheduler::select_(void) const
+{
+  int sel = -1;
+  for(int ii = 0; ii < CAPACITY; ++ii){
+    const request_t& req = requests_[ii];
+    if(!req.used) continue;
+    if((int32_t)(now_ms_ - req.due_ms) < 0) continue;
+    if(sel < 0
+       || req.priority < requests_[sel].priority
+       || (req.priority == requests_[sel].priority
+           && (int32_t)(req.due_ms - requests_[sel].due_ms) < 0)){
+      sel = ii;
+    }
+  }
+  return sel;
+}
+
+/**
+ * @brief 送信処理
+ */
+void modbus_rtu_scheduler::poll(std::vector<uint8_t>& tx_buff)
+{
+  tick_();
+
+  // 応答完了(ハンドラ呼び出し無しはcrcエラー)
+  if(pending_ >= 0 && !master_.busy(client_)){
+    if(!responded_)
+      complete_(NULL, 0);
+    pending_ = -1;
+  }
+
+  if(pending_ >= 0 || !master_.ready())
+    return;
+
+  const int id = select_();
+  if(id < 0)
+    return;
+
+  request_t& req = requests_[id];
+  const size_t pos = tx_buff.size();
+  master_.setclient(&client_);
+  master_.request_read(tx_buff, req.slave, req.cmd, req.reg_adr, req.reg_cnt);
+  bus_chars_ += tx_buff.size() - pos;
+
+  // 遅れても周期を維持し、追いつけない場合は現在時刻を基準にする
+  req.due_ms += req.period_ms;
+  if((int32_t)(now_ms_ - req.due_ms) > 0)
+    req.due_ms = now_ms_;
+
+  pending_ = id;
+  responded_ = false;
+}
+
+/**
+ * @brief 応答の通知
+ */
+void modbus_rtu_scheduler::complete_(const uint8_t* frame, size_t size)
+{
+  if(pending_ < 0) return;
+  responded_ = true;
+  bus_chars_ += size;
+
+  const request_t& req = requests_[pending_];
+  if(req.used && NULL != req.handler)
+    req.handler(this, pending_, frame, size);
+}
+
+/**
+ * @brief modbus_rtu_master 応答ハンドラ
+ */
+void modbus_rtu_scheduler::response_handler_(modbus_rtu_master* master, const uint8_t* frame, size_t size)
+{
+  modbus_rtu_scheduler* self = (modbus_rtu_scheduler*)master->context();
+  self->complete_(frame, size);
+}
+
+/**
+ * @brief modbus_rtu_master 応答待ちタイムアウトハンドラ
+ */
+void modbus_rtu_scheduler::timeout_handler_(modbus_rtu_master* master, uint8_t /*slave*/, uint8_t /*cmd*/)
+{
+  modbus_rtu_scheduler* self = (modbus_rtu_scheduler*)master->context();
+  self->complete_(NULL, 0);
+}
+
+/**
+ * @brief バス使用率 [0.1%]
+ */
+int modbus_rtu_scheduler::utilization(void)
+{
+  tick_();
+  const uint64_t elapsed_us = (uint64_t)(now_ms_ - stat_ms_) * 1000;
+  if(0 == elapsed_us || 0 >= baud_) return 0;
+
+  const uint64_t busy_us = (uint64_t)bus_chars_ * bit_length_ * 1000000 / baud_;
+  const uint64_t permille = busy_us * 1000 / elapsed_us;
+  return (permille > 1000) ? 1000 : (int)permille;
+}
+
+/**
+ * @brief 統計の初期化
+ */
+void modbus_rtu_scheduler::reset_statistics(void)
+{
+  tick_();
+  bus_chars_ = 0;
+  stat_ms_ = now_ms_;
+}
+
+} /* namespace */
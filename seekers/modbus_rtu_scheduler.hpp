@@ -0,0 +1,119 @@
+/**
+ * @file modbus_rtu_scheduler.hpp
+ * @brief MODBUS RTU マスター 周期要求スケジューラ
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 13:20:44
+ *  - First.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラを modbus_rtu_master::client で設定し、マスターを他の要求元と共有できるよう変更.
+ */
+
+#ifndef SEEKERS_MODBUS_RTU_SCHEDULER_HPP
+#define SEEKERS_MODBUS_RTU_SCHEDULER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <vector>
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#endif
+
+#include "modbus_rtu_master.hpp"
+
+namespace seekers{
+
+/**
+ * @brief MODBUS RTU マスター 周期要求スケジューラ
+ * 要求(スレーブ, 機能コード, アドレス, 点数)毎に周期と優先度を持ち、
+ * 応答完了またはフレーム間隔の経過後、すぐに次の要求を送信する.
+ * 応答ハンドラは要求元(modbus_rtu_master::client)として設定するため、1つのマスターを
+ * 他の要求元(プランナー, スケジューラ, 書き込みキャッシュ, ゲートウェイ)と共有できる.
+ */
+class modbus_rtu_scheduler{
+public:
+  static const int CAPACITY = 32;
+
+  /**
+   * @brief 応答ハンドラ
+   * @param id add() の戻り値
+   * @param frame 応答フレーム(例外応答含む). タイムアウト/crcエラー時はNULL
+   * @param size frameのサイズ
+   */
+  typedef void (*poll_handler_t)( modbus_rtu_scheduler*, int id, const uint8_t* frame, size_t size );
+
+private:
+  struct request_t{
+    bool used;
+    uint8_t slave;
+    uint8_t cmd;
+    uint16_t reg_adr;
+    uint16_t reg_cnt;
+    uint32_t period_ms;
+    int priority;
+    uint32_t due_ms;
+    poll_handler_t handler;
+  };
+
+  modbus_rtu_master& master_;
+  modbus_rtu_master::client client_;  // 応答ハンドラ, context
+  request_t requests_[CAPACITY];
+
+  Timer clock_;
+  uint32_t now_ms_;
+  uint32_t now_us_;  // 1ms未満の端数
+
+  int pending_;      // 応答待ちの要求(-1:なし)
+  bool responded_;
+
+  int baud_;
+  int bit_length_;
+  uint32_t bus_chars_;  // 統計開始からの送受信文字数
+  uint32_t stat_ms_;    // 統計開始時刻
+
+  void tick_(void);
+  int select_(void) const;
+  void complete_(const uint8_t* frame, size_t size);
+
+  static void response_handler_(modbus_rtu_master*, const uint8_t*, size_t);
+  static void timeout_handler_(modbus_rtu_master*, uint8_t, uint8_t);
+
+public:
+  explicit modbus_rtu_scheduler(modbus_rtu_master& master);
+
+  int add(uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t reg_cnt,
+          uint32_t period_ms, int priority, poll_handler_t handler);
+  void remove(int id);
+
+  /**
+   * @brief 送信処理
+   * modbus_rtu_master::idle() の後に呼び出す. 送信可能なら次の要求を tx_buff へ追加する.
+   */
+  void poll(std::vector<uint8_t>& tx_buff);
+
+  /**
+   * @brief 通信速度の設定(バス使用率の計算用)
+   */
+  void format(int baud, int bit_length)
+  {
+    baud_ = baud;
+    bit_length_ = bit_length;
+  }
+
+  /**
+   * @brief バス使用率 [0.1%]
+   * 統計開始からの送受信文字数 x 1文字の時間 / 経過時間
+   */
+  int utilization(void);
+
+  void reset_statistics(void);
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_RTU_SCHEDULER_HPP */
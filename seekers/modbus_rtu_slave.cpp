@@ -6,6 +6,26 @@
  * @par history
  * - 2016-11-04 11:46:59
  *  - first.
+ * - 2026-10-17 10:21:03
+ *  - 受信データのcrcを逐次計算するよう変更.
+ * - 2026-10-17 11:02:37
+ *  - 受信バッファをmodbus_rtu_frameへ変更.
+ * - 2026-10-17 11:48:15
+ *  - 機能コードをテーブルで振り分けるよう変更.
+ * - 2026-10-17 12:30:51
+ *  - レジスタ領域(modbus_register_bank)からの直接応答, 0x06/0x0f/0x10に対応.
+ * - 2026-10-17 14:05:18
+ *  - フレーム終端を通信速度から求めたt3.5のタイムアウトで判定するよう変更.
+ * - 2026-10-17 14:52:30
+ *  - recieve_frame() に対応.
+ * - 2026-10-17 17:20:06
+ *  - 送信バッファを固定容量(frame_buff_t)へ変更. フレーム単位の受信では呼び出し側のバッファへ直接応答する.
+ * - 2026-10-17 19:05:33
+ *  - フレーム長の判定を frame_length() へ分離. process() を追加.
+ * - 2026-10-17 23:58:06
+ *  - デバッグ出力(debug_.printf)を trace_log への記録へ変更.
+ * - 2026-10-18 00:00:10
+ *  - 0x01-0x05 の frame_buff_t 版の既定を std::vector 版への変換へ変更.
  */
 
 
@@ -13,65 +33,156 @@
 
 namespace seekers{
 
+/**
+ * @brief 機能コード - 処理テーブル
+ * 未定義の機能コードはhandlerがNULL
+ */
+const modbus_rtu_slave::function_t modbus_rtu_slave::functions_[256] = {
+  /* 0x00 */ { 0, 0, NULL },
+  /* 0x01 */ { 8, 0, &modbus_rtu_slave::readcoilstatus_ },
+  /* 0x02 */ { 8, 0, &modbus_rtu_slave::readinputstatus_ },
+  /* 0x03 */ { 8, 0, &modbus_rtu_slave::readholdingregister_ },
+  /* 0x04 */ { 8, 0, &modbus_rtu_slave::readinputregister_ },
+  /* 0x05 */ { 8, 0, &modbus_rtu_slave::forcesinglecoil_ },
+  /* 0x06 */ { 8, 0, &modbus_rtu_slave::presetsingleregister_ },
+  /* 0x07 */ { 0, 0, NULL },
+  /* 0x08 */ { 0, 0, NULL }, // diagnostics
+  /* 0x09 */ { 0, 0, NULL },
+  /* 0x0a */ { 0, 0, NULL },
+  /* 0x0b */ { 0, 0, NULL }, // fetchcommeventcounter
+  /* 0x0c */ { 0, 0, NULL }, // fetchcommeventlog
+  /* 0x0d */ { 0, 0, NULL },
+  /* 0x0e */ { 0, 0, NULL },
+  /* 0x0f */ { 0, 6, &modbus_rtu_slave::forcemultiplecoils_ },
+  /* 0x10 */ { 0, 6, &modbus_rtu_slave::presetmultipleregisters_ },
+  // 0x11 reportslaveid
+};
+
 /**
  * @brief データ受信時の処理
+ * 応答はt3.5経過まで保留し、idle() で渡す.
  */
-void modbus_rtu_slave::recieve(std::vector<uint8_t>& tx_buff, const uint8_t* src, size_t size)
+void modbus_rtu_slave::recieve(frame_buff_t& tx_buff, const uint8_t* src, size_t size)
 {
 #ifndef NDEBUG
   // debug_.printf("[DEBUG] modbus_rtu_slave[%d] recieve()\r\n", adr_);
 #endif
-  if(idle_timer_.read_ms() >= idle_limit_ ){
+  if(frame_end_){
 #ifndef NDEBUG
     // debug_.printf("[DEBUG] modbus_rtu_slave[%d] Timeout. framebuffer clear.\r\n", adr_);
 #endif
-    rx_buff_.clear();
+    rx_frame_.clear();
   }
 
-  idle_timer_.reset();
-  rx_buff_.insert(rx_buff_.end(), src, src + size);
+  frame_end_ = false;
+  frame_timer_.attach_us(callback(this, &modbus_rtu_slave::frame_timer_handler_), t35_us_);
+  recieve_(src, size);
+}
 
-  // 頭出し
-  while( rx_buff_.size() > 1 && rx_buff_[0] != adr_ )
-    rx_buff_.erase(rx_buff_.begin());
+/**
+ * @brief 受信データの解析と応答
+ * 機能コード(2byte目)からフレーム長を決定し、揃った時点でcrcを1度だけ判定する.
+ * 応答は tx_ へ格納する.
+ */
+void modbus_rtu_slave::recieve_(const uint8_t* src, size_t size)
+{
+  rx_frame_.append(src, size);
+
+  for(;;){
+    // 頭出し
+    rx_frame_.seek(adr_);
+
+    const int length = frame_length(rx_frame_.data(), rx_frame_.size());
+    if(length < 0){
+      // 未対応の機能コード. 頭出しからやり直す
+      rx_frame_.consume(1);
+      continue;
+    }
+    if(0 == length || rx_frame_.size() < (size_t)length )
+      return;
+
+    if(!rx_frame_.crc_check(length)){
+      if(NULL != trace_)
+        trace_->put(TRACE_SLAVE_CRC, adr_, rx_frame_[1]);
+      rx_frame_.consume(1);
+      continue;
+    }
+
+    (this->*functions_[rx_frame_[1]].handler)(rx_frame_.data());
+    rx_frame_.consume(length);
+  }
+}
 
-  // 最低フレームサイズ(adr + cmd + crc)より少なければ次
-  if(rx_buff_.size() < 4 )
-    return;
+/**
+ * @brief フレーム長(crc含む)の判定
+ * 機能コード(2byte目)から決定する. 可変長の機能コードはbyte数の位置まで必要.
+ * @return フレーム長. 判定に必要なデータが無ければ0, 未対応の機能コードは-1
+ */
+int modbus_rtu_slave::frame_length(const uint8_t* data, size_t size)
+{
+  if(size < 2)
+    return 0;
+
+  const function_t& func = functions_[data[1]];
+  if(NULL == func.handler)
+    return -1;
+  if(0 != func.length)
+    return func.length;
+  if(size <= func.count_pos)
+    return 0;
+  return func.count_pos + 1 + data[func.count_pos] + 2;
+}
 
-  if(
-    readcoilstatus_()
-    || readinputstatus_()
-    || readholdingregister_()
-    || readinputregister_()
-    || forcesinglecoil_()
-    // || prisetsigleregister_()
-    // || diagnostics_()
-    // || fetchcommeventcounter_()
-    // || fetchcommeventlog_()
-    // || forcemultiplecoils_()
-    // || presetmultipleregisters_()
-    // || reportslaveid_()
-  ){
-    rx_buff_.clear();
-  }
+/**
+ * @brief 1フレームの処理
+ * frame は frame_length() 分のcrc判定済みデータであること.
+ */
+void modbus_rtu_slave::process(frame_buff_t& tx_buff, const uint8_t* frame)
+{
+  frame_buff_t* const tx = tx_;
+  tx_ = &tx_buff;
+  (this->*functions_[frame[1]].handler)(frame);
+  tx_ = tx;
 }
 
 /**
  * @brief アイドル処理
  */
-void modbus_rtu_slave::idle(std::vector<uint8_t>& tx_buff)
+void modbus_rtu_slave::idle(frame_buff_t& tx_buff)
 {
-  if(idle_timer_.read_ms() >= idle_limit_ && !tx_buff_.empty() ){
+  if(frame_end_ && !tx_buff_.empty() ){
     tx_buff.insert(tx_buff.end(), tx_buff_.begin(), tx_buff_.end());
     tx_buff_.clear();
   }
 }
 
+/**
+ * @brief フレーム単位の受信処理
+ */
+void modbus_rtu_slave::recieve_frame(frame_buff_t& tx_buff, const uint8_t* src, size_t size)
+{
+  frame_timer_.detach();
+  frame_end_ = true;
+  idle(tx_buff); // 保留中の応答
+
+  rx_frame_.clear();
+  tx_ = &tx_buff;
+  recieve_(src, size);
+  tx_ = &tx_buff_;
+}
+
+/**
+ * @brief t3.5経過(フレーム終端)
+ */
+void modbus_rtu_slave::frame_timer_handler_(modbus_rtu_slave* self)
+{
+  self->frame_end_ = true;
+}
+
 /**
  * @breaf 例外応答の生成
  */
-void modbus_rtu_slave::exceptionresponse(std::vector<uint8_t>& dst, uint8_t adr, uint8_t cmd, uint8_t code)
+void modbus_rtu_slave::exceptionresponse(frame_buff_t& dst, uint8_t adr, uint8_t cmd, uint8_t code)
 {
   uint8_t except[5] = {
     adr,
@@ -87,37 +198,135 @@ void modbus_rtu_slave::exceptionresponse(std::vector<uint8_t>& dst, uint8_t adr,
 }
 
 /**
- * @brief readcoilstatus応答(0x01)
+ * @brief 例外応答(std::vector 版)
  */
-bool modbus_rtu_slave::readcoilstatus_(void)
+void modbus_rtu_slave::exceptionresponse(std::vector<uint8_t>& dst, uint8_t adr, uint8_t cmd, uint8_t code)
 {
-  if(rx_buff_[1] != 0x01 ) return false;
-  if(rx_buff_.size() < 8 ) return false;
+  frame_buff_t buf;
+  exceptionresponse(buf, adr, cmd, code);
+  dst.insert(dst.end(), buf.begin(), buf.end());
+}
 
-  const uint16_t crc_src = rx_buff_[6] | (rx_buff_[7] << 8);
-  const uint16_t crc_calc = crc16(&rx_buff_[0], 6);
+/**
+ * @brief std::vector 版の応答を frame_buff_t へ追加
+ */
+void modbus_rtu_slave::append_(frame_buff_t& dst, const std::vector<uint8_t>& src)
+{
+  if(!src.empty())
+    dst.insert(dst.end(), &src[0], &src[0] + src.size());
+}
 
-  if(crc_src != crc_calc) {
-#ifndef NDEBUG
-    debug_.printf("[DEBUG] modbus_rtu_slave[%d] readcoilstatus_(): crc error. src = %04xh calc = %04xh(%d)\r\n", adr_,crc_src, crc_calc);
-#endif
-    return true;
+/**
+ * @brief 応答フレーム領域の確保
+ * @param size crcを除くフレーム長
+ * @return 確保した領域の先頭. 送信バッファに空きが無ければNULL
+ */
+uint8_t* modbus_rtu_slave::response_begin_(size_t size)
+{
+  const size_t pos = tx_->size();
+  if(!tx_->resize(pos + size + 2))
+    return NULL;
+  return &(*tx_)[pos];
+}
+
+/**
+ * @brief 応答フレームへcrcを付加
+ * @param size crcを除くフレーム長
+ */
+void modbus_rtu_slave::response_end_(size_t size)
+{
+  uint8_t* frame = &(*tx_)[tx_->size() - size - 2];
+  const uint16_t crc = crc16(frame, size);
+  frame[size] = (0xff & crc);
+  frame[size + 1] = (crc >> 8) & 0xff;
+}
+
+/**
+ * @brief レジスタ領域からbit読み出し応答(0x01, 0x02)
+ */
+void modbus_rtu_slave::readbits_(const uint8_t* frame, const uint8_t* src, size_t src_size)
+{
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t reg_cnt = (frame[4] << 8) | frame[5];
+
+  if(reg_cnt < 1 || reg_cnt > 2000){
+    exceptionresponse(*tx_, adr_, frame[1], 0x03);
+    return;
+  }
+  if(!modbus_register_bank::in_range(start_adr, reg_cnt, src_size)){
+    exceptionresponse(*tx_, adr_, frame[1], 0x02);
+    return;
   }
-  const uint16_t start_adr = (rx_buff_[2] << 8) | rx_buff_[3];
-  const uint16_t reg_cnt = (rx_buff_[4] << 8) | rx_buff_[5];
 
-  readcoilstatus(tx_buff_, start_adr, reg_cnt);
+  const size_t data_byte = (reg_cnt + 7) / 8;
+  uint8_t* dst = response_begin_(3 + data_byte);
+  if(NULL == dst) return;
+  dst[0] = adr_;
+  dst[1] = frame[1];
+  dst[2] = (uint8_t)data_byte;
+  modbus_register_bank::read_bits(dst + 3, src, start_adr, reg_cnt);
+  response_end_(3 + data_byte);
+}
 
-#ifndef NDEBUG
-  debug_.printf("[DEBUG] modbus_rtu_slave[%d] readcoilstatus_(): complate.\r\n", adr_);
-#endif
+/**
+ * @brief レジスタ領域からregister読み出し応答(0x03, 0x04)
+ */
+void modbus_rtu_slave::readregisters_(const uint8_t* frame, const uint16_t* src, size_t src_size)
+{
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t reg_cnt = (frame[4] << 8) | frame[5];
+
+  if(reg_cnt < 1 || reg_cnt > 125){
+    exceptionresponse(*tx_, adr_, frame[1], 0x03);
+    return;
+  }
+  if(!modbus_register_bank::in_range(start_adr, reg_cnt, src_size)){
+    exceptionresponse(*tx_, adr_, frame[1], 0x02);
+    return;
+  }
 
-  return true;
+  const size_t data_byte = reg_cnt * 2;
+  uint8_t* dst = response_begin_(3 + data_byte);
+  if(NULL == dst) return;
+  dst[0] = adr_;
+  dst[1] = frame[1];
+  dst[2] = (uint8_t)data_byte;
+  modbus_register_bank::read_registers(dst + 3, src + start_adr, reg_cnt);
+  response_end_(3 + data_byte);
 }
 
 /**
  * @brief readcoilstatus応答(0x01)
  */
+void modbus_rtu_slave::readcoilstatus_(const uint8_t* frame)
+{
+  if(NULL != bank_){
+    readbits_(frame, bank_->coil(), bank_->coil_size());
+    return;
+  }
+
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t reg_cnt = (frame[4] << 8) | frame[5];
+
+  readcoilstatus(*tx_, start_adr, reg_cnt);
+
+  if(NULL != trace_)
+    trace_->put(TRACE_SLAVE_READCOILSTATUS, adr_);
+}
+
+/**
+ * @brief readcoilstatus応答(0x01)
+ */
+void modbus_rtu_slave::readcoilstatus(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt)
+{
+  std::vector<uint8_t> buf;
+  readcoilstatus(buf, start_adr, reg_cnt);
+  append_(dst, buf);
+}
+
+/**
+ * @brief readcoilstatus応答(0x01, std::vector 版)
+ */
 void modbus_rtu_slave::readcoilstatus(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt)
 {
   //例外応答を返す
@@ -127,26 +336,32 @@ void modbus_rtu_slave::readcoilstatus(std::vector<uint8_t>& dst, uint16_t start_
 /**
  * @brief readinputstatus応答(0x02)
  */
-bool modbus_rtu_slave::readinputstatus_(void)
+void modbus_rtu_slave::readinputstatus_(const uint8_t* frame)
 {
-  if(rx_buff_[1] != 0x02 ) return false;
-  if(rx_buff_.size() < 8 ) return false;
-
-  const uint16_t crc_src = rx_buff_[6] | (rx_buff_[7] << 8);
-  const uint16_t crc_calc = crc16(&rx_buff_[0], 6);
-
-  if(crc_src != crc_calc) return true;
+  if(NULL != bank_){
+    readbits_(frame, bank_->discrete(), bank_->discrete_size());
+    return;
+  }
 
-  const uint16_t start_adr = (rx_buff_[2] << 8) | rx_buff_[3];
-  const uint16_t reg_cnt = (rx_buff_[4] << 8) | rx_buff_[5];
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t reg_cnt = (frame[4] << 8) | frame[5];
 
-  readinputstatus(tx_buff_, start_adr, reg_cnt);
-  return true;
+  readinputstatus(*tx_, start_adr, reg_cnt);
 }
 
 /**
  * @brief readinputstatus応答(0x02)
  */
+void modbus_rtu_slave::readinputstatus(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt)
+{
+  std::vector<uint8_t> buf;
+  readinputstatus(buf, start_adr, reg_cnt);
+  append_(dst, buf);
+}
+
+/**
+ * @brief readinputstatus応答(0x02, std::vector 版)
+ */
 void modbus_rtu_slave::readinputstatus(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt)
 {
   //例外応答を返す
@@ -156,26 +371,32 @@ void modbus_rtu_slave::readinputstatus(std::vector<uint8_t>& dst, uint16_t start
 /**
  * @brief readholdingregister応答(0x03)
  */
-bool modbus_rtu_slave::readholdingregister_(void)
+void modbus_rtu_slave::readholdingregister_(const uint8_t* frame)
 {
-  if(rx_buff_[1] != 0x03 ) return false;
-  if(rx_buff_.size() < 8 ) return false;
-
-  const uint16_t crc_src = rx_buff_[6] | (rx_buff_[7] << 8);
-  const uint16_t crc_calc = crc16(&rx_buff_[0], 6);
-
-  if(crc_src != crc_calc) return true;
+  if(NULL != bank_){
+    readregisters_(frame, bank_->holding(), bank_->holding_size());
+    return;
+  }
 
-  const uint16_t start_adr = (rx_buff_[2] << 8) | rx_buff_[3];
-  const uint16_t reg_cnt = (rx_buff_[4] << 8) | rx_buff_[5];
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t reg_cnt = (frame[4] << 8) | frame[5];
 
-  readholdingregister(tx_buff_, start_adr, reg_cnt);
-  return true;
+  readholdingregister(*tx_, start_adr, reg_cnt);
 }
 
 /**
  * @brief readholdingregister応答(0x03)
  */
+void modbus_rtu_slave::readholdingregister(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt)
+{
+  std::vector<uint8_t> buf;
+  readholdingregister(buf, start_adr, reg_cnt);
+  append_(dst, buf);
+}
+
+/**
+ * @brief readholdingregister応答(0x03, std::vector 版)
+ */
 void modbus_rtu_slave::readholdingregister(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt)
 {
   //例外応答を返す
@@ -185,29 +406,34 @@ void modbus_rtu_slave::readholdingregister(std::vector<uint8_t>& dst, uint16_t s
 /**
  * @brief readinputregister応答(0x04)
  */
-bool modbus_rtu_slave::readinputregister_(void)
+void modbus_rtu_slave::readinputregister_(const uint8_t* frame)
 {
-  if(rx_buff_[1] != 0x04 ) return false;
-  if(rx_buff_.size() < 8 ) return false;
-
-  const uint16_t crc_src = (rx_buff_[6] >> 8) | (rx_buff_[7] << 8);
-  const uint16_t crc_calc = crc16(&rx_buff_[0], 6);
-
-  if(crc_src != crc_calc) return true;
+  if(NULL != bank_){
+    readregisters_(frame, bank_->input(), bank_->input_size());
+    return;
+  }
 
-  const uint16_t start_adr = (rx_buff_[2] << 8) | rx_buff_[3];
-  const uint16_t reg_cnt = (rx_buff_[4] << 8) | rx_buff_[5];
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t reg_cnt = (frame[4] << 8) | frame[5];
 
-  readinputregister(tx_buff_, start_adr, reg_cnt);
-  return true;
+  readinputregister(*tx_, start_adr, reg_cnt);
 }
 
 /**
  * @brief readinputregister応答(0x04)
  */
-void modbus_rtu_slave::readinputregister(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt)
+void modbus_rtu_slave::readinputregister(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt)
 {
+  std::vector<uint8_t> buf;
+  readinputregister(buf, start_adr, reg_cnt);
+  append_(dst, buf);
+}
 
+/**
+ * @brief readinputregister応答(0x04, std::vector 版)
+ */
+void modbus_rtu_slave::readinputregister(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt)
+{
   //例外応答を返す
   exceptionresponse(dst, adr_, 0x04, 0x01);
 }
@@ -215,30 +441,153 @@ void modbus_rtu_slave::readinputregister(std::vector<uint8_t>& dst, uint16_t sta
 /**
  * @brief forcesinglecoil応答(0x05)
  */
-bool modbus_rtu_slave::forcesinglecoil_(void)
+void modbus_rtu_slave::forcesinglecoil_(const uint8_t* frame)
 {
-  if(rx_buff_[1] != 0x05 ) return false;
-  if(rx_buff_.size() < 8 ) return false;
-
-  const uint16_t crc_src = (rx_buff_[6] >> 8) | (rx_buff_[7] << 8);
-  const uint16_t crc_calc = crc16(&rx_buff_[0], 6);
-
-  if(crc_src != crc_calc) return true;
+  if(NULL != bank_){
+    const uint16_t adr = (frame[2] << 8) | frame[3];
+    const uint16_t value = (frame[4] << 8) | frame[5];
+    if(value != 0xff00 && value != 0x0000){
+      exceptionresponse(*tx_, adr_, 0x05, 0x03);
+      return;
+    }
+    if(adr >= bank_->coil_size()){
+      exceptionresponse(*tx_, adr_, 0x05, 0x02);
+      return;
+    }
+    modbus_register_bank::setbit(bank_->coil(), adr, value == 0xff00);
+    tx_->insert(tx_->end(), frame, frame + 8); // 要求をそのまま返す
+    return;
+  }
 
-  const uint16_t start_adr = (rx_buff_[2] << 8) | rx_buff_[3];
-  const uint16_t value = (rx_buff_[4] << 8) | rx_buff_[5];
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t value = (frame[4] << 8) | frame[5];
 
-  forcesinglecoil(tx_buff_, start_adr, value);
-  return true;
+  forcesinglecoil(*tx_, start_adr, value);
 }
 
 /**
  * @brief forcesinglecoil応答(0x05)
  */
+void modbus_rtu_slave::forcesinglecoil(frame_buff_t& dst, uint16_t start_adr, uint16_t value)
+{
+  std::vector<uint8_t> buf;
+  forcesinglecoil(buf, start_adr, value);
+  append_(dst, buf);
+}
+
+/**
+ * @brief forcesinglecoil応答(0x05, std::vector 版)
+ */
 void modbus_rtu_slave::forcesinglecoil(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t value)
 {
   //例外応答を返す
   exceptionresponse(dst, adr_, 0x05, 0x01);
 }
 
+/**
+ * @brief presetsingleregister応答(0x06)
+ */
+void modbus_rtu_slave::presetsingleregister_(const uint8_t* frame)
+{
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t value = (frame[4] << 8) | frame[5];
+
+  if(NULL != bank_){
+    if(start_adr >= bank_->holding_size()){
+      exceptionresponse(*tx_, adr_, 0x06, 0x02);
+      return;
+    }
+    bank_->holding()[start_adr] = value;
+    tx_->insert(tx_->end(), frame, frame + 8); // 要求をそのまま返す
+    return;
+  }
+
+  presetsingleregister(*tx_, start_adr, value);
+}
+
+/**
+ * @brief presetsingleregister応答(0x06)
+ */
+void modbus_rtu_slave::presetsingleregister(frame_buff_t& dst, uint16_t start_adr, uint16_t value)
+{
+  //例外応答を返す
+  exceptionresponse(dst, adr_, 0x06, 0x01);
+}
+
+/**
+ * @brief forcemultiplecoils応答(0x0f)
+ */
+void modbus_rtu_slave::forcemultiplecoils_(const uint8_t* frame)
+{
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t reg_cnt = (frame[4] << 8) | frame[5];
+
+  if(reg_cnt < 1 || reg_cnt > 1968 || frame[6] != (reg_cnt + 7) / 8){
+    exceptionresponse(*tx_, adr_, 0x0f, 0x03);
+    return;
+  }
+
+  if(NULL != bank_){
+    if(!modbus_register_bank::in_range(start_adr, reg_cnt, bank_->coil_size())){
+      exceptionresponse(*tx_, adr_, 0x0f, 0x02);
+      return;
+    }
+    modbus_register_bank::write_bits(bank_->coil(), start_adr, frame + 7, reg_cnt);
+    uint8_t* dst = response_begin_(6);
+    if(NULL == dst) return;
+    memcpy(dst, frame, 6);
+    response_end_(6);
+    return;
+  }
+
+  forcemultiplecoils(*tx_, start_adr, reg_cnt, frame + 7);
+}
+
+/**
+ * @brief forcemultiplecoils応答(0x0f)
+ */
+void modbus_rtu_slave::forcemultiplecoils(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt, const uint8_t* values)
+{
+  //例外応答を返す
+  exceptionresponse(dst, adr_, 0x0f, 0x01);
+}
+
+/**
+ * @brief presetmultipleregisters応答(0x10)
+ */
+void modbus_rtu_slave::presetmultipleregisters_(const uint8_t* frame)
+{
+  const uint16_t start_adr = (frame[2] << 8) | frame[3];
+  const uint16_t reg_cnt = (frame[4] << 8) | frame[5];
+
+  if(reg_cnt < 1 || reg_cnt > 123 || frame[6] != reg_cnt * 2){
+    exceptionresponse(*tx_, adr_, 0x10, 0x03);
+    return;
+  }
+
+  if(NULL != bank_){
+    if(!modbus_register_bank::in_range(start_adr, reg_cnt, bank_->holding_size())){
+      exceptionresponse(*tx_, adr_, 0x10, 0x02);
+      return;
+    }
+    modbus_register_bank::write_registers(bank_->holding() + start_adr, frame + 7, reg_cnt);
+    uint8_t* dst = response_begin_(6);
+    if(NULL == dst) return;
+    memcpy(dst, frame, 6);
+    response_end_(6);
+    return;
+  }
+
+  presetmultipleregisters(*tx_, start_adr, reg_cnt, frame + 7);
+}
+
+/**
+ * @brief presetmultipleregisters応答(0x10)
+ */
+void modbus_rtu_slave::presetmultipleregisters(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt, const uint8_t* values)
+{
+  //例外応答を返す
+  exceptionresponse(dst, adr_, 0x10, 0x01);
+}
+
 } /* namespace */
@@ -6,6 +6,27 @@
  * @par history
  * - 2016-11-04 11:32:53
  *  - First.
+ * - 2026-10-17 10:21:03
+ *  - 受信データのcrcを逐次計算するよう変更.
+ * - 2026-10-17 11:02:37
+ *  - 受信バッファをmodbus_rtu_frameへ変更.
+ * - 2026-10-17 11:48:15
+ *  - 機能コードをテーブルで振り分けるよう変更.
+ * - 2026-10-17 12:30:51
+ *  - レジスタ領域(modbus_register_bank)からの直接応答, 0x06/0x0f/0x10に対応.
+ * - 2026-10-17 14:05:18
+ *  - フレーム終端を通信速度から求めたt3.5のタイムアウトで判定するよう変更.
+ * - 2026-10-17 14:52:30
+ *  - recieve_frame() に対応.
+ * - 2026-10-17 17:20:06
+ *  - 送信バッファを固定容量(frame_buff_t)へ変更. ヒープを使用しない.
+ * - 2026-10-17 19:05:33
+ *  - 複数スレーブの振り分け(modbus_rtu_slave_mux)向けに frame_length(), process() を追加.
+ * - 2026-10-17 23:58:06
+ *  - デバッグ出力を trace_log への記録(settrace())へ変更. NDEBUG に関わらず記録する.
+ *    コンストラクタの debug は未使用(互換のため残す).
+ * - 2026-10-18 00:00:10
+ *  - 0x01-0x05 の std::vector 版の仮想関数を戻し、frame_buff_t 版の既定をその変換とする.
  */
 
 #ifndef SEEKERS_MODBUS_RTU_SLAVE_HPP
@@ -15,8 +36,6 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
-#include <vector>
-
 #ifdef __MBED__
 #include "mbed.h"
 #else
@@ -24,74 +43,164 @@
 
 #include "utils.hpp"
 #include "basic_com_module.hpp"
+#include "modbus_rtu_frame.hpp"
+#include "modbus_register_bank.hpp"
+#include "trace_log.hpp"
 
 namespace seekers{
 
-class modbus_rtu_slave : public basic_com_module{
+class modbus_rtu_slave : public basic_static_com_module{
 private:
-  Timer idle_timer_;
+  Timeout frame_timer_;
 
   uint8_t adr_;
-  std::vector<uint8_t> rx_buff_;
-  std::vector<uint8_t> tx_buff_;
+  modbus_rtu_frame rx_frame_;
+  frame_buff_t tx_buff_;  // t3.5経過まで保留する応答
+  frame_buff_t* tx_;      // 応答の格納先
+  modbus_register_bank* bank_;
+
+  volatile bool frame_end_;  // 最終受信からt3.5経過
+  int t35_us_;
 
   static uint16_t crc16(const uint8_t* data, size_t size)
   {
     return crc16_ibm(data, size);
   }
 
-  typedef std::vector<uint8_t>::iterator Iter;
-  int idle_limit_;
+  static void frame_timer_handler_(modbus_rtu_slave* self);
 
-#ifdef __MBED__
-#ifndef NDEBUG
-  RawSerial& debug_;
-#endif
-#endif
+  trace_log* trace_;  // 記録先(NULLなら記録しない)
 
+  static void exceptionresponse(frame_buff_t& /*dst*/, uint8_t /*adr*/, uint8_t /*cmd*/, uint8_t /*code*/);
   static void exceptionresponse(std::vector<uint8_t>& /*dst*/, uint8_t /*adr*/, uint8_t /*cmd*/, uint8_t /*code*/);
+  static void append_(frame_buff_t& dst, const std::vector<uint8_t>& src);
 
-  bool readcoilstatus_(void);
-  bool readinputstatus_(void);
-  bool readholdingregister_(void);
-  bool readinputregister_(void);
-  bool forcesinglecoil_(void);
+  void recieve_(const uint8_t* src, size_t size);
+
+  uint8_t* response_begin_(size_t size);
+  void response_end_(size_t size);
+
+  void readbits_(const uint8_t* frame, const uint8_t* src, size_t src_size);
+  void readregisters_(const uint8_t* frame, const uint16_t* src, size_t src_size);
+
+  void readcoilstatus_(const uint8_t* frame);
+  void readinputstatus_(const uint8_t* frame);
+  void readholdingregister_(const uint8_t* frame);
+  void readinputregister_(const uint8_t* frame);
+  void forcesinglecoil_(const uint8_t* frame);
+  void presetsingleregister_(const uint8_t* frame);
+  void forcemultiplecoils_(const uint8_t* frame);
+  void presetmultipleregisters_(const uint8_t* frame);
+
+  /**
+   * @brief 機能コード毎の処理定義
+   * length が 0 の場合は count_pos 位置のbyte数からフレーム長を求める
+   * (count_pos + 1 + データbyte数 + crc)
+   */
+  struct function_t{
+    uint8_t length;
+    uint8_t count_pos;
+    void (modbus_rtu_slave::*handler)(const uint8_t* frame);
+  };
+  static const function_t functions_[256];
 
 protected:
 
+  /*
+   * 0x01-0x05 の frame_buff_t 版の既定は std::vector 版への変換(一時領域にヒープを使用する).
+   * std::vector 版のみ再定義した既存の派生クラスはそのまま呼び出される.
+   * ヒープを使用しない場合は frame_buff_t 版を再定義すること.
+   */
   virtual void readcoilstatus(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt);
   virtual void readinputstatus(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt);
   virtual void readholdingregister(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt);
   virtual void readinputregister(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t reg_cnt);
-  virtual void forcesinglecoil(std::vector<uint8_t>&dst, uint16_t start_adr, uint16_t value);
+  virtual void forcesinglecoil(std::vector<uint8_t>& dst, uint16_t start_adr, uint16_t value);
+
+  virtual void readcoilstatus(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt);
+  virtual void readinputstatus(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt);
+  virtual void readholdingregister(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt);
+  virtual void readinputregister(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt);
+  virtual void forcesinglecoil(frame_buff_t& dst, uint16_t start_adr, uint16_t value);
+  virtual void presetsingleregister(frame_buff_t& dst, uint16_t start_adr, uint16_t value);
+  virtual void forcemultiplecoils(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt, const uint8_t* values);
+  virtual void presetmultipleregisters(frame_buff_t& dst, uint16_t start_adr, uint16_t reg_cnt, const uint8_t* values);
 
 public:
+  using basic_static_com_module::recieve;
+  using basic_static_com_module::recieve_frame;
+  using basic_static_com_module::idle;
 
 #ifndef NDEBUG
-  modbus_rtu_slave(RawSerial& debug, uint8_t adr = 1) :
-    adr_(adr),
-    idle_limit_(4),
-    debug_(debug)
+  modbus_rtu_slave(RawSerial& /*debug*/, uint8_t adr = 1) :
 #else
   modbus_rtu_slave(uint8_t adr = 1) :
-    adr_(adr),
-    idle_limit_(4)
 #endif
+    adr_(adr),
+    tx_(&tx_buff_),
+    bank_(NULL),
+    frame_end_(true),
+    t35_us_(modbus_rtu_timing::t35_us(9600, 10)),
+    trace_(NULL)
+  {}
+
+  virtual ~modbus_rtu_slave(){}
+
+  /**
+   * @brief レジスタ領域の割り当て
+   * 割り当て後は 0x01-0x06, 0x0f, 0x10 を仮想関数を介さずレジスタ領域から応答する.
+   * NULLで解除.
+   */
+  void bind(modbus_register_bank* bank)
   {
-    idle_timer_.start();
+    bank_ = bank;
   }
 
-  virtual ~modbus_rtu_slave(){}
+  /**
+   * @brief 通信速度の設定
+   * @param baud 通信速度[bps]
+   * @param bit_length 1文字のbit長(スタート + データ + パリティ + ストップ)
+   */
+  void timing(int baud, int bit_length)
+  {
+    t35_us_ = modbus_rtu_timing::t35_us(baud, bit_length);
+  }
+
+  uint8_t address(void) const
+  {
+    return adr_;
+  }
+
+  /**
+   * @brief 記録先の設定(NULLで記録しない)
+   */
+  void settrace(trace_log* trace)
+  {
+    trace_ = trace;
+  }
+
+  static int frame_length(const uint8_t* data, size_t size);
+
+  /**
+   * @brief crc判定済みの1フレームを処理し、応答を tx_buff へ格納する
+   */
+  void process(frame_buff_t& tx_buff, const uint8_t* frame);
 
   /**
    * @brief 受信処理
    */
-  void recieve(std::vector<uint8_t>& tx_buff, const uint8_t* src, size_t size);
+  void recieve(frame_buff_t& tx_buff, const uint8_t* src, size_t size);
+
+  /**
+   * @brief フレーム単位の受信処理
+   * フレーム終端検出済みのため、t3.5を待たずに応答を tx_buff へ直接格納する.
+   */
+  void recieve_frame(frame_buff_t& tx_buff, const uint8_t* src, size_t size);
 
   /**
    * @brief アイドル動作
    */
-  void idle(std::vector<uint8_t>& tx_buff);
+  void idle(frame_buff_t& tx_buff);
 };
 
 } /* namespace */
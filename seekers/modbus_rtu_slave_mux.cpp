@@ -0,0 +1,168 @@
+/**
+ * @file modbus_rtu_slave_mux.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 19:05:33
+ *  - first.
+ */
+
+#include "modbus_rtu_slave_mux.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンストラクタ
+ */
+modbus_rtu_slave_mux::modbus_rtu_slave_mux() :
+  tx_(&tx_buff_),
+  frame_end_(true),
+  t35_us_(modbus_rtu_timing::t35_us(9600, 10)),
+  broadcasts_(0)
+{
+  for(int ii = 0; ii < 256; ++ii)
+    units_[ii] = NULL;
+}
+
+/**
+ * @brief スレーブの登録
+ * @return アドレスが0(ブロードキャスト)または登録済みならfalse
+ */
+bool modbus_rtu_slave_mux::attach(modbus_rtu_slave* unit)
+{
+  const uint8_t adr = unit->address();
+  if(0 == adr || NULL != units_[adr]) return false;
+  units_[adr] = unit;
+  return true;
+}
+
+/**
+ * @brief スレーブの登録解除
+ */
+void modbus_rtu_slave_mux::detach(uint8_t adr)
+{
+  units_[adr] = NULL;
+}
+
+/**
+ * @brief 受信処理
+ * 応答はt3.5経過まで保留し、idle() で渡す.
+ */
+void modbus_rtu_slave_mux::recieve(frame_buff_t& /*tx_buff*/, const uint8_t* src, size_t size)
+{
+  if(frame_end_)
+    rx_frame_.clear();
+
+  frame_end_ = false;
+  frame_timer_.attach_us(callback(this, &modbus_rtu_slave_mux::frame_timer_handler_), t35_us_);
+  recieve_(src, size);
+}
+
+/**
+ * @brief フレーム単位の受信処理
+ * フレーム終端検出済みのため、t3.5を待たずに応答を tx_buff へ直接格納する.
+ */
+void modbus_rtu_slave_mux::recieve_frame(frame_buff_t& tx_buff, const uint8_t* src, size_t size)
+{
+  frame_timer_.detach();
+  frame_end_ = true;
+  idle(tx_buff); // 保留中の応答
+
+  rx_frame_.clear();
+  tx_ = &tx_buff;
+  recieve_(src, size);
+  tx_ = &tx_buff_;
+}
+
+/**
+ * @brief アイドル処理
+ */
+void modbus_rtu_slave_mux::idle(frame_buff_t& tx_buff)
+{
+  if(frame_end_ && !tx_buff_.empty() ){
+    tx_buff.insert(tx_buff.end(), tx_buff_.begin(), tx_buff_.end());
+    tx_buff_.clear();
+  }
+}
+
+/**
+ * @brief t3.5経過(フレーム終端)
+ */
+void modbus_rtu_slave_mux::frame_timer_handler_(modbus_rtu_slave_mux* self)
+{
+  self->frame_end_ = true;
+}
+
+/**
+ * @brief 頭出し
+ * 先頭が登録済みのアドレスまたは0となるまでデータを読み捨てる
+ */
+void modbus_rtu_slave_mux::seek_(void)
+{
+  size_t skip = 0;
+  while(skip < rx_frame_.size() && 0 != rx_frame_[skip] && NULL == units_[rx_frame_[skip]])
+    ++skip;
+  if(0 != skip)
+    rx_frame_.consume(skip);
+}
+
+/**
+ * @brief 受信データの解析と振り分け
+ */
+void modbus_rtu_slave_mux::recieve_(const uint8_t* src, size_t size)
+{
+  rx_frame_.append(src, size);
+
+  for(;;){
+    seek_();
+
+    const int length = modbus_rtu_slave::frame_length(rx_frame_.data(), rx_frame_.size());
+    if(length < 0){
+      // 未対応の機能コード. 頭出しからやり直す
+      rx_frame_.consume(1);
+      continue;
+    }
+    if(0 == length || rx_frame_.size() < (size_t)length )
+      return;
+
+    if(!rx_frame_.crc_check(length)){
+      rx_frame_.consume(1);
+      continue;
+    }
+
+    const uint8_t* frame = rx_frame_.data();
+    if(0 == frame[0])
+      broadcast_(frame);
+    else
+      units_[frame[0]]->process(*tx_, frame);
+    rx_frame_.consume(length);
+  }
+}
+
+/**
+ * @brief ブロードキャストの処理
+ * 書き込みのみ全スレーブで処理し、応答は破棄する.
+ */
+void modbus_rtu_slave_mux::broadcast_(const uint8_t* frame)
+{
+  switch(frame[1]){
+  case 0x05:
+  case 0x06:
+  case 0x0f:
+  case 0x10:
+    break;
+  default:
+    return;
+  }
+
+  frame_buff_t discard;
+  for(int ii = 1; ii < 256; ++ii){
+    if(NULL == units_[ii]) continue;
+    discard.clear();
+    units_[ii]->process(discard, frame);
+  }
+  ++broadcasts_;
+}
+
+} /* namespace */
@@ -0,0 +1,88 @@
+/**
+ * @file modbus_rtu_slave_mux.hpp
+ * @brief MODBUS RTU 複数スレーブの振り分け
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 19:05:33
+ *  - First.
+ */
+
+#ifndef SEEKERS_MODBUS_RTU_SLAVE_MUX_HPP
+#define SEEKERS_MODBUS_RTU_SLAVE_MUX_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#endif
+
+#include "basic_com_module.hpp"
+#include "modbus_rtu_frame.hpp"
+#include "modbus_rtu_slave.hpp"
+
+namespace seekers{
+
+/**
+ * @brief MODBUS RTU 複数スレーブの振り分け
+ * 1つのバス上で複数のスレーブ(modbus_rtu_slave)を動作させる.
+ * 受信データは1度だけ解析し、アドレス表から該当するスレーブへフレームを渡す.
+ * アドレス0(ブロードキャスト)の書き込み(0x05, 0x06, 0x0f, 0x10)は全スレーブで処理し、応答しない.
+ * 各スレーブの recieve(), idle() は呼び出さないこと.
+ */
+class modbus_rtu_slave_mux : public basic_static_com_module{
+private:
+  Timeout frame_timer_;
+
+  modbus_rtu_slave* units_[256];  // アドレス -> スレーブ
+  modbus_rtu_frame rx_frame_;
+  frame_buff_t tx_buff_;          // t3.5経過まで保留する応答
+  frame_buff_t* tx_;              // 応答の格納先
+
+  volatile bool frame_end_;  // 最終受信からt3.5経過
+  int t35_us_;
+
+  uint32_t broadcasts_;
+
+  static void frame_timer_handler_(modbus_rtu_slave_mux* self);
+
+  void recieve_(const uint8_t* src, size_t size);
+  void broadcast_(const uint8_t* frame);
+  void seek_(void);
+
+public:
+  using basic_static_com_module::recieve;
+  using basic_static_com_module::recieve_frame;
+  using basic_static_com_module::idle;
+
+  modbus_rtu_slave_mux();
+
+  bool attach(modbus_rtu_slave* unit);
+  void detach(uint8_t adr);
+
+  /**
+   * @brief 通信速度の設定
+   * @param baud 通信速度[bps]
+   * @param bit_length 1文字のbit長(スタート + データ + パリティ + ストップ)
+   */
+  void timing(int baud, int bit_length)
+  {
+    t35_us_ = modbus_rtu_timing::t35_us(baud, bit_length);
+  }
+
+  /**
+   * @brief 処理したブロードキャストの数
+   */
+  uint32_t broadcasts(void) const { return broadcasts_; }
+
+  void recieve(frame_buff_t& tx_buff, const uint8_t* src, size_t size);
+  void recieve_frame(frame_buff_t& tx_buff, const uint8_t* src, size_t size);
+  void idle(frame_buff_t& tx_buff);
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_RTU_SLAVE_MUX_HPP */
@@ -0,0 +1,250 @@
+/**
+ * @file modbus_rtu_write_cache.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 18:42:09
+ *  - first.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラを client_ へ設定し、要求の前に setclient() で要求元を指定するよう変更.
+ * - 2026-10-18 00:00:20
+ *  - 点を追加できない書き込みは false を返し、rejected_ で数える.
+ */
+
+#include "modbus_rtu_write_cache.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンストラクタ
+ */
+modbus_rtu_write_cache::modbus_rtu_write_cache(modbus_rtu_master& master) :
+  master_(master),
+  num_(0),
+  pending_(-1),
+  pending_cnt_(0),
+  writes_(0),
+  suppressed_(0),
+  errors_(0),
+  rejected_(0)
+{
+  client_.setcontext(this);
+  client_.sethandler(write_handler_, modbus_rtu_master::FORCESINGLECOIL);
+  client_.sethandler(write_handler_, modbus_rtu_master::PRESETSINGLEREGISTER);
+  client_.sethandler(write_handler_, modbus_rtu_master::FORCEMULTIPLECOILS);
+  client_.sethandler(write_handler_, modbus_rtu_master::PRESETMULTIPLEREGISTERS);
+  client_.sethandler(exception_handler_, modbus_rtu_master::EXCEPTIONRESPONSE);
+  client_.settimeout_handler(timeout_handler_);
+}
+
+/**
+ * @brief 点の検索(二分探索)
+ * @param insert 無ければ整列順を保って追加する
+ * @return 位置. 無い(追加できない)場合は -1
+ */
+int modbus_rtu_write_cache::find_(uint8_t slave, uint8_t cmd, uint16_t reg_adr, bool insert)
+{
+  const uint32_t key = ((uint32_t)slave << 24) | ((uint32_t)cmd << 16) | reg_adr;
+  int lo = 0;
+  int hi = num_;
+  while(lo < hi){
+    const int mid = (lo + hi) / 2;
+    const entry_t& e = entries_[mid];
+    const uint32_t k = ((uint32_t)e.slave << 24) | ((uint32_t)e.cmd << 16) | e.reg_adr;
+    if(k == key) return mid;
+    if(k < key) lo = mid + 1;
+    else hi = mid;
+  }
+  if(!insert || num_ >= CAPACITY) return -1;
+
+  for(int ii = num_; ii > lo; --ii)
+    entries_[ii] = entries_[ii - 1];
+  if(pending_ >= 0 && lo <= pending_) ++pending_; // 送信中の範囲はアドレスが連続するため、途中への追加は無い
+  ++num_;
+
+  entry_t& e = entries_[lo];
+  e.slave = slave;
+  e.cmd = cmd;
+  e.reg_adr = reg_adr;
+  e.value = e.shadow = e.sent = 0;
+  e.known = false;
+  e.dirty = false;
+  return lo;
+}
+
+/**
+ * @brief 書き込み
+ * 書き込み済み(または送信中)の値と同じなら送信しない
+ * @return 点を追加できない(CAPACITY に達している)場合 false
+ */
+bool modbus_rtu_write_cache::write_(uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t value)
+{
+  const int pos = find_(slave, cmd, reg_adr, true);
+  if(pos < 0){
+    ++rejected_;
+    return false;
+  }
+
+  entry_t& e = entries_[pos];
+  const bool sending = (pending_ >= 0 && pos >= pending_ && pos < pending_ + pending_cnt_);
+  e.value = value;
+  if(sending){
+    e.dirty = (value != e.sent);
+    return true;
+  }
+  if(e.known && value == e.shadow){
+    if(!e.dirty) ++suppressed_;
+    e.dirty = false;
+    return true;
+  }
+  e.dirty = true;
+  return true;
+}
+
+/**
+ * @brief スレーブの書き込み済みの値を破棄
+ * スレーブの再起動時等. 以降の書き込みは値によらず送信する.
+ */
+void modbus_rtu_write_cache::invalidate(uint8_t slave)
+{
+  for(int ii = 0; ii < num_; ++ii){
+    if(entries_[ii].slave == slave)
+      entries_[ii].known = false;
+  }
+}
+
+/**
+ * @brief 未送信(送信中を含む)の点があるか
+ */
+bool modbus_rtu_write_cache::dirty(void) const
+{
+  if(pending_ >= 0) return true;
+  for(int ii = 0; ii < num_; ++ii){
+    if(entries_[ii].dirty)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief 送信処理
+ * 整列順で最初の未送信の点から、同じスレーブ/種別でアドレスが連続する未送信の点
+ * (コイル1968点, レジスタ123点まで)を1要求にまとめる.
+ */
+void modbus_rtu_write_cache::poll(std::vector<uint8_t>& tx_buff)
+{
+  if(pending_ >= 0 && !master_.busy(client_))
+    complete_(false); // 応答ハンドラ呼び出し無し(crcエラー等)
+
+  if(pending_ >= 0 || !master_.ready())
+    return;
+
+  int first = 0;
+  while(first < num_ && !entries_[first].dirty)
+    ++first;
+  if(first >= num_)
+    return;
+
+  const entry_t& head = entries_[first];
+  const int limit = (head.cmd == 0x05) ? 1968 : 123;
+  int cnt = 1;
+  while(first + cnt < num_ && cnt < limit){
+    const entry_t& e = entries_[first + cnt];
+    if(!e.dirty || e.slave != head.slave || e.cmd != head.cmd
+       || e.reg_adr != head.reg_adr + cnt)
+      break;
+    ++cnt;
+  }
+
+  for(int ii = first; ii < first + cnt; ++ii){
+    entries_[ii].sent = entries_[ii].value;
+    entries_[ii].dirty = false;
+  }
+
+  master_.setclient(&client_);
+  if(1 == cnt){
+    if(head.cmd == 0x05)
+      master_.request_forcesinglecoil(tx_buff, head.slave, head.reg_adr, 0 != head.sent);
+    else
+      master_.request_presetsingleregister(tx_buff, head.slave, head.reg_adr, head.sent);
+  }
+  else if(head.cmd == 0x05){
+    uint8_t bits[(1968 + 7) / 8] = { 0 };
+    for(int ii = 0; ii < cnt; ++ii){
+      if(entries_[first + ii].sent)
+        bits[ii >> 3] |= 1 << (ii & 7);
+    }
+    master_.request_forcemultiplecoils(tx_buff, head.slave, head.reg_adr, cnt, bits);
+  }
+  else{
+    uint16_t values[123];
+    for(int ii = 0; ii < cnt; ++ii)
+      values[ii] = entries_[first + ii].sent;
+    master_.request_presetmultipleregisters(tx_buff, head.slave, head.reg_adr, cnt, values);
+  }
+  ++writes_;
+
+  if(0 == head.slave){
+    // ブロードキャストは応答が無いため送信で完了とする
+    pending_ = first;
+    pending_cnt_ = cnt;
+    complete_(true);
+    return;
+  }
+  pending_ = first;
+  pending_cnt_ = cnt;
+}
+
+/**
+ * @brief 送信中の点の完了
+ * @param ok 書き込み成功. 失敗なら未送信に戻す
+ */
+void modbus_rtu_write_cache::complete_(bool ok)
+{
+  if(pending_ < 0) return;
+
+  for(int ii = pending_; ii < pending_ + pending_cnt_; ++ii){
+    entry_t& e = entries_[ii];
+    if(ok){
+      e.shadow = e.sent;
+      e.known = true;
+      e.dirty = (e.value != e.shadow);
+    }
+    else{
+      e.dirty = true;
+    }
+  }
+  if(!ok) ++errors_;
+  pending_ = -1;
+  pending_cnt_ = 0;
+}
+
+/**
+ * @brief modbus_rtu_master 書き込み応答ハンドラ
+ */
+void modbus_rtu_write_cache::write_handler_(modbus_rtu_master* master, uint8_t, uint8_t, uint16_t, uint16_t)
+{
+  modbus_rtu_write_cache* self = (modbus_rtu_write_cache*)master->context();
+  self->complete_(true);
+}
+
+/**
+ * @brief modbus_rtu_master 例外応答ハンドラ
+ */
+void modbus_rtu_write_cache::exception_handler_(modbus_rtu_master* master, const uint8_t*, size_t)
+{
+  modbus_rtu_write_cache* self = (modbus_rtu_write_cache*)master->context();
+  self->complete_(false);
+}
+
+/**
+ * @brief modbus_rtu_master 応答待ちタイムアウトハンドラ
+ */
+void modbus_rtu_write_cache::timeout_handler_(modbus_rtu_master* master, uint8_t /*slave*/, uint8_t /*cmd*/)
+{
+  modbus_rtu_write_cache* self = (modbus_rtu_write_cache*)master->context();
+  self->complete_(false);
+}
+
+} /* namespace */
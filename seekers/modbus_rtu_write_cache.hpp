@@ -0,0 +1,122 @@
+/**
+ * @file modbus_rtu_write_cache.hpp
+ * @brief MODBUS RTU マスター 書き込みキャッシュ
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 18:42:09
+ *  - First.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラを modbus_rtu_master::client で設定し、マスターを他の要求元と共有できるよう変更.
+ * - 2026-10-18 00:00:20
+ *  - write_coil(), write_register() は点を追加できない場合 false を返し、rejected() で数える.
+ */
+
+#ifndef SEEKERS_MODBUS_RTU_WRITE_CACHE_HPP
+#define SEEKERS_MODBUS_RTU_WRITE_CACHE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <vector>
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#endif
+
+#include "modbus_rtu_master.hpp"
+
+namespace seekers{
+
+/**
+ * @brief MODBUS RTU マスター 書き込みキャッシュ
+ * スレーブ毎のコイル/保持レジスタについて、書き込み済みの値(shadow)を保持する.
+ * write_coil(), write_register() はshadowと異なる値のみ未送信とし、
+ * poll() で未送信の点を送信する. アドレスが連続する未送信の点は 0x0f/0x10 で
+ * まとめて、単独の点は 0x05/0x06 で書き込む.
+ * 応答(エコー)を受信した時点でshadowを更新する. 例外応答, タイムアウトの点は未送信のまま再送する.
+ * 応答ハンドラは要求元(modbus_rtu_master::client)として設定するため、1つのマスターを
+ * 他の要求元(プランナー, スケジューラ, 書き込みキャッシュ, ゲートウェイ)と共有できる.
+ */
+class modbus_rtu_write_cache{
+public:
+  static const int CAPACITY = 128;
+
+private:
+  struct entry_t{
+    uint8_t slave;
+    uint8_t cmd;       // 0x05: コイル, 0x06: 保持レジスタ
+    uint16_t reg_adr;
+    uint16_t value;    // 書き込む値
+    uint16_t shadow;   // 書き込み済みの値
+    uint16_t sent;     // 送信中の値
+    bool known;        // shadowが有効
+    bool dirty;        // 未送信
+  };
+
+  modbus_rtu_master& master_;
+  modbus_rtu_master::client client_;  // 応答ハンドラ, context
+  entry_t entries_[CAPACITY];  // (スレーブ, 種別, アドレス)順
+  int num_;
+
+  int pending_;      // 送信中の先頭(-1:なし)
+  int pending_cnt_;
+
+  uint32_t writes_;      // 送信した要求数
+  uint32_t suppressed_;  // shadowと同じ値のため送信しなかった書き込み数
+  uint32_t errors_;
+  uint32_t rejected_;    // 点を追加できず受け付けなかった書き込み数
+
+  int find_(uint8_t slave, uint8_t cmd, uint16_t reg_adr, bool insert);
+  bool write_(uint8_t slave, uint8_t cmd, uint16_t reg_adr, uint16_t value);
+  void complete_(bool ok);
+
+  static void write_handler_(modbus_rtu_master*, uint8_t, uint8_t, uint16_t, uint16_t);
+  static void exception_handler_(modbus_rtu_master*, const uint8_t*, size_t);
+  static void timeout_handler_(modbus_rtu_master*, uint8_t, uint8_t);
+
+public:
+  explicit modbus_rtu_write_cache(modbus_rtu_master& master);
+
+  /**
+   * @brief コイルへの書き込み
+   * @return 点が CAPACITY に達していて追加できない場合 false(書き込まない)
+   */
+  bool write_coil(uint8_t slave, uint16_t reg_adr, bool value)
+  {
+    return write_(slave, 0x05, reg_adr, value ? 1 : 0);
+  }
+
+  /**
+   * @brief 保持レジスタへの書き込み
+   * @return 点が CAPACITY に達していて追加できない場合 false(書き込まない)
+   */
+  bool write_register(uint8_t slave, uint16_t reg_adr, uint16_t value)
+  {
+    return write_(slave, 0x06, reg_adr, value);
+  }
+
+  void invalidate(uint8_t slave);
+
+  /**
+   * @brief 送信処理
+   * modbus_rtu_master::idle() の後に呼び出す. 送信可能なら未送信の点の書き込み要求を tx_buff へ追加する.
+   */
+  void poll(std::vector<uint8_t>& tx_buff);
+
+  /**
+   * @brief 未送信(送信中を含む)の点があるか
+   */
+  bool dirty(void) const;
+
+  uint32_t writes(void) const { return writes_; }
+  uint32_t suppressed(void) const { return suppressed_; }
+  uint32_t errors(void) const { return errors_; }
+  uint32_t rejected(void) const { return rejected_; }
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_RTU_WRITE_CACHE_HPP */
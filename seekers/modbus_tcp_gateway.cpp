@@ -0,0 +1,367 @@
+/**
+ * @file modbus_tcp_gateway.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 20:32:07
+ *  - first.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラを client_ へ設定し、要求の前に setclient() で要求元を指定するよう変更.
+ */
+
+#include "modbus_tcp_gateway.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンストラクタ
+ */
+modbus_tcp_gateway::modbus_tcp_gateway(modbus_rtu_master& master, sink& out) :
+  master_(master),
+  sink_(out),
+  queue_head_(0),
+  queue_num_(0),
+  in_flight_(false),
+  local_(0),
+  forwarded_(0),
+  exceptions_(0),
+  discarded_(0),
+  queue_peak_(0)
+{
+  for(int ii = 0; ii < 256; ++ii){
+    units_[ii].local = NULL;
+    units_[ii].serial = false;
+  }
+  for(int ii = 0; ii < CONNECTION_NUM; ++ii){
+    connections_[ii].opened = false;
+    connections_[ii].generation = 0;
+    connections_[ii].len = 0;
+  }
+
+  client_.setcontext(this);
+  for(int ii = 0; ii < modbus_rtu_master::HANDLER_TYPE_NUM; ++ii)
+    client_.sethandler(response_handler_, (modbus_rtu_master::handler_type_t)ii);
+  client_.settimeout_handler(timeout_handler_);
+}
+
+bool modbus_tcp_gateway::attach(modbus_rtu_slave* unit)
+{
+  const uint8_t adr = unit->address();
+  if(0 == adr || NULL != units_[adr].local) return false;
+  units_[adr].local = unit;
+  return true;
+}
+
+/**
+ * @brief 接続の開始
+ */
+bool modbus_tcp_gateway::open(int conn, mode_t mode)
+{
+  if(conn < 0 || conn >= CONNECTION_NUM) return false;
+  connection_t& c = connections_[conn];
+  c.opened = true;
+  c.mode = mode;
+  c.generation++;
+  c.len = 0;
+  return true;
+}
+
+/**
+ * @brief 接続の終了
+ * キュー中の要求は送信せずに破棄する. 送信中の要求は応答を破棄する.
+ */
+void modbus_tcp_gateway::close(int conn)
+{
+  if(conn < 0 || conn >= CONNECTION_NUM) return;
+  connection_t& c = connections_[conn];
+  c.opened = false;
+  c.generation++;
+  c.len = 0;
+}
+
+bool modbus_tcp_gateway::alive_(const transaction_t& tr) const
+{
+  const connection_t& c = connections_[tr.conn];
+  return c.opened && c.generation == tr.generation;
+}
+
+/**
+ * @brief TCP 受信データの処理
+ */
+void modbus_tcp_gateway::recieve(int conn, const uint8_t* src, size_t size)
+{
+  if(conn < 0 || conn >= CONNECTION_NUM) return;
+  connection_t& c = connections_[conn];
+  if(!c.opened) return;
+
+  while(0 != size){
+    size_t n = sizeof(c.buff) - c.len;
+    if(n > size) n = size;
+    memcpy(c.buff + c.len, src, n);
+    c.len += n;
+    src += n;
+    size -= n;
+
+    if(MODE_MBAP == c.mode)
+      parse_mbap_(conn);
+    else
+      parse_rtu_(conn);
+  }
+}
+
+/**
+ * @brief MBAP ヘッダ付き要求の取り出し
+ * ヘッダの長さが範囲外なら以降の区切りが不明のため、受信済みのデータを全て破棄する.
+ */
+void modbus_tcp_gateway::parse_mbap_(int conn)
+{
+  connection_t& c = connections_[conn];
+  size_t pos = 0;
+  while(c.len - pos >= 7){
+    const uint8_t* adu = c.buff + pos;
+    const uint16_t tid = (adu[0] << 8) | adu[1];
+    const uint16_t protocol = (adu[2] << 8) | adu[3];
+    const uint16_t length = (adu[4] << 8) | adu[5];  // ユニットID + PDU
+    if(length < 2 || length > PDU_SIZE + 1){
+      ++discarded_;
+      c.len = 0;
+      return;
+    }
+    if(c.len - pos < 6u + length)
+      break;
+
+    if(0 == protocol)
+      request_(conn, tid, adu[6], adu + 7, length - 1);
+    else
+      ++discarded_;
+    pos += 6 + length;
+  }
+  if(0 != pos){
+    memmove(c.buff, c.buff + pos, c.len - pos);
+    c.len -= pos;
+  }
+}
+
+/**
+ * @brief RTU over TCP 要求の取り出し
+ * フレーム長は機能コードから判定する(modbus_rtu_slave が対応する機能コードのみ).
+ */
+void modbus_tcp_gateway::parse_rtu_(int conn)
+{
+  connection_t& c = connections_[conn];
+  size_t pos = 0;
+  for(;;){
+    const uint8_t* frame = c.buff + pos;
+    const int length = modbus_rtu_slave::frame_length(frame, c.len - pos);
+    if(length < 0 || (length > 0 && c.len - pos >= (size_t)length && 0 != crc16_ibm(frame, length))){
+      // 未対応の機能コード, crc異常. 1byteずつ読み捨てる
+      ++discarded_;
+      ++pos;
+      continue;
+    }
+    if(0 == length || c.len - pos < (size_t)length)
+      break;
+
+    request_(conn, 0, frame[0], frame + 1, length - 3);
+    pos += length;
+  }
+  if(0 != pos){
+    memmove(c.buff, c.buff + pos, c.len - pos);
+    c.len -= pos;
+  }
+}
+
+/**
+ * @brief 要求の受け付け
+ * MODBUS TCP で自局のユニットはその場で応答する. それ以外は要求キューへ積む.
+ * 要求キューが満杯なら例外(0x06: slave device busy)を応答する.
+ */
+void modbus_tcp_gateway::request_(int conn, uint16_t tid, uint8_t unit, const uint8_t* pdu, size_t pdu_len)
+{
+  const connection_t& c = connections_[conn];
+  const bool queue_full = (QUEUE_SIZE == queue_num_);
+  const bool immediate = (MODE_MBAP == c.mode && NULL != units_[unit].local);
+
+  transaction_t tmp;
+  transaction_t& tr = (immediate || queue_full) ? tmp : queue_[(queue_head_ + queue_num_) % QUEUE_SIZE];
+  tr.conn = conn;
+  tr.generation = c.generation;
+  tr.mode = c.mode;
+  tr.tid = tid;
+  tr.unit = unit;
+  tr.pdu_len = (uint8_t)pdu_len;
+  memcpy(tr.pdu, pdu, pdu_len);
+
+  if(immediate){
+    process_local_(tr);
+    return;
+  }
+  if(queue_full){
+    exception_(tr, 0x06);
+    return;
+  }
+  if(++queue_num_ > queue_peak_)
+    queue_peak_ = queue_num_;
+}
+
+void modbus_tcp_gateway::pop_(void)
+{
+  queue_head_ = (queue_head_ + 1) % QUEUE_SIZE;
+  --queue_num_;
+}
+
+/**
+ * @brief アイドル処理
+ */
+void modbus_tcp_gateway::idle(std::vector<uint8_t>& serial_tx)
+{
+  if(in_flight_ && !master_.busy(client_)){
+    // crc異常, エコー不一致等でマスターが応答を破棄した
+    if(alive_(queue_[queue_head_]))
+      exception_(queue_[queue_head_], 0x0b);
+    pop_();
+    in_flight_ = false;
+  }
+
+  while(!in_flight_ && 0 != queue_num_){
+    const transaction_t& tr = queue_[queue_head_];
+    const unit_t& unit = units_[tr.unit];
+    if(!alive_(tr)){
+      pop_();
+      continue;
+    }
+    if(NULL != unit.local){
+      process_local_(tr);
+      pop_();
+      continue;
+    }
+    if(!unit.serial){
+      exception_(tr, 0x0a); // gateway path unavailable
+      pop_();
+      continue;
+    }
+    if(!master_.ready())
+      return;
+    master_.setclient(&client_);
+    if(!master_.request_pdu(serial_tx, tr.unit, tr.pdu, tr.pdu_len)){
+      exception_(tr, 0x01);
+      pop_();
+      continue;
+    }
+    ++forwarded_;
+    if(0 == tr.unit){
+      pop_(); // ブロードキャストは応答無し
+      continue;
+    }
+    in_flight_ = true;
+  }
+}
+
+/**
+ * @brief 自局のスレーブで処理して応答
+ */
+void modbus_tcp_gateway::process_local_(const transaction_t& tr)
+{
+  uint8_t frame[1 + PDU_SIZE + 2];
+  frame[0] = tr.unit;
+  memcpy(frame + 1, tr.pdu, tr.pdu_len);
+  const size_t size = 1 + tr.pdu_len + 2;
+  const uint16_t crc = crc16_ibm(frame, size - 2);
+  frame[size - 2] = (0xff & crc);
+  frame[size - 1] = (crc >> 8) & 0xff;
+
+  const int length = modbus_rtu_slave::frame_length(frame, size);
+  if(length < 0){
+    exception_(tr, 0x01);
+    return;
+  }
+  if((size_t)length != size){
+    exception_(tr, 0x03);
+    return;
+  }
+
+  frame_buff_t rsp;
+  units_[tr.unit].local->process(rsp, frame);
+  ++local_;
+  if(rsp.size() < 4){
+    exception_(tr, 0x04);
+    return;
+  }
+  respond_(tr, rsp.data() + 1, rsp.size() - 3);
+}
+
+/**
+ * @brief 応答の送信
+ */
+void modbus_tcp_gateway::respond_(const transaction_t& tr, const uint8_t* pdu, size_t pdu_len)
+{
+  uint8_t adu[ADU_SIZE];
+  size_t size = 0;
+  if(MODE_MBAP == tr.mode){
+    adu[0] = (uint8_t)(tr.tid >> 8);
+    adu[1] = (uint8_t)(tr.tid);
+    adu[2] = 0x00;
+    adu[3] = 0x00;
+    adu[4] = (uint8_t)((pdu_len + 1) >> 8);
+    adu[5] = (uint8_t)(pdu_len + 1);
+    adu[6] = tr.unit;
+    memcpy(adu + 7, pdu, pdu_len);
+    size = 7 + pdu_len;
+  }else{
+    adu[0] = tr.unit;
+    memcpy(adu + 1, pdu, pdu_len);
+    const uint16_t crc = crc16_ibm(adu, 1 + pdu_len);
+    adu[1 + pdu_len] = (0xff & crc);
+    adu[2 + pdu_len] = (crc >> 8) & 0xff;
+    size = 3 + pdu_len;
+  }
+  sink_.send(tr.conn, adu, size);
+}
+
+/**
+ * @brief 例外応答
+ */
+void modbus_tcp_gateway::exception_(const transaction_t& tr, uint8_t code)
+{
+  const uint8_t pdu[2] = { (uint8_t)(0x80 | tr.pdu[0]), code };
+  ++exceptions_;
+  respond_(tr, pdu, 2);
+}
+
+/**
+ * @brief シリアル側の応答(例外応答を含む)
+ * @param frame アドレス, PDU, crc
+ */
+void modbus_tcp_gateway::complete_(const uint8_t* frame, size_t size)
+{
+  if(!in_flight_) return;
+  in_flight_ = false;
+
+  const transaction_t& tr = queue_[queue_head_];
+  if(alive_(tr))
+    respond_(tr, frame + 1, size - 3);
+  pop_();
+}
+
+void modbus_tcp_gateway::response_handler_(modbus_rtu_master* master, const uint8_t* frame, size_t size)
+{
+  ((modbus_tcp_gateway*)master->context())->complete_(frame, size);
+}
+
+/**
+ * @brief シリアル側の応答無し. 例外(0x0b: gateway target device failed to respond)を応答する
+ */
+void modbus_tcp_gateway::timeout_handler_(modbus_rtu_master* master, uint8_t /*slave*/, uint8_t /*cmd*/)
+{
+  modbus_tcp_gateway* self = (modbus_tcp_gateway*)master->context();
+  if(!self->in_flight_) return;
+  self->in_flight_ = false;
+
+  const transaction_t& tr = self->queue_[self->queue_head_];
+  if(self->alive_(tr))
+    self->exception_(tr, 0x0b);
+  self->pop_();
+}
+
+} /* namespace */
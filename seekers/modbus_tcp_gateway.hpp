@@ -0,0 +1,167 @@
+/**
+ * @file modbus_tcp_gateway.hpp
+ * @brief MODBUS TCP / RTU over TCP ゲートウェイ
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 20:32:07
+ *  - First.
+ * - 2026-10-17 23:59:55
+ *  - 応答ハンドラを modbus_rtu_master::client で設定し、マスターを他の要求元と共有できるよう変更.
+ */
+
+#ifndef SEEKERS_MODBUS_TCP_GATEWAY_HPP
+#define SEEKERS_MODBUS_TCP_GATEWAY_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <vector>
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#endif
+
+#include "modbus_rtu_master.hpp"
+#include "modbus_rtu_slave.hpp"
+
+namespace seekers{
+
+/**
+ * @brief MODBUS TCP / RTU over TCP ゲートウェイ
+ * TCP の接続(番号 0 - CONNECTION_NUM-1)毎に受信データから要求を取り出し、ユニットID毎に
+ *  - attach() したスレーブ(modbus_rtu_slave): その場で処理して応答する
+ *  - route() したユニット: 要求キューへ積み、modbus_rtu_master でシリアルへ順に送信する
+ * 複数接続, 複数トランザクションの要求を同時に受け付ける(応答はトランザクションIDで対応付く).
+ * RTU over TCP(MODE_RTU)の接続は応答の順序を保つため、全ての要求を要求キューで処理する.
+ * 接続はソケット等の下位層が open(), close() し、応答は sink へ渡す.
+ * シリアルの受信データは modbus_rtu_master::recieve() へ渡すこと.
+ * 応答ハンドラは要求元(modbus_rtu_master::client)として設定するため、1つのマスターを
+ * 他の要求元(プランナー, スケジューラ, 書き込みキャッシュ, ゲートウェイ)と共有できる.
+ */
+class modbus_tcp_gateway{
+public:
+  static const int CONNECTION_NUM = 8;
+  static const int QUEUE_SIZE = 16;
+  static const size_t PDU_SIZE = 253;
+  static const size_t ADU_SIZE = 7 + PDU_SIZE;  // MBAP + PDU
+
+  enum mode_t{
+    MODE_MBAP,  ///< MODBUS TCP(MBAP ヘッダ)
+    MODE_RTU    ///< RTU over TCP(crc付きRTUフレーム)
+  };
+
+  /**
+   * @brief 応答の送信先
+   */
+  class sink{
+  public:
+    virtual ~sink(){}
+    virtual void send(int conn, const uint8_t* src, size_t size) = 0;
+  };
+
+private:
+  struct connection_t{
+    bool opened;
+    mode_t mode;
+    uint32_t generation;        // 切断済みの要求の判別用
+    uint8_t buff[ADU_SIZE * 2];
+    size_t len;
+  };
+
+  struct transaction_t{
+    int conn;
+    uint32_t generation;
+    mode_t mode;
+    uint16_t tid;
+    uint8_t unit;
+    uint8_t pdu_len;
+    uint8_t pdu[PDU_SIZE];
+  };
+
+  struct unit_t{
+    modbus_rtu_slave* local;
+    bool serial;
+  };
+
+  modbus_rtu_master& master_;
+  modbus_rtu_master::client client_;  // 応答ハンドラ, context
+  sink& sink_;
+
+  unit_t units_[256];
+  connection_t connections_[CONNECTION_NUM];
+
+  transaction_t queue_[QUEUE_SIZE];  // 要求キュー(先頭がシリアルへ送信中)
+  int queue_head_;
+  int queue_num_;
+  bool in_flight_;
+
+  uint32_t local_;
+  uint32_t forwarded_;
+  uint32_t exceptions_;
+  uint32_t discarded_;
+  int queue_peak_;
+
+  void parse_mbap_(int conn);
+  void parse_rtu_(int conn);
+  void request_(int conn, uint16_t tid, uint8_t unit, const uint8_t* pdu, size_t pdu_len);
+  void process_local_(const transaction_t& tr);
+  void pop_(void);
+  void respond_(const transaction_t& tr, const uint8_t* pdu, size_t pdu_len);
+  void exception_(const transaction_t& tr, uint8_t code);
+  void complete_(const uint8_t* frame, size_t size);
+  bool alive_(const transaction_t& tr) const;
+
+  static void response_handler_(modbus_rtu_master* master, const uint8_t* frame, size_t size);
+  static void timeout_handler_(modbus_rtu_master* master, uint8_t slave, uint8_t cmd);
+
+public:
+  modbus_tcp_gateway(modbus_rtu_master& master, sink& out);
+
+  /**
+   * @brief ユニットIDをスレーブ(自局)へ割り当てる. ユニットIDはスレーブのアドレス
+   * @return アドレスが0または割り当て済みならfalse
+   */
+  bool attach(modbus_rtu_slave* unit);
+
+  /**
+   * @brief ユニットIDをシリアル側(同じアドレスのスレーブ)へ割り当てる
+   */
+  void route(uint8_t unit)
+  {
+    units_[unit].serial = true;
+  }
+
+  void unroute(uint8_t unit)
+  {
+    units_[unit].local = NULL;
+    units_[unit].serial = false;
+  }
+
+  bool open(int conn, mode_t mode = MODE_MBAP);
+  void close(int conn);
+
+  /**
+   * @brief TCP 受信データの処理
+   */
+  void recieve(int conn, const uint8_t* src, size_t size);
+
+  /**
+   * @brief アイドル処理
+   * modbus_rtu_master::idle() の後に呼び出す. 送信可能なら要求キューの先頭をシリアルへの送信データとして serial_tx へ追加する.
+   */
+  void idle(std::vector<uint8_t>& serial_tx);
+
+  int queued(void) const { return queue_num_; }
+  int queue_peak(void) const { return queue_peak_; }
+  uint32_t local(void) const { return local_; }
+  uint32_t forwarded(void) const { return forwarded_; }
+  uint32_t exceptions(void) const { return exceptions_; }
+  uint32_t discarded(void) const { return discarded_; }
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_TCP_GATEWAY_HPP */
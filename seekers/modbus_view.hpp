@@ -0,0 +1,101 @@
+/**
+ * @file modbus_view.hpp
+ * @brief MODBUS 応答データの参照
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 17:48:31
+ *  - First.
+ */
+
+#ifndef SEEKERS_MODBUS_VIEW_HPP
+#define SEEKERS_MODBUS_VIEW_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace seekers{
+
+/**
+ * @brief レジスタ列の参照(big endian の2byte列)
+ * 受信バッファを直接参照する. コピーしない.
+ */
+class modbus_register_view{
+private:
+  const uint8_t* data_;
+  size_t size_;
+
+public:
+  modbus_register_view(const uint8_t* data, size_t size) :
+    data_(data),
+    size_(size)
+  {}
+
+  uint16_t operator[](size_t idx) const
+  {
+    return (uint16_t)((data_[idx * 2] << 8) | data_[idx * 2 + 1]);
+  }
+
+  /**
+   * @brief レジスタ数
+   */
+  size_t size(void) const { return size_; }
+  bool empty(void) const { return 0 == size_; }
+
+  /**
+   * @brief 先頭レジスタの上位byte
+   */
+  const uint8_t* raw(void) const { return data_; }
+
+  /**
+   * @brief ホストのbyte順で取り出し
+   * @return 取り出した数
+   */
+  size_t copy(uint16_t* dst, size_t size) const
+  {
+    if(size > size_) size = size_;
+    for(size_t ii = 0; ii < size; ++ii)
+      dst[ii] = (*this)[ii];
+    return size;
+  }
+};
+
+/**
+ * @brief bit列の参照(LSB first で詰めたbyte列)
+ * 受信バッファを直接参照する. コピーしない.
+ */
+class modbus_bit_view{
+private:
+  const uint8_t* data_;
+  size_t size_;
+
+public:
+  modbus_bit_view(const uint8_t* data, size_t size) :
+    data_(data),
+    size_(size)
+  {}
+
+  bool operator[](size_t idx) const
+  {
+    return 0 != (data_[idx >> 3] & (1 << (idx & 7)));
+  }
+
+  /**
+   * @brief bit数
+   */
+  size_t size(void) const { return size_; }
+  bool empty(void) const { return 0 == size_; }
+
+  /**
+   * @brief 先頭8bit(LSB first)
+   */
+  const uint8_t* raw(void) const { return data_; }
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_MODBUS_VIEW_HPP */
@@ -0,0 +1,166 @@
+/**
+ * @file spsc_ring.hpp
+ * @brief 単一生産者/単一消費者 リングバッファ
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 15:30:02
+ *  - First.
+ */
+
+#ifndef SEEKERS_SPSC_RING_HPP
+#define SEEKERS_SPSC_RING_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __MBED__
+#include "mbed.h"
+#define SEEKERS_MEMORY_BARRIER() __DMB()
+#elif defined(__GNUC__)
+#define SEEKERS_MEMORY_BARRIER() __sync_synchronize()
+#else
+#define SEEKERS_MEMORY_BARRIER()
+#endif
+
+namespace seekers{
+
+/**
+ * @brief 単一生産者/単一消費者 リングバッファ(領域は外部)
+ * 生産者(割り込み等)は push() のみ、消費者(スレッド等)は pop() のみを呼び出す限り
+ * 排他制御無しで動作する. 容量は2のべき乗であること.
+ * 満杯時の push() は破棄し、overrun() を加算する.
+ */
+template <typename T>
+class basic_spsc_ring{
+private:
+  T* buff_;
+  size_t mask_;
+  volatile size_t head_;  // 読み出し位置(消費者のみ更新)
+  volatile size_t tail_;  // 書き込み位置(生産者のみ更新)
+  volatile uint32_t overrun_;
+
+public:
+  basic_spsc_ring(T* buff, size_t capacity) :
+    buff_(buff),
+    mask_(capacity - 1),
+    head_(0),
+    tail_(0),
+    overrun_(0)
+  {}
+
+  size_t capacity(void) const { return mask_ + 1; }
+  size_t size(void) const { return tail_ - head_; }
+  bool empty(void) const { return head_ == tail_; }
+  bool full(void) const { return size() > mask_; }
+
+  /**
+   * @brief 満杯による破棄数
+   */
+  uint32_t overrun(void) const { return overrun_; }
+  void clear_overrun(void) { overrun_ = 0; }
+
+  /**
+   * @brief 追加(生産者側)
+   */
+  bool push(const T& src)
+  {
+    const size_t tail = tail_;
+    if(tail - head_ > mask_){
+      overrun_ = overrun_ + 1;
+      return false;
+    }
+    buff_[tail & mask_] = src;
+    SEEKERS_MEMORY_BARRIER();
+    tail_ = tail + 1;
+    return true;
+  }
+
+  /**
+   * @brief 一括追加(生産者側)
+   * @return 追加した数. 残りは破棄せず呼び出し側に返す
+   */
+  size_t push(const T* src, size_t size)
+  {
+    const size_t tail = tail_;
+    const size_t space = mask_ + 1 - (tail - head_);
+    if(size > space) size = space;
+    for(size_t ii = 0; ii < size; ++ii)
+      buff_[(tail + ii) & mask_] = src[ii];
+    SEEKERS_MEMORY_BARRIER();
+    tail_ = tail + size;
+    return size;
+  }
+
+  /**
+   * @brief 取り出し(消費者側)
+   */
+  bool pop(T& dst)
+  {
+    const size_t head = head_;
+    if(head == tail_) return false;
+    dst = buff_[head & mask_];
+    SEEKERS_MEMORY_BARRIER();
+    head_ = head + 1;
+    return true;
+  }
+
+  /**
+   * @brief 一括取り出し(消費者側)
+   * @return 取り出した数
+   */
+  size_t pop(T* dst, size_t size)
+  {
+    const size_t head = head_;
+    const size_t avail = tail_ - head;
+    if(size > avail) size = avail;
+    for(size_t ii = 0; ii < size; ++ii)
+      dst[ii] = buff_[(head + ii) & mask_];
+    SEEKERS_MEMORY_BARRIER();
+    head_ = head + size;
+    return size;
+  }
+
+  /**
+   * @brief 先頭から連続して読み出せる領域(消費者側)
+   * 参照後 consume() で取り出し済みとする
+   */
+  const T* peek(size_t& size) const
+  {
+    const size_t head = head_;
+    const size_t avail = tail_ - head;
+    const size_t contiguous = mask_ + 1 - (head & mask_);
+    size = (avail < contiguous) ? avail : contiguous;
+    return buff_ + (head & mask_);
+  }
+
+  void consume(size_t size)
+  {
+    SEEKERS_MEMORY_BARRIER();
+    head_ = head_ + size;
+  }
+};
+
+/**
+ * @brief 単一生産者/単一消費者 リングバッファ
+ * @tparam N 容量(2のべき乗)
+ */
+template <typename T, size_t N>
+class spsc_ring : public basic_spsc_ring<T>{
+private:
+  typedef char power_of_two_check[(N > 0 && 0 == (N & (N - 1))) ? 1 : -1];
+  T storage_[N];
+
+public:
+  spsc_ring() :
+    basic_spsc_ring<T>(storage_, N)
+  {}
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_SPSC_RING_HPP */
@@ -0,0 +1,92 @@
+/**
+ * @file static_vector.hpp
+ * @brief 固定容量の可変長配列
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 17:20:06
+ *  - First.
+ */
+
+#ifndef SEEKERS_STATIC_VECTOR_HPP
+#define SEEKERS_STATIC_VECTOR_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stddef.h>
+
+namespace seekers{
+
+/**
+ * @brief 固定容量の可変長配列
+ * 領域を内部に持ち、ヒープを使用しない. std::vector と同名の操作を持つ.
+ * 容量を超える push_back(), resize(), insert() は何もせず false を返す.
+ * @tparam N 容量
+ */
+template <typename T, size_t N>
+class static_vector{
+public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+private:
+  T buff_[N];
+  size_t size_;
+
+public:
+  static_vector() :
+    size_(0)
+  {}
+
+  size_t size(void) const { return size_; }
+  size_t capacity(void) const { return N; }
+  bool empty(void) const { return 0 == size_; }
+  bool full(void) const { return N == size_; }
+  void clear(void) { size_ = 0; }
+
+  T* data(void) { return buff_; }
+  const T* data(void) const { return buff_; }
+  iterator begin(void) { return buff_; }
+  iterator end(void) { return buff_ + size_; }
+  const_iterator begin(void) const { return buff_; }
+  const_iterator end(void) const { return buff_ + size_; }
+
+  T& operator[](size_t idx) { return buff_[idx]; }
+  const T& operator[](size_t idx) const { return buff_[idx]; }
+
+  bool push_back(const T& src)
+  {
+    if(N == size_) return false;
+    buff_[size_++] = src;
+    return true;
+  }
+
+  bool resize(size_t size)
+  {
+    if(size > N) return false;
+    size_ = size;
+    return true;
+  }
+
+  /**
+   * @brief pos の前へ [first, last) を挿入
+   */
+  bool insert(iterator pos, const T* first, const T* last)
+  {
+    const size_t n = last - first;
+    if(n > N - size_) return false;
+    for(iterator p = end(); p != pos; --p)
+      *(p - 1 + n) = *(p - 1);
+    for(size_t ii = 0; ii < n; ++ii)
+      pos[ii] = first[ii];
+    size_ += n;
+    return true;
+  }
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_STATIC_VECTOR_HPP */
@@ -0,0 +1,95 @@
+/**
+ * @file trace_log.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:58:06
+ *  - first.
+ */
+
+#include <stdio.h>
+#include "trace_log.hpp"
+
+namespace seekers{
+
+/**
+ * @brief 書式ID - 書式文字列(trace_id_t と同じ順)
+ */
+const char* const trace_log::formats_[TRACE_ID_NUM] = {
+  /* TRACE_NONE                   */ "",
+  /* TRACE_MASTER_IDLE_TIMEOUT    */ "modubs_rtu_master::idle() response_timeout. slave %u cmd %02xh",
+  /* TRACE_MASTER_RECIEVE_TIMEOUT */ "modubs_rtu_master::recieve() response_timeout. slave %u cmd %02xh",
+  /* TRACE_MASTER_EXCEPTION_CRC   */ "modbus_rtu_master exceptionresponse_(): crc error. src = %04xh",
+  /* TRACE_MASTER_EXCEPTION       */ "modbus_rtu_master exceptionresponse_(): complate. slave %u code %02xh",
+  /* TRACE_MASTER_READ_CRC        */ "modbus_rtu_master readresponse_(): crc error. src = %04xh",
+  /* TRACE_MASTER_READ_COUNT      */ "modbus_rtu_master readresponse_(): byte count mismatch. %u",
+  /* TRACE_MASTER_READ            */ "modbus_rtu_master readresponse_(): complate. slave %u cmd %02xh",
+  /* TRACE_MASTER_WRITE_CRC       */ "modbus_rtu_master writeresponse_(): crc error. src = %04xh",
+  /* TRACE_MASTER_WRITE_ECHO      */ "modbus_rtu_master writeresponse_(): echo mismatch. %04xh %04xh",
+  /* TRACE_MASTER_WRITE           */ "modbus_rtu_master writeresponse_(): complate. slave %u cmd %02xh",
+  /* TRACE_SLAVE_CRC              */ "modbus_rtu_slave[%u] recieve(): crc error. cmd = %02xh",
+  /* TRACE_SLAVE_READCOILSTATUS   */ "modbus_rtu_slave[%u] readcoilstatus_(): complate."
+};
+
+/**
+ * @brief 書式文字列
+ * @return 未定義のIDはNULL
+ */
+const char* trace_log::format_string(uint16_t id)
+{
+  return (id < TRACE_ID_NUM) ? formats_[id] : NULL;
+}
+
+/**
+ * @brief 記録の整形(行末の改行は付けない)
+ * @return 整形後の長さ(snprintf と同じ)
+ */
+int trace_log::format(char* dst, size_t size, const record_t& record)
+{
+  const char* fmt = format_string(record.id);
+  if(NULL == fmt)
+    return snprintf(dst, size, "[%10u] unknown trace id %u", (unsigned)record.us, (unsigned)record.id);
+
+  const int n = snprintf(dst, size, "[%10u] ", (unsigned)record.us);
+  if(n < 0 || (size_t)n >= size) return n;
+  const int m = snprintf(dst + n, size - n, fmt,
+                         (unsigned)record.args[0], (unsigned)record.args[1], (unsigned)record.args[2]);
+  return (m < 0) ? m : n + m;
+}
+
+/**
+ * @brief 記録を整形して出力
+ * 前回から破棄があれば、その数を先に出力する.
+ * @param max 出力する最大記録数
+ * @return 出力した記録数
+ */
+size_t trace_log::drain(writer_t writer, void* context, size_t max)
+{
+  char line[128];
+  const uint32_t lost = ring_.overrun();
+  if(lost != lost_reported_){
+    const int n = snprintf(line, sizeof(line), "[trace] lost %u records.\r\n", (unsigned)(lost - lost_reported_));
+    if(!writer(context, line, (size_t)n)) return 0;
+    lost_reported_ = lost;
+  }
+
+  size_t done = 0;
+  while(done < max){
+    size_t avail = 0;
+    const record_t* record = ring_.peek(avail);
+    if(0 == avail) break;
+
+    int n = format(line, sizeof(line) - 2, *record);
+    if(n < 0) n = 0;
+    if((size_t)n > sizeof(line) - 3) n = sizeof(line) - 3;
+    line[n++] = '\r';
+    line[n++] = '\n';
+    if(!writer(context, line, (size_t)n)) break;
+    ring_.consume(1);
+    ++done;
+  }
+  return done;
+}
+
+} /* namespace */
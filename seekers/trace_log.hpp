@@ -0,0 +1,157 @@
+/**
+ * @file trace_log.hpp
+ * @brief 書式IDによる遅延整形ログ
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 23:58:06
+ *  - First.
+ */
+
+#ifndef SEEKERS_TRACE_LOG_HPP
+#define SEEKERS_TRACE_LOG_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#ifdef __MBED__
+#include "mbed.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+#include "spsc_ring.hpp"
+
+namespace seekers{
+
+/**
+ * @brief 書式ID
+ * 書式文字列は trace_log.cpp の formats_ に同じ順で定義する.
+ * 追加は末尾へ(記録済みのIDを変えない).
+ */
+enum trace_id_t{
+  TRACE_NONE = 0,
+  TRACE_MASTER_IDLE_TIMEOUT,
+  TRACE_MASTER_RECIEVE_TIMEOUT,
+  TRACE_MASTER_EXCEPTION_CRC,
+  TRACE_MASTER_EXCEPTION,
+  TRACE_MASTER_READ_CRC,
+  TRACE_MASTER_READ_COUNT,
+  TRACE_MASTER_READ,
+  TRACE_MASTER_WRITE_CRC,
+  TRACE_MASTER_WRITE_ECHO,
+  TRACE_MASTER_WRITE,
+  TRACE_SLAVE_CRC,
+  TRACE_SLAVE_READCOILSTATUS,
+  TRACE_ID_NUM
+};
+
+/**
+ * @brief 書式IDによる遅延整形ログ
+ * 呼び出し側は書式ID, 時刻(us_ticker), 引数(最大 ARG_NUM 個の整数)を固定長の記録として
+ * リングへ追加するのみで、整形しない(待たない). 満杯時は破棄して lost() を加算する.
+ * 整形はメインループ等の低優先の処理から drain() で行う.
+ * 追加は割り込みコンテキストからも呼び出し可能(追加の数命令の間のみ割り込みを禁止する).
+ * 取り出し(drain)は単一の消費者のみ.
+ */
+class trace_log{
+public:
+  static const int ARG_NUM = 3;
+
+  /**
+   * @brief 記録(20byte)
+   */
+  struct record_t{
+    uint32_t us;     ///< 記録時刻(us_ticker)
+    uint16_t id;     ///< trace_id_t
+    uint16_t reserved;
+    uint32_t args[ARG_NUM];
+  };
+
+  /**
+   * @brief 整形後の出力先
+   * @return 受け付けたらtrue. falseなら記録を残して drain() を中断する
+   */
+  typedef bool (*writer_t)(void* context, const char* src, size_t size);
+
+private:
+  static const char* const formats_[TRACE_ID_NUM];
+
+  basic_spsc_ring<record_t> ring_;
+  uint32_t lost_reported_;  // drain() で出力済みの破棄数
+
+  trace_log(const trace_log&);
+  trace_log& operator=(const trace_log&);
+
+protected:
+  trace_log(record_t* buff, size_t capacity) :
+    ring_(buff, capacity),
+    lost_reported_(0)
+  {}
+
+public:
+  /**
+   * @brief 記録の追加
+   * 書式の変換指定は %u, %x 等の int 幅のみ(引数は unsigned int として渡す).
+   */
+  void put(uint16_t id, uint32_t arg0 = 0, uint32_t arg1 = 0, uint32_t arg2 = 0)
+  {
+    record_t record;
+#ifdef __MBED__
+    record.us = us_ticker_read();
+#else
+    record.us = 0;
+#endif
+    record.id = id;
+    record.reserved = 0;
+    record.args[0] = arg0;
+    record.args[1] = arg1;
+    record.args[2] = arg2;
+#ifdef __MBED__
+    core_util_critical_section_enter();
+    ring_.push(record);
+    core_util_critical_section_exit();
+#else
+    ring_.push(record);
+#endif
+  }
+
+  size_t drain(writer_t writer, void* context, size_t max = (size_t)-1);
+
+  static int format(char* dst, size_t size, const record_t& record);
+  static const char* format_string(uint16_t id);
+
+  /**
+   * @brief 未整形の記録数
+   */
+  size_t pending(void) const { return ring_.size(); }
+
+  /**
+   * @brief 満杯による破棄数
+   */
+  uint32_t lost(void) const { return ring_.overrun(); }
+};
+
+
+/**
+ * @brief 書式IDによる遅延整形ログ(容量指定)
+ * @tparam N 記録数(2のべき乗)
+ */
+template <size_t N = 64>
+class trace_logT : public trace_log
+{
+private:
+  typedef char power_of_two_check[(N > 0 && 0 == (N & (N - 1))) ? 1 : -1];
+  record_t storage_[N];
+
+public:
+  trace_logT() :
+    trace_log(storage_, N)
+  {}
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_TRACE_LOG_HPP */
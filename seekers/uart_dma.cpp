@@ -0,0 +1,193 @@
+/**
+ * @file uart_dma.cpp
+ * @brief
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 16:40:27
+ *  - first.
+ * - 2026-10-17 23:59:30
+ *  - 受信位置を累計byte数へ変更. 受信バッファ長ちょうどのフレーム, バッファ一周の検出を修正.
+ *  - 受信バッファ半分毎の通知, 受信停止を追加. 連続送信中は送信イネーブルを解除しない.
+ */
+
+#include "uart_dma.hpp"
+
+namespace seekers{
+
+/**
+ * @brief コンストラクタ
+ * @param rx_buff 循環受信バッファ(最大フレーム長以上, 2のべき乗)
+ * 累計byte数(2^32で循環)と書き込み位置を剰余で対応させるため、容量は2のべき乗とする.
+ */
+uart_dma_transport::uart_dma_transport(uart_dma_port& port, uint8_t* rx_buff, size_t rx_size) :
+  port_(port),
+  rx_buff_(rx_buff),
+  rx_size_(rx_size),
+  rx_read_(0),
+  frame_start_(0),
+  tx_busy_(false),
+  frame_handler_(NULL),
+  frame_context_(NULL),
+  rx_handler_(NULL),
+  rx_context_(NULL),
+  tx_handler_(NULL),
+  tx_context_(NULL),
+  frames_(0),
+  frames_lost_(0),
+  rx_bytes_(0),
+  rx_overrun_(0),
+  tx_bytes_(0),
+  irq_count_(0)
+{
+  port_.attach(this);
+}
+
+/**
+ * @brief 受信開始
+ */
+void uart_dma_transport::start(void)
+{
+  port_.driver_enable(false);
+  port_.start_rx(rx_buff_, rx_size_);
+  rx_read_ = frame_start_ = port_.rx_count();
+}
+
+/**
+ * @brief 受信停止
+ */
+void uart_dma_transport::stop(void)
+{
+  port_.stop_rx();
+}
+
+/**
+ * @brief フレーム受信ハンドラの設定
+ */
+void uart_dma_transport::frame_attach(frame_handler_t handler, void* context)
+{
+  frame_context_ = context;
+  frame_handler_ = handler;
+}
+
+/**
+ * @brief 受信バッファ半分毎の通知の設定
+ * 受信アイドルの無い連続受信でも、一周する前に read() の契機を得るために使用する.
+ */
+void uart_dma_transport::rx_attach(notify_t handler, void* context)
+{
+  rx_context_ = context;
+  rx_handler_ = handler;
+}
+
+/**
+ * @brief 送信完了ハンドラの設定
+ * ハンドラ内で write() した場合は送信イネーブルを解除しない.
+ */
+void uart_dma_transport::tx_attach(notify_t handler, void* context)
+{
+  tx_context_ = context;
+  tx_handler_ = handler;
+}
+
+/**
+ * @brief 受信アイドル(フレーム終端)
+ * 前回のフレーム終端から現在のDMA書き込み位置までを1フレームとして通知する.
+ * 受信バッファ長を超えたフレームは先頭が上書き済みのため破棄する.
+ */
+void uart_dma_transport::on_idle_line(void)
+{
+  ++irq_count_;
+  const uint32_t count = port_.rx_count();
+  const uint32_t size = count - frame_start_;
+  if(0 == size) return;
+
+  const uint32_t start = frame_start_;
+  frame_start_ = count;
+  if(size > rx_size_){
+    ++frames_lost_;
+    return;
+  }
+
+  ++frames_;
+  rx_bytes_ += size;
+  if(NULL != frame_handler_){
+    const size_t pos = start & (rx_size_ - 1);
+    const size_t size1 = (size < rx_size_ - pos) ? size : rx_size_ - pos;
+    if(size1 == size)
+      frame_handler_(frame_context_, rx_buff_ + pos, size, NULL, 0);
+    else
+      frame_handler_(frame_context_, rx_buff_ + pos, size1, rx_buff_, size - size1);
+  }
+}
+
+/**
+ * @brief 受信バッファ半分の受信
+ */
+void uart_dma_transport::on_rx_half(void)
+{
+  ++irq_count_;
+  if(NULL != rx_handler_)
+    rx_handler_(rx_context_);
+}
+
+/**
+ * @brief 送信完了(最終ビット送出済み)
+ */
+void uart_dma_transport::on_tx_complete(void)
+{
+  ++irq_count_;
+  tx_busy_ = false;
+  if(NULL != tx_handler_)
+    tx_handler_(tx_context_);
+  if(!tx_busy_)
+    port_.driver_enable(false);
+}
+
+/**
+ * @brief 受信データ数
+ */
+int uart_dma_transport::readable(void)
+{
+  const uint32_t n = port_.rx_count() - rx_read_;
+  return (int)((n < rx_size_) ? n : rx_size_);
+}
+
+/**
+ * @brief 一括受信
+ * 読み出し前に上書きされたデータは読み捨てて rx_overrun() を加算する.
+ * @return 取り出したbyte数(待たない)
+ */
+size_t uart_dma_transport::read(uint8_t* dst, size_t size)
+{
+  const uint32_t count = port_.rx_count();
+  uint32_t n = count - rx_read_;
+  if(n > rx_size_){
+    rx_overrun_ += n - rx_size_;
+    rx_read_ = count - rx_size_;
+    n = rx_size_;
+  }
+  if(n > size) n = size;
+  for(uint32_t ii = 0; ii < n; ++ii)
+    dst[ii] = rx_buff_[(rx_read_ + ii) & (rx_size_ - 1)];
+  rx_read_ += n;
+  return n;
+}
+
+/**
+ * @brief 一括送信
+ * src は送信完了(tx_busy() が false になる)まで保持すること
+ * @return 送信中で開始できない場合 false
+ */
+bool uart_dma_transport::write(const uint8_t* src, size_t size)
+{
+  if(tx_busy_ || 0 == size) return false;
+
+  tx_busy_ = true;
+  tx_bytes_ += size;
+  port_.driver_enable(true);
+  port_.start_tx(src, size);
+  return true;
+}
+
+} /* namespace */
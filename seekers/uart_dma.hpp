@@ -0,0 +1,177 @@
+/**
+ * @file uart_dma.hpp
+ * @brief DMA転送によるUART送受信
+ * @author kshibata@seekers.jp
+ * @date 2026-10-17
+ * @par history
+ * - 2026-10-17 16:40:27
+ *  - First.
+ * - 2026-10-17 23:59:30
+ *  - 受信位置を受信開始からの累計byte数(rx_count())へ変更. 受信バッファ長ちょうどのフレームの
+ *    取りこぼしと、バッファ一周(上書き)の未検出を修正.
+ *  - 受信バッファ半分毎の通知(on_rx_half()), 受信停止, 受信アイドル時間の設定を追加.
+ *  - 容量指定版 uart_dma_transportT を追加.
+ */
+
+#ifndef SEEKERS_UART_DMA_HPP
+#define SEEKERS_UART_DMA_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace seekers{
+
+class uart_dma_transport;
+
+/**
+ * @brief DMA/UART 周辺機能
+ * 対象MCU毎に実装する(LPC176x は mbed/uart_dma_lpc176x.hpp, ホスト側は host/uart_dma_sim.hpp).
+ * 受信は循環モードのDMAで rx_buff へ書き込み続け、rx_count() で受信開始からの累計byte数
+ * (2^32 で循環)を返す. 書き込み位置は rx_count() % size となる.
+ * 割り込みコンテキストで transport の以下を呼び出す.
+ *  - on_idle_line()   : 受信アイドル(rx_idle_us() 以上の無通信)の検出時
+ *  - on_rx_half()     : DMAが受信バッファの半分を書き込む毎
+ *  - on_tx_complete() : 送信完了(最終ビット送出)時
+ */
+class uart_dma_port{
+protected:
+  uart_dma_transport* transport_;
+
+public:
+  uart_dma_port() :
+    transport_(NULL)
+  {}
+
+  virtual ~uart_dma_port(){}
+
+  void attach(uart_dma_transport* transport)
+  {
+    transport_ = transport;
+  }
+
+  virtual void start_rx(uint8_t* rx_buff, size_t size) = 0;
+  virtual void stop_rx(void) = 0;
+  virtual uint32_t rx_count(void) = 0;
+  virtual void start_tx(const uint8_t* src, size_t size) = 0;
+
+  /**
+   * @brief 受信アイドルとみなす無通信時間[us]
+   */
+  virtual void rx_idle_us(int /*us*/)
+  {}
+
+  /**
+   * @brief RS485 送信イネーブル
+   */
+  virtual void driver_enable(bool /*on*/)
+  {}
+};
+
+/**
+ * @brief DMA転送によるUART送受信
+ * 受信: 循環バッファへのDMA転送. 受信アイドルでフレーム終端とし、
+ *       フレームを(折り返しがあれば2つの領域で)コピー無しに通知する.
+ *       フレーム先頭が上書きされた(バッファ長を超えた)フレームは破棄して frames_lost() を加算する.
+ * 送信: 呼び出し側のバッファから直接DMA転送し、送信完了で送信イネーブルを解除する.
+ * 1byte毎の割り込みは発生しない. 受信バッファの領域は派生クラス(uart_dma_transportT)が用意する.
+ */
+class uart_dma_transport{
+public:
+  /**
+   * @brief フレーム受信ハンドラ(割り込みコンテキスト)
+   * フレームは data1[0..size1), data2[0..size2) の順. 受信バッファが一周するまで有効.
+   */
+  typedef void (*frame_handler_t)(void* context, const uint8_t* data1, size_t size1, const uint8_t* data2, size_t size2);
+  typedef void (*notify_t)(void* context);
+
+private:
+  uart_dma_port& port_;
+  uint8_t* rx_buff_;
+  size_t rx_size_;
+  uint32_t rx_read_;      // read() の読み出し位置(累計byte数)
+  uint32_t frame_start_;  // フレーム先頭位置(累計byte数)
+  volatile bool tx_busy_;
+
+  frame_handler_t frame_handler_;
+  void* frame_context_;
+  notify_t rx_handler_;
+  void* rx_context_;
+  notify_t tx_handler_;
+  void* tx_context_;
+
+  // 統計
+  volatile uint32_t frames_;
+  volatile uint32_t frames_lost_;
+  volatile uint32_t rx_bytes_;
+  volatile uint32_t rx_overrun_;
+  volatile uint32_t tx_bytes_;
+  volatile uint32_t irq_count_;
+
+protected:
+  uart_dma_transport(uart_dma_port& port, uint8_t* rx_buff, size_t rx_size);
+
+public:
+  virtual ~uart_dma_transport(){}
+
+  void start(void);
+  void stop(void);
+
+  void frame_attach(frame_handler_t handler, void* context);
+  void rx_attach(notify_t handler, void* context);
+  void tx_attach(notify_t handler, void* context);
+
+  /**
+   * @brief 受信アイドル(フレーム終端)とみなす無通信時間[us]
+   */
+  void rx_idle_us(int us)
+  {
+    port_.rx_idle_us(us);
+  }
+
+  // 割り込みコンテキストから呼び出す
+  void on_idle_line(void);
+  void on_rx_half(void);
+  void on_tx_complete(void);
+
+  int readable(void);
+  size_t read(uint8_t* dst, size_t size);
+  bool write(const uint8_t* src, size_t size);
+
+  bool tx_busy(void) const { return tx_busy_; }
+  size_t rx_capacity(void) const { return rx_size_; }
+
+  uint32_t frames(void) const { return frames_; }
+  uint32_t frames_lost(void) const { return frames_lost_; }
+  uint32_t rx_bytes(void) const { return rx_bytes_; }
+  /**
+   * @brief read() の前に上書きされ、読み出せなかったbyte数
+   */
+  uint32_t rx_overrun(void) const { return rx_overrun_; }
+  uint32_t tx_bytes(void) const { return tx_bytes_; }
+  uint32_t irq_count(void) const { return irq_count_; }
+};
+
+
+/**
+ * @brief DMA転送によるUART送受信(受信バッファ容量指定)
+ * @tparam RXSIZE 受信バッファ容量(2のべき乗. 最大フレーム長以上)
+ */
+template <size_t RXSIZE = 512>
+class uart_dma_transportT : public uart_dma_transport{
+private:
+  typedef char power_of_two_check[(RXSIZE >= 2 && 0 == (RXSIZE & (RXSIZE - 1))) ? 1 : -1];
+  uint8_t rx_storage_[RXSIZE];
+
+public:
+  uart_dma_transportT(uart_dma_port& port) :
+    uart_dma_transport(port, rx_storage_, RXSIZE)
+  {}
+};
+
+} /* namespace */
+
+#endif /* SEEKERS_UART_DMA_HPP */
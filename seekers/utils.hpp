@@ -6,6 +6,10 @@
  * @par history
  * - 2016-11-04 10:58:27
  *  - First.
+ * - 2026-10-17 09:40:12
+ *  - crc16計算をテーブル方式(crc16.hpp)へ変更.
+ * - 2026-10-17 10:21:03
+ *  - crc16逐次計算(crc16_state)を追加.
  */
 
 #ifndef SEEKERS_UTILS_HPP
@@ -15,46 +19,82 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include "crc16.hpp"
+
 namespace seekers{
 
 typedef unsigned short int uint16_t;
 
 /**
- * @brief crc16計算
+ * @brief crc16計算(1bit毎)
  */
 template <int POLY>
 uint16_t crc16_base(const uint8_t* data, size_t size)
 {
-  static const uint16_t CRC16POLY = POLY;
-  uint16_t crc = 0;
-  crc = ~crc;
-  for(size_t ii = 0; ii < size; ++ii){
-    crc ^= *(data + ii);
-    for(int jj = 0; jj < 8; ++jj){
-      if(crc & 1)
-        crc = (crc >> 1) ^ CRC16POLY;
-      else
-        crc >>= 1;
-    }
-  }
-  return crc;
+  return crc16_calc<POLY, crc16_policy_bitwise>(data, size);
 }
 
 inline uint16_t crc16_ibm(const uint8_t* data, size_t size)
 {
-  return crc16_base<0xa001>(data,size);
+  return crc16_calc<0xa001, crc16_policy_default>(data, size);
 }
 
 inline uint16_t crc16_ansi(const uint8_t* data, size_t size)
 {
-  return crc16_base<0x8401>(data, size);
+  return crc16_calc<0x8401, crc16_policy_default>(data, size);
 }
 
 inline uint16_t crc16_ccitt(const uint8_t* data, size_t size)
 {
-  return crc16_base<0x8408>(data, size);
+  return crc16_calc<0x8408, crc16_policy_default>(data, size);
 }
 
+/**
+ * @brief crc16逐次計算
+ * 受信したデータを到着順に update() へ渡し、finalize() で結果を得る.
+ * 末尾のcrc(下位,上位の順)まで update() した場合、正しいフレームなら
+ * finalize() は 0 となる(residue_ok()).
+ */
+template <int POLY, typename POLICY = crc16_policy_default>
+class crc16_state{
+private:
+  uint16_t crc_;
+
+public:
+  crc16_state() :
+    crc_(0xffff)
+  {}
+
+  void init(void)
+  {
+    crc_ = 0xffff;
+  }
+
+  void update(const uint8_t* data, size_t size)
+  {
+    crc_ = POLICY::template update<POLY>(crc_, data, size);
+  }
+
+  void update(uint8_t data)
+  {
+    crc_ = POLICY::template update<POLY>(crc_, &data, 1);
+  }
+
+  uint16_t finalize(void) const
+  {
+    return crc_;
+  }
+
+  bool residue_ok(void) const
+  {
+    return 0 == crc_;
+  }
+};
+
+typedef crc16_state<0xa001> crc16_ibm_state;
+typedef crc16_state<0x8401> crc16_ansi_state;
+typedef crc16_state<0x8408> crc16_ccitt_state;
+
 /**
  * @brief bcc計算
  */
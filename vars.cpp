@@ -6,14 +6,29 @@
  * @par history
  * - 2016-11-08 16:56:27
  *  - first.
+ * - 2026-10-17 15:30:02
+ *  - uartの送受信バッファを256byteへ変更.
+ * - 2026-10-17 21:05:40
+ *  - シーンループをイベント駆動へ変更. イベント, pcの受信バッファを追加.
+ * - 2026-10-17 23:20:14
+ *  - コンソール出力を送信割り込み駆動の console へ変更.
+ * - 2026-10-17 23:59:30
+ *  - uartのDMA転送(SEEKERS_UART_DMA)を追加.
  */
 
 #include "vars.h"
 
 runtime_loop_t runtime_loop = NULL;
+seekers::event_loop runtime_events;
 RawSerial pc(USBTX, USBRX);
+seekers::spsc_ring<uint8_t, 64> pc_rx;
+seekers::console_sinkT<1024> console(pc);
 
-seekers::RS485Serial uart(p9,p10,p8); //seekers::RS485Serial uart(p9,p10,p8);
+seekers::RS485SerialT<256, 256> uart(p9,p10,p8); //seekers::RS485Serial uart(p9,p10,p8);
+#if SEEKERS_UART_DMA
+static seekers::uart_dma_lpc176x uart_dma_port(UART_3); // p9, p10
+seekers::uart_dma_transportT<512> uart_dma(uart_dma_port);
+#endif
 
 int uart_baud_ = 9600;
 int uart_bits_ = 8;
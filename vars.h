@@ -6,6 +6,14 @@
  * @par history
  * - 2016-11-08 16:55:37
  *  - First.
+ * - 2026-10-17 15:30:02
+ *  - uartの送受信バッファを256byteへ変更.
+ * - 2026-10-17 21:05:40
+ *  - シーンループをイベント駆動へ変更. イベント, pcの受信バッファを追加.
+ * - 2026-10-17 23:20:14
+ *  - コンソール出力を送信割り込み駆動の console へ変更.
+ * - 2026-10-17 23:59:30
+ *  - uartのDMA転送(SEEKERS_UART_DMA)を追加.
  */
 
 #ifndef VARS_H
@@ -17,15 +25,41 @@
 
 #include "mbed.h"
 #include "seekers/mbed/rs485serial.hpp"
+#include "seekers/mbed/event_loop.hpp"
+#include "seekers/mbed/console_sink.hpp"
+#include "seekers/spsc_ring.hpp"
+#include "seekers/uart_dma.hpp"
+#include "seekers/mbed/uart_dma_lpc176x.hpp"
+
+// uart の送受信をDMA転送で行う(LPC176x のみ). -DSEEKERS_UART_DMA=1 で有効
+#if !defined(SEEKERS_UART_DMA) || !defined(TARGET_LPC176X)
+# undef SEEKERS_UART_DMA
+# define SEEKERS_UART_DMA 0
+#endif
 
 #define SELF_VERSION "1.0.0"
 
-typedef Callback<void(void)> runtime_loop_t;
+// シーンループへ渡すイベント
+enum runtime_event_t{
+  EVENT_PC_RX   = 0x01,  // pc 受信
+  EVENT_UART_RX = 0x02,  // uart 受信
+  EVENT_MARK    = 0x04,  // マーク出力周期
+  EVENT_TICK    = 0x08   // 動作周期
+};
+
+// シーンループ(通知されたイベントを受け取る)
+typedef Callback<void(uint32_t)> runtime_loop_t;
 
 extern runtime_loop_t runtime_loop;
+extern seekers::event_loop runtime_events;
 
 extern RawSerial pc;
-extern seekers::RS485Serial uart;
+extern seekers::spsc_ring<uint8_t, 64> pc_rx;
+extern seekers::console_sinkT<1024> console;
+extern seekers::RS485SerialT<256, 256> uart;
+#if SEEKERS_UART_DMA
+extern seekers::uart_dma_transportT<512> uart_dma;
+#endif
 
 extern int uart_baud_;
 extern int uart_bits_;